@@ -0,0 +1,54 @@
+# This specifies the exe name
+TARGET=Benchmark
+# where to put the .o files
+OBJECTS_DIR=obj
+# core Qt Libs to use add more here if needed.
+QT+=gui opengl core
+isEqual(QT_MAJOR_VERSION, 5) {
+	cache()
+	DEFINES +=QT5BUILD
+}
+# where to put moc auto generated files
+MOC_DIR=moc
+# on a mac we don't create a .app bundle file ( for ease of multiplatform use)
+CONFIG-=app_bundle
+SOURCES+= $$PWD/src/main.cpp \
+					$$PWD/src/Benchmark.cpp \
+					$$PWD/src/Statistics.cpp \
+					$$PWD/src/ImmediateBackend.cpp \
+					$$PWD/src/RawGLBackend.cpp \
+					$$PWD/src/VAOBackend.cpp \
+					$$PWD/src/QuantisedBackend.cpp \
+					$$PWD/src/AttributeBackend.cpp \
+					$$PWD/src/ProceduralBackend.cpp \
+					$$PWD/src/ComputeBackend.cpp \
+					$$PWD/src/SparseBackend.cpp
+HEADERS+= $$PWD/include/Benchmark.h \
+					$$PWD/include/Statistics.h \
+					$$PWD/include/RenderBackend.h \
+					$$PWD/include/ImmediateBackend.h \
+					$$PWD/include/RawGLBackend.h \
+					$$PWD/include/VAOBackend.h \
+					$$PWD/include/QuantisedBackend.h \
+					$$PWD/include/AttributeBackend.h \
+					$$PWD/include/ProceduralBackend.h \
+					$$PWD/include/ComputeBackend.h \
+					$$PWD/include/SparseBackend.h
+# and add the include dir into the search path for Qt and make
+INCLUDEPATH +=./include
+# code shared between the demos (point generation etc)
+include($$PWD/../Common/Common.pri)
+# where our exe is going to live (root of project)
+DESTDIR=./
+# this is a command line tool
+CONFIG += console
+
+NGLPATH=$$(NGLDIR)
+isEmpty(NGLPATH){ # note brace must be here
+	message("including $HOME/NGL")
+	include($(HOME)/NGL/UseNGL.pri)
+}
+else{ # note brace must be here
+	message("Using custom NGL location")
+	include($(NGLDIR)/UseNGL.pri)
+}
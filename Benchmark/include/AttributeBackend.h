@@ -0,0 +1,27 @@
+#ifndef ATTRIBUTEBACKEND_H_
+#define ATTRIBUTEBACKEND_H_
+#include "RenderBackend.h"
+#include "AttributePoints.h"
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AttributeBackend.h
+/// @brief points with a colour, size and intensity each in one of the AttributePoints layouts. create fills
+/// every attribute, update only moves the points like an animation would so the layouts with a separate
+/// position stream upload less.
+//----------------------------------------------------------------------------------------------------------------------
+
+class AttributeBackend : public RenderBackend
+{
+  public :
+    explicit AttributeBackend(AttributePoints::Layout _layout) : m_points(_layout){}
+    std::string name() const override {return std::string("Attributes-")+AttributePoints::layoutName(m_points.layout());}
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+
+  private :
+    AttributePoints m_points;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+#include "FrameUniforms.h"
+#include "RenderBackend.h"
+#include "Statistics.h"
+#include <memory>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Benchmark.h
+/// @brief runs each RenderBackend over a sweep of point counts and collects the timings
+/// @class Benchmark
+/// @brief for every backend and point count the create, update and draw phases are timed separately.
+/// Each phase is run a number of warmup times first (not recorded) then the recorded iterations, every
+/// sample ends with glFinish so the time includes the GPU work. A GL context and the target
+/// framebuffer must be current before run is called.
+//----------------------------------------------------------------------------------------------------------------------
+
+class Benchmark
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief settings for a run
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Config
+    {
+      unsigned int minPoints=1000;
+      unsigned int maxPoints=10000000;
+      /// @brief how many sizes per power of ten, 1 gives 1k,10k,100k...
+      unsigned int stepsPerDecade=1;
+      unsigned int warmup=2;
+      unsigned int iterations=10;
+      int width=1024;
+      int height=720;
+      /// @brief the shape of the points every backend draws
+      Workload::Shape workload=Workload::Shape::Uniform;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one row of results
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Result
+    {
+      std::string backend;
+      unsigned int points;
+      std::string phase;
+      Statistics stats;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _config the settings for the run
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit Benchmark(const Config &_config) : m_config(_config){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add a backend to the run, backends run in the order they are added and draw the config's workload
+    //----------------------------------------------------------------------------------------------------------------------
+    void addBackend(std::unique_ptr<RenderBackend> _backend);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run every backend over every size
+    //----------------------------------------------------------------------------------------------------------------------
+    void run();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the point counts for the sweep
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> sizes() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the results of the last run
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<Result> &results() const {return m_results;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write the results, one row per backend / size / phase
+    /// @param _fname the file to write
+    /// @param _renderer the GL_RENDERER string, stored with each row with the workload so nightly files can be compared
+    //----------------------------------------------------------------------------------------------------------------------
+    bool writeCSV(const std::string &_fname, const std::string &_renderer) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write the results and the run settings as JSON
+    //----------------------------------------------------------------------------------------------------------------------
+    bool writeJSON(const std::string &_fname, const std::string &_renderer) const;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief time all three phases of one backend at one size
+    //----------------------------------------------------------------------------------------------------------------------
+    void runBackend(RenderBackend &_backend, unsigned int _size);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add a result row and print it
+    //----------------------------------------------------------------------------------------------------------------------
+    void record(const RenderBackend &_backend, unsigned int _size, const std::string &_phase, const std::vector<double> &_samples);
+
+    Config m_config;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief written before each draw like the demos do each frame
+    //----------------------------------------------------------------------------------------------------------------------
+    FrameUniforms m_frame;
+    std::vector<std::unique_ptr<RenderBackend>> m_backends;
+    std::vector<Result> m_results;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef COMPUTEBACKEND_H_
+#define COMPUTEBACKEND_H_
+#include "RenderBackend.h"
+#include "ComputeRasteriser.h"
+#include "PointBuffer.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ComputeBackend.h
+/// @brief the PointsVAO compute rasteriser mode, the float points are uploaded as in Points-mapped but drawn by
+/// splatting them into a storage buffer with a compute shader and resolving it to the framebuffer, see
+/// ComputeRasteriser. Compare its draw times with PointsVAO as the point count passes the pixel count.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ComputeBackend : public RenderBackend
+{
+  public :
+    std::string name() const override {return "Compute-raster";}
+    bool isSupported() const override {return ComputeRasteriser::isSupported();}
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief size the buffer for _size points and generate them straight into it
+    //----------------------------------------------------------------------------------------------------------------------
+    void generate(unsigned int _size);
+    PointBuffer m_buffer;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the same 5 pixel points as the glPointSize the other backends use
+    //----------------------------------------------------------------------------------------------------------------------
+    ComputeRasteriser m_rasteriser{5};
+    unsigned int m_count=0;
+};
+
+#endif
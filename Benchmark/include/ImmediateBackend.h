@@ -0,0 +1,25 @@
+#ifndef IMMEDIATEBACKEND_H_
+#define IMMEDIATEBACKEND_H_
+#include "RenderBackend.h"
+#include <ngl/Vec3.h>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ImmediateBackend.h
+/// @brief the ImmediateMode demo, points are kept on the CPU and sent with glBegin / glVertex each draw
+//----------------------------------------------------------------------------------------------------------------------
+
+class ImmediateBackend : public RenderBackend
+{
+  public :
+    std::string name() const override {return "ImmediateMode";}
+    bool isSupported() const override;
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+
+  private :
+    std::vector<ngl::Vec3> m_points;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef PROCEDURALBACKEND_H_
+#define PROCEDURALBACKEND_H_
+#include "RenderBackend.h"
+#include "ProceduralPoints.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ProceduralBackend.h
+/// @brief the PointsVAO procedural mode, the points are made in the vertex shader from gl_VertexID so
+/// create and update only set the count and seed, see ProceduralPoints
+//----------------------------------------------------------------------------------------------------------------------
+
+class ProceduralBackend : public RenderBackend
+{
+  public :
+    std::string name() const override {return "Procedural";}
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+
+  private :
+    ProceduralPoints m_points;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef QUANTISEDBACKEND_H_
+#define QUANTISEDBACKEND_H_
+#include "RenderBackend.h"
+#include "QuantisedPoints.h"
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file QuantisedBackend.h
+/// @brief the PointsVAO path with the positions quantised to 16 bit shorts or 10:10:10:2, see QuantisedPoints.
+/// The create and update times include quantising the points on the CPU.
+//----------------------------------------------------------------------------------------------------------------------
+
+class QuantisedBackend : public RenderBackend
+{
+  public :
+    explicit QuantisedBackend(QuantisedPoints::Format _format) : m_points(_format){}
+    std::string name() const override {return std::string("Quantised-")+QuantisedPoints::formatName(m_points.format());}
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+
+  private :
+    QuantisedPoints m_points;
+};
+
+#endif
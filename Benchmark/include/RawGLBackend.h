@@ -0,0 +1,36 @@
+#ifndef RAWGLBACKEND_H_
+#define RAWGLBACKEND_H_
+#include "RenderBackend.h"
+#include "PointBuffer.h"
+#include <ngl/Types.h>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file RawGLBackend.h
+/// @brief the Points demo, a VAO and VBO made with raw glGenVertexArrays / glGenBuffers calls.
+/// When mapped the points are generated straight into the buffer through PointBuffer::write as the
+/// demo now does, otherwise into a std::vector that glBufferData copies, so the create / update times
+/// show the cost of the temporary array and extra copy.
+//----------------------------------------------------------------------------------------------------------------------
+
+class RawGLBackend : public RenderBackend
+{
+  public :
+    explicit RawGLBackend(bool _mapped=false) : m_mapped(_mapped){}
+    std::string name() const override {return m_mapped ? "Points-mapped" : "Points";}
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief size m_buffer for _size points and generate them into it, pointing the VAO at it if it moved
+    //----------------------------------------------------------------------------------------------------------------------
+    void writeMapped(unsigned int _size);
+    bool m_mapped;
+    GLuint m_vao=0;
+    GLuint m_vbo=0;
+    PointBuffer m_buffer;
+    GLsizei m_count=0;
+};
+
+#endif
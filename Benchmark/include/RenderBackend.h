@@ -0,0 +1,57 @@
+#ifndef RENDERBACKEND_H_
+#define RENDERBACKEND_H_
+#include "Workload.h"
+#include <ngl/Mat4.h>
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file RenderBackend.h
+/// @brief interface for each of the drawing paths the benchmark compares
+/// @class RenderBackend
+/// @brief each backend mirrors the createPoints / updatePoints / paintGL code of one of the demos so
+/// they can all be timed in the same offscreen context. The benchmark calls glFinish after each phase
+/// so the backends don't need to do any synchronisation themselves. The points come from m_generator
+/// so every backend draws the same workload.
+//----------------------------------------------------------------------------------------------------------------------
+
+class RenderBackend
+{
+  public :
+    virtual ~RenderBackend()=default;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the name used in the results
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual std::string name() const=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief can this backend run in the current context (e.g. immediate mode needs a compatibility profile)
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual bool isSupported() const {return true;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate _size points and create any GL objects needed to draw them
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void create(unsigned int _size)=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate a new set of _size points and upload them, like pressing space in the demos
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void update(unsigned int _size)=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the points with the given MVP, it is also in the FrameUniforms block for shaders that read it
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void draw(const ngl::Mat4 &_MVP)=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief release everything made in create
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void destroy()=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief anything the backend counted in the update phase for the log, e.g. the bytes it uploaded
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual std::string updateStats() const {return std::string();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the shape of the points create and update make
+    //----------------------------------------------------------------------------------------------------------------------
+    void setWorkload(Workload::Shape _shape){m_generator.setShape(_shape);}
+
+  protected :
+    Workload m_generator;
+};
+
+#endif
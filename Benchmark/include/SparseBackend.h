@@ -0,0 +1,55 @@
+#ifndef SPARSEBACKEND_H_
+#define SPARSEBACKEND_H_
+#include "RenderBackend.h"
+#include "DirtyRanges.h"
+#include "PointBuffer.h"
+#include <ngl/Types.h>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SparseBackend.h
+/// @brief a live feed, each update moves a scattered fraction of the points rather than making a new set.
+/// The points are kept on the CPU and drawn from a PointBuffer like Points-mapped. Full writes the whole
+/// buffer each update as updatePoints does, SubData and Mapped mark the moved points in a DirtyRanges and
+/// flush just the coalesced ranges with glBufferSubData or one explicitly flushed mapping. The bytes moved
+/// against the bytes uploaded and the number of writes are printed after the update phase.
+//----------------------------------------------------------------------------------------------------------------------
+
+class SparseBackend : public RenderBackend
+{
+  public :
+    enum class Method{Full,SubData,Mapped};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _method how the changes are uploaded
+    /// @param _fraction the fraction of the points moved by each update
+    /// @param _gap ranges at most this many bytes apart are uploaded as one
+    //----------------------------------------------------------------------------------------------------------------------
+    SparseBackend(Method _method, double _fraction, size_t _gap);
+    std::string name() const override;
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+    std::string updateStats() const override;
+
+  private :
+    Method m_method;
+    double m_fraction;
+    DirtyRanges m_dirty;
+    std::vector<float> m_points;
+    GLuint m_vao=0;
+    PointBuffer m_buffer;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the index in the workload of the next new position, past the points first made
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t m_next=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what the updates since create wrote
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_updates=0;
+    size_t m_changedBytes=0;
+    size_t m_uploadedBytes=0;
+    size_t m_writes=0;
+};
+
+#endif
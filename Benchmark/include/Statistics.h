@@ -0,0 +1,30 @@
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+#include <cstddef>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Statistics.h
+/// @brief summary of a set of timing samples in milliseconds
+//----------------------------------------------------------------------------------------------------------------------
+
+struct Statistics
+{
+  size_t count=0;
+  double min=0.0;
+  double mean=0.0;
+  double p50=0.0;
+  double p90=0.0;
+  double p99=0.0;
+  double max=0.0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compute the summary, percentiles are linearly interpolated between the nearest samples
+  /// @param _samples the samples, taken by value as they need sorting
+  //----------------------------------------------------------------------------------------------------------------------
+  static Statistics compute(std::vector<double> _samples);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the _p percentile (0-100) of sorted samples
+  //----------------------------------------------------------------------------------------------------------------------
+  static double percentile(const std::vector<double> &_sorted, double _p);
+};
+
+#endif
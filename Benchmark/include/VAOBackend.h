@@ -0,0 +1,36 @@
+#ifndef VAOBACKEND_H_
+#define VAOBACKEND_H_
+#include "RenderBackend.h"
+#include "MortonSort.h"
+#include <ngl/AbstractVAO.h>
+#include <ngl/Vec3.h>
+#include <memory>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file VAOBackend.h
+/// @brief the PointsVAO demo, the points are held in a ngl::SimpleVAO made by the ngl::VAOFactory.
+/// When sorted the points are put in Morton order before they are uploaded (the sort is in the create and
+/// update times) so the draw times show what drawing neighbouring points together is worth.
+//----------------------------------------------------------------------------------------------------------------------
+
+class VAOBackend : public RenderBackend
+{
+  public :
+    explicit VAOBackend(bool _sorted=false) : m_sorted(_sorted){}
+    std::string name() const override {return m_sorted ? "PointsVAO-sorted" : "PointsVAO";}
+    void create(unsigned int _size) override;
+    void update(unsigned int _size) override;
+    void draw(const ngl::Mat4 &_MVP) override;
+    void destroy() override;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate a set of points, sorted if m_sorted is set
+    //----------------------------------------------------------------------------------------------------------------------
+    void generate(std::vector<ngl::Vec3> &o_points, unsigned int _size);
+    bool m_sorted;
+    MortonSort m_sorter;
+    std::unique_ptr<ngl::AbstractVAO> m_vao;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "AttributeBackend.h"
+#include <vector>
+
+void AttributeBackend::create(unsigned int _size)
+{
+  std::vector<float> points(_size*3);
+  m_generator.generate(points.data(),_size);
+  m_points.setPoints(points.data(),_size);
+  m_points.upload();
+}
+
+void AttributeBackend::update(unsigned int _size)
+{
+  m_generator.setSeed(m_generator.seed()+1);
+  std::vector<float> points(_size*3);
+  m_generator.generate(points.data(),_size);
+  m_points.setPositions(points.data());
+  m_points.upload();
+}
+
+void AttributeBackend::draw(const ngl::Mat4 &)
+{
+  // the MVP is read from the FrameUniforms block
+  m_points.draw();
+}
+
+void AttributeBackend::destroy()
+{
+  m_points.release();
+}
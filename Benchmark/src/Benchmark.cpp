@@ -0,0 +1,210 @@
+#include "Benchmark.h"
+#include "GLState.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <ngl/Util.h>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief run _func and wait for the GPU to finish, returns the elapsed time in ms
+  //----------------------------------------------------------------------------------------------------------------------
+  template <typename Func>
+  double timeMs(Func _func)
+  {
+    // the backends mix raw binds with ones made through the GLState cache so it can't be trusted between calls
+    GLState::instance()->invalidate();
+    auto start=std::chrono::steady_clock::now();
+    _func();
+    glFinish();
+    auto end=std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(end-start).count();
+  }
+}
+
+void Benchmark::addBackend(std::unique_ptr<RenderBackend> _backend)
+{
+  _backend->setWorkload(m_config.workload);
+  m_backends.push_back(std::move(_backend));
+}
+
+std::vector<unsigned int> Benchmark::sizes() const
+{
+  std::vector<unsigned int> sizes;
+  double step=std::pow(10.0,1.0/std::max(1u,m_config.stepsPerDecade));
+  for(double n=m_config.minPoints; n<=m_config.maxPoints*1.0001; n*=step)
+  {
+    sizes.push_back(static_cast<unsigned int>(std::round(n)));
+  }
+  return sizes;
+}
+
+void Benchmark::run()
+{
+  m_results.clear();
+  for(auto &backend : m_backends)
+  {
+    if(!backend->isSupported())
+    {
+      std::cout<<backend->name()<<" is not supported by this context, skipping\n";
+      continue;
+    }
+    for(auto size : sizes())
+    {
+      runBackend(*backend,size);
+    }
+  }
+  // the context may be gone by the time we are destroyed
+  m_frame.release();
+}
+
+void Benchmark::runBackend(RenderBackend &_backend, unsigned int _size)
+{
+  const unsigned int total=m_config.warmup+m_config.iterations;
+  std::vector<double> samples;
+  samples.reserve(m_config.iterations);
+
+  // create, every iteration apart from the last is destroyed again (untimed)
+  for(unsigned int i=0; i<total; ++i)
+  {
+    double t=timeMs([&]{_backend.create(_size);});
+    if(i >= m_config.warmup)
+    {
+      samples.push_back(t);
+    }
+    if(i+1 < total)
+    {
+      _backend.destroy();
+      glFinish();
+    }
+  }
+  record(_backend,_size,"create",samples);
+
+  samples.clear();
+  for(unsigned int i=0; i<total; ++i)
+  {
+    double t=timeMs([&]{_backend.update(_size);});
+    if(i >= m_config.warmup)
+    {
+      samples.push_back(t);
+    }
+  }
+  record(_backend,_size,"update",samples);
+  std::string stats=_backend.updateStats();
+  if(!stats.empty())
+  {
+    std::cout<<"  "<<stats<<"\n";
+  }
+
+  // same static camera as the demos, the cloud rotates a little each frame
+  ngl::Mat4 view=ngl::lookAt(ngl::Vec3(5,5,5),ngl::Vec3(0,0,0),ngl::Vec3(0,1,0));
+  ngl::Mat4 perspective=ngl::perspective(45.0f,float(m_config.width)/m_config.height,0.1f,100.0f);
+  ngl::Mat4 vp=perspective*view;
+  samples.clear();
+  for(unsigned int i=0; i<total; ++i)
+  {
+    ngl::Mat4 rotation;
+    rotation.rotateY(i*0.1f);
+    ngl::Mat4 MVP=vp*rotation;
+    double t=timeMs([&]
+    {
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      m_frame.update(view,perspective,MVP,m_config.width,m_config.height,i/60.0f,1.0f/60.0f);
+      _backend.draw(MVP);
+      m_frame.endFrame();
+    });
+    if(i >= m_config.warmup)
+    {
+      samples.push_back(t);
+    }
+  }
+  record(_backend,_size,"draw",samples);
+  _backend.destroy();
+  glFinish();
+}
+
+void Benchmark::record(const RenderBackend &_backend, unsigned int _size, const std::string &_phase, const std::vector<double> &_samples)
+{
+  Result r;
+  r.backend=_backend.name();
+  r.points=_size;
+  r.phase=_phase;
+  r.stats=Statistics::compute(_samples);
+  std::cout<<std::left<<std::setw(16)<<r.backend<<std::right<<std::setw(10)<<r.points<<' '
+           <<std::left<<std::setw(8)<<r.phase<<std::right<<std::fixed<<std::setprecision(3)
+           <<" p50 "<<std::setw(10)<<r.stats.p50<<" ms  p90 "<<std::setw(10)<<r.stats.p90
+           <<" ms  p99 "<<std::setw(10)<<r.stats.p99<<" ms\n";
+  m_results.push_back(r);
+}
+
+bool Benchmark::writeCSV(const std::string &_fname, const std::string &_renderer) const
+{
+  std::ofstream file(_fname);
+  if(!file.is_open())
+  {
+    std::cerr<<"unable to open "<<_fname<<" for writing\n";
+    return false;
+  }
+  file<<"backend,points,phase,iterations,min_ms,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,renderer,workload\n";
+  file<<std::setprecision(6);
+  for(const auto &r : m_results)
+  {
+    file<<r.backend<<','<<r.points<<','<<r.phase<<','<<r.stats.count<<','
+        <<r.stats.min<<','<<r.stats.mean<<','<<r.stats.p50<<','<<r.stats.p90<<','
+        <<r.stats.p99<<','<<r.stats.max<<",\""<<_renderer<<"\","<<Workload::shapeName(m_config.workload)<<'\n';
+  }
+  return true;
+}
+
+bool Benchmark::writeJSON(const std::string &_fname, const std::string &_renderer) const
+{
+  QJsonObject config;
+  config["minPoints"]=static_cast<double>(m_config.minPoints);
+  config["maxPoints"]=static_cast<double>(m_config.maxPoints);
+  config["stepsPerDecade"]=static_cast<int>(m_config.stepsPerDecade);
+  config["warmup"]=static_cast<int>(m_config.warmup);
+  config["iterations"]=static_cast<int>(m_config.iterations);
+  config["width"]=m_config.width;
+  config["height"]=m_config.height;
+  config["workload"]=Workload::shapeName(m_config.workload);
+
+  QJsonArray results;
+  for(const auto &r : m_results)
+  {
+    QJsonObject row;
+    row["backend"]=QString::fromStdString(r.backend);
+    row["points"]=static_cast<double>(r.points);
+    row["phase"]=QString::fromStdString(r.phase);
+    row["iterations"]=static_cast<double>(r.stats.count);
+    row["min_ms"]=r.stats.min;
+    row["mean_ms"]=r.stats.mean;
+    row["p50_ms"]=r.stats.p50;
+    row["p90_ms"]=r.stats.p90;
+    row["p99_ms"]=r.stats.p99;
+    row["max_ms"]=r.stats.max;
+    results.append(row);
+  }
+
+  QJsonObject root;
+  root["renderer"]=QString::fromStdString(_renderer);
+  root["date"]=QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+  root["config"]=config;
+  root["results"]=results;
+
+  QFile file(QString::fromStdString(_fname));
+  if(!file.open(QIODevice::WriteOnly))
+  {
+    std::cerr<<"unable to open "<<_fname<<" for writing\n";
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson());
+  return true;
+}
@@ -0,0 +1,41 @@
+#include "ComputeBackend.h"
+#include <ngl/Vec3.h>
+
+void ComputeBackend::generate(unsigned int _size)
+{
+  m_buffer.resize(_size*sizeof(ngl::Vec3));
+  Workload &generator=m_generator;
+  m_buffer.write(0,_size*sizeof(ngl::Vec3),[&generator,_size](void *o_xyz)
+  {
+    generator.generate(static_cast<float *>(o_xyz),_size);
+  });
+  m_count=_size;
+}
+
+void ComputeBackend::create(unsigned int _size)
+{
+  generate(_size);
+}
+
+void ComputeBackend::update(unsigned int _size)
+{
+  m_generator.setSeed(m_generator.seed()+1);
+  generate(_size);
+}
+
+void ComputeBackend::draw(const ngl::Mat4 &)
+{
+  // the MVP and viewport are read from the FrameUniforms block, the target is sized to the FBO
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT,viewport);
+  m_rasteriser.begin(viewport[2],viewport[3]);
+  m_rasteriser.rasterise(m_buffer.id(),0,m_count);
+  m_rasteriser.resolve();
+}
+
+void ComputeBackend::destroy()
+{
+  m_buffer.release();
+  m_rasteriser.release();
+  m_count=0;
+}
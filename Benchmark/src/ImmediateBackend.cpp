@@ -0,0 +1,43 @@
+#include "ImmediateBackend.h"
+#include <QOpenGLContext>
+
+bool ImmediateBackend::isSupported() const
+{
+  // glBegin / glEnd were removed from the core profile
+  QOpenGLContext *context=QOpenGLContext::currentContext();
+  return context != nullptr && context->format().profile() != QSurfaceFormat::CoreProfile;
+}
+
+void ImmediateBackend::create(unsigned int _size)
+{
+  m_points.resize(_size);
+  m_generator.generate(&m_points[0].m_x,_size);
+}
+
+void ImmediateBackend::update(unsigned int _size)
+{
+  m_generator.setSeed(m_generator.seed()+1);
+  m_points.resize(_size);
+  m_generator.generate(&m_points[0].m_x,_size);
+}
+
+void ImmediateBackend::draw(const ngl::Mat4 &_MVP)
+{
+  // fixed function so make sure no shader or VAO is active
+  glUseProgram(0);
+  glBindVertexArray(0);
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glMatrixMode(GL_MODELVIEW);
+  glLoadMatrixf(&_MVP.m_openGL[0]);
+  glBegin(GL_POINTS);
+    for(unsigned int i=0; i<m_points.size(); ++i)
+      glVertex3fv(&m_points[i].m_x);
+  glEnd();
+}
+
+void ImmediateBackend::destroy()
+{
+  m_points.clear();
+  m_points.shrink_to_fit();
+}
@@ -0,0 +1,23 @@
+#include "ProceduralBackend.h"
+
+void ProceduralBackend::create(unsigned int _size)
+{
+  m_points.setSize(_size);
+}
+
+void ProceduralBackend::update(unsigned int _size)
+{
+  m_points.setSeed(m_points.seed()+1);
+  m_points.setSize(_size);
+}
+
+void ProceduralBackend::draw(const ngl::Mat4 &)
+{
+  // the MVP is read from the FrameUniforms block
+  m_points.draw();
+}
+
+void ProceduralBackend::destroy()
+{
+  m_points.release();
+}
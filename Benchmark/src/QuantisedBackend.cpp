@@ -0,0 +1,30 @@
+#include "QuantisedBackend.h"
+#include <vector>
+
+void QuantisedBackend::create(unsigned int _size)
+{
+  std::vector<float> points(_size*3);
+  m_generator.generate(points.data(),_size);
+  m_points.quantise(points.data(),_size);
+  m_points.upload();
+}
+
+void QuantisedBackend::update(unsigned int _size)
+{
+  m_generator.setSeed(m_generator.seed()+1);
+  std::vector<float> points(_size*3);
+  m_generator.generate(points.data(),_size);
+  m_points.quantise(points.data(),_size);
+  m_points.upload();
+}
+
+void QuantisedBackend::draw(const ngl::Mat4 &)
+{
+  // the MVP is read from the FrameUniforms block
+  m_points.draw();
+}
+
+void QuantisedBackend::destroy()
+{
+  m_points.release();
+}
@@ -0,0 +1,80 @@
+#include "RawGLBackend.h"
+#include <ngl/ShaderLib.h>
+#include <ngl/Vec3.h>
+#include <vector>
+
+void RawGLBackend::writeMapped(unsigned int _size)
+{
+  if(m_buffer.resize(_size*sizeof(ngl::Vec3)))
+  {
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER,m_buffer.id());
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,0,((ngl::Real *)NULL + 0));
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+  }
+  Workload &generator=m_generator;
+  m_buffer.write(0,_size*sizeof(ngl::Vec3),[&generator,_size](void *o_xyz)
+  {
+    generator.generate(static_cast<float *>(o_xyz),_size);
+  });
+  m_count=static_cast<GLsizei>(_size);
+}
+
+void RawGLBackend::create(unsigned int _size)
+{
+  if(m_mapped)
+  {
+    glGenVertexArrays(1, &m_vao);
+    writeMapped(_size);
+    return;
+  }
+  std::vector<ngl::Vec3> points(_size);
+  m_generator.generate(&points[0].m_x,_size);
+  glGenVertexArrays(1, &m_vao);
+  glBindVertexArray(m_vao);
+  glGenBuffers(1, &m_vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, points.size()*sizeof(ngl::Vec3), &points[0].m_x, GL_STATIC_DRAW);
+  glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,0,((ngl::Real *)NULL + 0));
+  glEnableVertexAttribArray(0);
+  glBindVertexArray(0);
+  m_count=static_cast<GLsizei>(_size);
+}
+
+void RawGLBackend::update(unsigned int _size)
+{
+  m_generator.setSeed(m_generator.seed()+1);
+  if(m_mapped)
+  {
+    writeMapped(_size);
+    return;
+  }
+  std::vector<ngl::Vec3> points(_size);
+  m_generator.generate(&points[0].m_x,_size);
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, points.size()*sizeof(ngl::Vec3), &points[0].m_x, GL_STATIC_DRAW);
+  glBindVertexArray(0);
+  m_count=static_cast<GLsizei>(_size);
+}
+
+void RawGLBackend::draw(const ngl::Mat4 &_MVP)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->use("nglColourShader");
+  shader->setUniform("MVP",_MVP);
+  glBindVertexArray(m_vao);
+  glDrawArrays(GL_POINTS,0,m_count);
+  glBindVertexArray(0);
+}
+
+void RawGLBackend::destroy()
+{
+  m_buffer.release();
+  glDeleteBuffers(1,&m_vbo);
+  glDeleteVertexArrays(1,&m_vao);
+  m_vbo=0;
+  m_vao=0;
+  m_count=0;
+}
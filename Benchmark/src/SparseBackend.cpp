@@ -0,0 +1,111 @@
+#include "SparseBackend.h"
+#include "Philox.h"
+#include <ngl/ShaderLib.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+  /// @brief the Philox stream the moved points are picked with
+  constexpr uint32_t s_pickStream=3;
+}
+
+SparseBackend::SparseBackend(Method _method, double _fraction, size_t _gap) :
+  m_method(_method), m_fraction(_fraction), m_dirty(_gap)
+{
+}
+
+std::string SparseBackend::name() const
+{
+  std::ostringstream name;
+  name<<"Sparse-"<<(m_method == Method::Full ? "full" : m_method == Method::SubData ? "subdata" : "mapped")
+      <<'-'<<m_fraction*100.0<<'%';
+  return name.str();
+}
+
+void SparseBackend::create(unsigned int _size)
+{
+  m_points.resize(static_cast<size_t>(_size)*3);
+  m_generator.generate(m_points.data(),_size);
+  glGenVertexArrays(1,&m_vao);
+  m_buffer.resize(m_points.size()*sizeof(float));
+  m_buffer.upload(0,m_points.size()*sizeof(float),m_points.data());
+  glBindVertexArray(m_vao);
+  glBindBuffer(GL_ARRAY_BUFFER,m_buffer.id());
+  glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,0,((ngl::Real *)NULL + 0));
+  glEnableVertexAttribArray(0);
+  glBindVertexArray(0);
+  m_dirty.clear();
+  m_dirty.resetStats();
+  m_next=_size;
+  m_updates=0;
+  m_changedBytes=0;
+  m_uploadedBytes=0;
+  m_writes=0;
+}
+
+void SparseBackend::update(unsigned int _size)
+{
+  const size_t stride=3*sizeof(float);
+  size_t count=std::max<size_t>(1,static_cast<size_t>(_size*m_fraction));
+  for(size_t i=0; i<count; ++i,++m_next)
+  {
+    // a new reading for a scattered point, the position comes from further along the workload
+    size_t index=philox::generate(m_next,s_pickStream,m_generator.seed()).v[0]%_size;
+    m_generator.generateSerial(&m_points[index*3],1,m_next);
+    m_dirty.markElements(index,1,stride);
+  }
+  ++m_updates;
+  if(m_method == Method::Full)
+  {
+    // what updatePoints does, every point is written again
+    m_dirty.coalesce();
+    m_changedBytes+=m_dirty.changedBytes();
+    m_uploadedBytes+=m_points.size()*sizeof(float);
+    ++m_writes;
+    m_dirty.clear();
+    const std::vector<float> &points=m_points;
+    m_buffer.write(0,points.size()*sizeof(float),[&points](void *o_xyz)
+    {
+      std::memcpy(o_xyz,points.data(),points.size()*sizeof(float));
+    });
+    return;
+  }
+  DirtyRanges::Stats before=m_dirty.stats();
+  m_buffer.flush(m_dirty,m_points.data(),m_method == Method::Mapped);
+  m_changedBytes+=m_dirty.stats().changedBytes-before.changedBytes;
+  m_uploadedBytes+=m_dirty.stats().uploadedBytes-before.uploadedBytes;
+  m_writes+=m_dirty.stats().ranges-before.ranges;
+}
+
+void SparseBackend::draw(const ngl::Mat4 &_MVP)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->use("nglColourShader");
+  shader->setUniform("MVP",_MVP);
+  glBindVertexArray(m_vao);
+  glDrawArrays(GL_POINTS,0,static_cast<GLsizei>(m_points.size()/3));
+  glBindVertexArray(0);
+}
+
+void SparseBackend::destroy()
+{
+  m_buffer.release();
+  glDeleteVertexArrays(1,&m_vao);
+  m_vao=0;
+  std::vector<float>().swap(m_points);
+}
+
+std::string SparseBackend::updateStats() const
+{
+  if(m_updates == 0)
+  {
+    return std::string();
+  }
+  std::ostringstream line;
+  line<<"per update "<<m_changedBytes/m_updates/1024.0<<" KB changed, "<<m_uploadedBytes/m_updates/1024.0
+      <<" KB uploaded in "<<static_cast<double>(m_writes)/m_updates<<(m_method == Method::Mapped ? " flushed ranges" : " writes")
+      <<" ("<<(m_changedBytes > 0 ? static_cast<double>(m_uploadedBytes)/m_changedBytes : 0.0)<<"x the bytes changed)";
+  return line.str();
+}
@@ -0,0 +1,34 @@
+#include "Statistics.h"
+#include <algorithm>
+#include <numeric>
+
+double Statistics::percentile(const std::vector<double> &_sorted, double _p)
+{
+  if(_sorted.empty())
+  {
+    return 0.0;
+  }
+  double rank=(_p/100.0)*(_sorted.size()-1);
+  size_t lower=static_cast<size_t>(rank);
+  size_t upper=std::min(lower+1,_sorted.size()-1);
+  double t=rank-lower;
+  return _sorted[lower]+(_sorted[upper]-_sorted[lower])*t;
+}
+
+Statistics Statistics::compute(std::vector<double> _samples)
+{
+  Statistics s;
+  if(_samples.empty())
+  {
+    return s;
+  }
+  std::sort(_samples.begin(),_samples.end());
+  s.count=_samples.size();
+  s.min=_samples.front();
+  s.max=_samples.back();
+  s.mean=std::accumulate(_samples.begin(),_samples.end(),0.0)/_samples.size();
+  s.p50=percentile(_samples,50.0);
+  s.p90=percentile(_samples,90.0);
+  s.p99=percentile(_samples,99.0);
+  return s;
+}
@@ -0,0 +1,56 @@
+#include "VAOBackend.h"
+#include <ngl/ShaderLib.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/VAOFactory.h>
+#include <ngl/Vec3.h>
+#include <vector>
+
+void VAOBackend::generate(std::vector<ngl::Vec3> &o_points, unsigned int _size)
+{
+  o_points.resize(_size);
+  m_generator.generate(&o_points[0].m_x,_size);
+  if(m_sorted)
+  {
+    m_sorter.sort(&o_points[0].m_x,_size);
+    m_sorter.reorder(o_points);
+  }
+}
+
+void VAOBackend::create(unsigned int _size)
+{
+  std::vector<ngl::Vec3> points;
+  generate(points,_size);
+  m_vao= ngl::VAOFactory::createVAO(ngl::simpleVAO,GL_POINTS);
+  m_vao->bind();
+  m_vao->setData(ngl::SimpleVAO::VertexData(points.size()*sizeof(ngl::Vec3),points[0].m_x));
+  m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  m_vao->setNumIndices(points.size());
+  m_vao->unbind();
+}
+
+void VAOBackend::update(unsigned int _size)
+{
+  m_generator.setSeed(m_generator.seed()+1);
+  std::vector<ngl::Vec3> points;
+  generate(points,_size);
+  m_vao->bind();
+  glBindBuffer(GL_ARRAY_BUFFER, m_vao->getBufferID(0));
+  glBufferData(GL_ARRAY_BUFFER, points.size()*sizeof(ngl::Vec3), &points[0].m_x, GL_STATIC_DRAW);
+  m_vao->setNumIndices(points.size());
+  m_vao->unbind();
+}
+
+void VAOBackend::draw(const ngl::Mat4 &_MVP)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->use("nglColourShader");
+  shader->setUniform("MVP",_MVP);
+  m_vao->bind();
+  m_vao->draw();
+  m_vao->unbind();
+}
+
+void VAOBackend::destroy()
+{
+  m_vao.reset();
+}
@@ -0,0 +1,172 @@
+/****************************************************************************
+headless benchmark of the drawing demos, everything is rendered offscreen into
+an FBO so this can be run on a machine without a display (e.g. Mesa llvmpipe)
+****************************************************************************/
+#include <QtGui/QGuiApplication>
+#include <QCommandLineParser>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <ngl/NGLInit.h>
+#include <ngl/ShaderLib.h>
+#include <iostream>
+#include "AttributeBackend.h"
+#include "Benchmark.h"
+#include "ComputeBackend.h"
+#include "ImmediateBackend.h"
+#include "MortonSort.h"
+#include "ProceduralBackend.h"
+#include "QuantisedBackend.h"
+#include "RawGLBackend.h"
+#include "SparseBackend.h"
+#include "VAOBackend.h"
+#include "Workload.h"
+
+// the split behaviour moved to the Qt namespace in 5.14 and the QString one is deprecated from then
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+  static constexpr auto s_skipEmptyParts=Qt::SkipEmptyParts;
+#else
+  static constexpr auto s_skipEmptyParts=QString::SkipEmptyParts;
+#endif
+
+int main(int argc, char **argv)
+{
+  QGuiApplication app(argc, argv);
+  QCoreApplication::setApplicationName("Benchmark");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Times the create, update and draw phases of each drawing demo offscreen");
+  parser.addHelpOption();
+  QCommandLineOption minOption("min","smallest number of points","count","1000");
+  QCommandLineOption maxOption("max","largest number of points","count","10000000");
+  QCommandLineOption stepsOption("steps","point counts per power of ten","steps","1");
+  QCommandLineOption warmupOption("warmup","untimed runs before each phase","count","2");
+  QCommandLineOption iterationsOption("iterations","timed runs of each phase","count","10");
+  QCommandLineOption widthOption("width","framebuffer width","pixels","1024");
+  QCommandLineOption heightOption("height","framebuffer height","pixels","720");
+  QCommandLineOption backendsOption("backends","comma separated list of backends to run (default all)","names");
+  QCommandLineOption csvOption("csv","write the results to a CSV file","file");
+  QCommandLineOption jsonOption("json","write the results to a JSON file","file");
+  QCommandLineOption sortOption("sort-throughput","time the Morton sort of --max points and exit");
+  QCommandLineOption workloadOption("workload",QString::fromStdString("the shape of the points : "+Workload::shapeNames()),
+                                    "shape","uniform");
+  QCommandLineOption workloadThroughputOption("workload-throughput","time generating --max points of every workload and exit");
+  QCommandLineOption sparsityOption("sparsity","also run the Sparse backends, each update moves this comma separated list of fractions of the points","fractions");
+  QCommandLineOption gapOption("gap","changed ranges at most this many bytes apart are uploaded as one by the Sparse backends","bytes","1024");
+  parser.addOptions({minOption,maxOption,stepsOption,warmupOption,iterationsOption,widthOption,heightOption,
+                     backendsOption,csvOption,jsonOption,sortOption,workloadOption,workloadThroughputOption,
+                     sparsityOption,gapOption});
+  parser.process(app);
+
+  if(parser.isSet(sortOption))
+  {
+    MortonSort::benchmark(parser.value(maxOption).toUInt(),std::max(1u,parser.value(iterationsOption).toUInt()),std::cout);
+    return EXIT_SUCCESS;
+  }
+  if(parser.isSet(workloadThroughputOption))
+  {
+    Workload::benchmark(parser.value(maxOption).toUInt(),std::max(1u,parser.value(iterationsOption).toUInt()),std::cout);
+    return EXIT_SUCCESS;
+  }
+
+  Benchmark::Config config;
+  config.minPoints=parser.value(minOption).toUInt();
+  config.maxPoints=parser.value(maxOption).toUInt();
+  config.stepsPerDecade=parser.value(stepsOption).toUInt();
+  config.warmup=parser.value(warmupOption).toUInt();
+  config.iterations=std::max(1u,parser.value(iterationsOption).toUInt());
+  config.width=parser.value(widthOption).toInt();
+  config.height=parser.value(heightOption).toInt();
+  if(!Workload::parseShape(parser.value(workloadOption).toStdString(),config.workload))
+  {
+    std::cerr<<"unknown workload "<<parser.value(workloadOption).toStdString()<<", use one of "<<Workload::shapeNames()<<"\n";
+    return EXIT_FAILURE;
+  }
+
+  // we want the immediate mode path as well so ask for a compatibility profile, the
+  // core profile demos still run as the shaders are valid in both
+  QSurfaceFormat format;
+  format.setMajorVersion(4);
+  format.setMinorVersion(3);
+  format.setProfile(QSurfaceFormat::CompatibilityProfile);
+  format.setDepthBufferSize(24);
+
+  QOffscreenSurface surface;
+  surface.setFormat(format);
+  surface.create();
+  QOpenGLContext context;
+  context.setFormat(format);
+  if(!context.create() || !context.makeCurrent(&surface))
+  {
+    std::cerr<<"unable to create an OpenGL context\n";
+    return EXIT_FAILURE;
+  }
+  ngl::NGLInit::instance();
+  std::string renderer=reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+  std::cout<<"Renderer "<<renderer<<" version "<<glGetString(GL_VERSION)<<"\n";
+  std::cout<<"Workload "<<Workload::shapeName(config.workload)<<"\n";
+
+  // render into an FBO rather than a window
+  QOpenGLFramebufferObjectFormat fboFormat;
+  fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+  QOpenGLFramebufferObject fbo(config.width,config.height,fboFormat);
+  fbo.bind();
+  glViewport(0,0,config.width,config.height);
+  glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+  glEnable(GL_DEPTH_TEST);
+  glPointSize(5);
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->use("nglColourShader");
+  shader->setUniform("Colour",1.0f,1.0f,1.0f,1.0f);
+
+  std::vector<std::unique_ptr<RenderBackend>> backends;
+  backends.emplace_back(new ImmediateBackend);
+  backends.emplace_back(new RawGLBackend);
+  backends.emplace_back(new RawGLBackend(true));
+  backends.emplace_back(new VAOBackend);
+  backends.emplace_back(new VAOBackend(true));
+  backends.emplace_back(new QuantisedBackend(QuantisedPoints::Format::Short));
+  backends.emplace_back(new QuantisedBackend(QuantisedPoints::Format::Packed1010102));
+  backends.emplace_back(new AttributeBackend(AttributePoints::Layout::Interleaved));
+  backends.emplace_back(new AttributeBackend(AttributePoints::Layout::Separate));
+  backends.emplace_back(new AttributeBackend(AttributePoints::Layout::HotCold));
+  backends.emplace_back(new ProceduralBackend);
+  backends.emplace_back(new ComputeBackend);
+  size_t gap=parser.value(gapOption).toUInt();
+  for(const auto &fraction : parser.value(sparsityOption).split(',',s_skipEmptyParts))
+  {
+    double f=fraction.toDouble();
+    if(f <= 0.0 || f > 1.0)
+    {
+      std::cerr<<"sparsity "<<fraction.toStdString()<<" is not a fraction in (0,1], skipping\n";
+      continue;
+    }
+    backends.emplace_back(new SparseBackend(SparseBackend::Method::Full,f,gap));
+    backends.emplace_back(new SparseBackend(SparseBackend::Method::SubData,f,gap));
+    backends.emplace_back(new SparseBackend(SparseBackend::Method::Mapped,f,gap));
+  }
+
+  QStringList wanted=parser.value(backendsOption).split(',',s_skipEmptyParts);
+  Benchmark benchmark(config);
+  for(auto &backend : backends)
+  {
+    if(wanted.isEmpty() || wanted.contains(QString::fromStdString(backend->name())))
+    {
+      benchmark.addBackend(std::move(backend));
+    }
+  }
+  benchmark.run();
+
+  bool ok=true;
+  if(parser.isSet(csvOption))
+  {
+    ok&=benchmark.writeCSV(parser.value(csvOption).toStdString(),renderer);
+  }
+  if(parser.isSet(jsonOption))
+  {
+    ok&=benchmark.writeJSON(parser.value(jsonOption).toStdString(),renderer);
+  }
+  fbo.release();
+  context.doneCurrent();
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,54 @@
+# code shared by all of the drawing demos, include this from a demo's .pro file
+INCLUDEPATH += $$PWD/include
+# uncomment to compile the TRACE_SCOPE markers out, recording then only has the frame events
+# DEFINES += NO_TRACE
+SOURCES+= $$PWD/src/ThreadPool.cpp \
+					$$PWD/src/PointGenerator.cpp \
+					$$PWD/src/Workload.cpp \
+					$$PWD/src/FrameProfiler.cpp \
+					$$PWD/src/FrameScheduler.cpp \
+					$$PWD/src/FrameUniforms.cpp \
+					$$PWD/src/FrameCapture.cpp \
+					$$PWD/src/BatchRenderer.cpp \
+					$$PWD/src/GLState.cpp \
+					$$PWD/src/Trace.cpp \
+					$$PWD/src/ProgramCache.cpp \
+					$$PWD/src/ScratchPool.cpp \
+					$$PWD/src/PointBuffer.cpp \
+					$$PWD/src/DirtyRanges.cpp \
+					$$PWD/src/PointCloudLoader.cpp \
+					$$PWD/src/OctreeFile.cpp \
+					$$PWD/src/Frustum.cpp \
+					$$PWD/src/MortonSort.cpp \
+					$$PWD/src/ChunkGrid.cpp \
+					$$PWD/src/QuantisedPoints.cpp \
+					$$PWD/src/AttributePoints.cpp \
+					$$PWD/src/ProceduralPoints.cpp \
+					$$PWD/src/ParticleSystem.cpp \
+					$$PWD/src/ComputeRasteriser.cpp
+HEADERS+= $$PWD/include/ThreadPool.h \
+					$$PWD/include/Philox.h \
+					$$PWD/include/PointGenerator.h \
+					$$PWD/include/Workload.h \
+					$$PWD/include/FrameProfiler.h \
+					$$PWD/include/FrameScheduler.h \
+					$$PWD/include/FrameUniforms.h \
+					$$PWD/include/FrameCapture.h \
+					$$PWD/include/BatchRenderer.h \
+					$$PWD/include/GLState.h \
+					$$PWD/include/Trace.h \
+					$$PWD/include/ProgramCache.h \
+					$$PWD/include/ScratchPool.h \
+					$$PWD/include/PointBuffer.h \
+					$$PWD/include/DirtyRanges.h \
+					$$PWD/include/PointCloudLoader.h \
+					$$PWD/include/OctreeFile.h \
+					$$PWD/include/Frustum.h \
+					$$PWD/include/Morton.h \
+					$$PWD/include/MortonSort.h \
+					$$PWD/include/ChunkGrid.h \
+					$$PWD/include/QuantisedPoints.h \
+					$$PWD/include/AttributePoints.h \
+					$$PWD/include/ProceduralPoints.h \
+					$$PWD/include/ParticleSystem.h \
+					$$PWD/include/ComputeRasteriser.h
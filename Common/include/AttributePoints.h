@@ -0,0 +1,145 @@
+#ifndef ATTRIBUTEPOINTS_H_
+#define ATTRIBUTEPOINTS_H_
+#include <ngl/Types.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AttributePoints.h
+/// @brief points with a per point colour, size and intensity as well as the position
+/// @class AttributePoints
+/// @brief the attributes can be laid out in memory three ways
+/// * Interleaved : one buffer of x y z rgba size intensity (24 bytes) per point, AoS
+/// * Separate : a buffer per attribute, SoA
+/// * HotCold : the positions (the hot data which changes every update) in one buffer and the colour,
+///   size and intensity (cold) interleaved in a second one
+/// Each layout has its own fill kernel which writes its streams in order. setPositions only changes the
+/// positions, for Separate and HotCold only the position buffer is written and uploaded again but
+/// Interleaved has to re-upload everything. The colour is taken from the position in the bounds of the
+/// points and the intensity / size fall off away from the centre so the result is easy to check by eye.
+//----------------------------------------------------------------------------------------------------------------------
+
+class AttributePoints
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the memory layout of the attributes
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Layout{Interleaved,Separate,HotCold};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one point's attributes as the vertex shader sees them
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Point
+    {
+      float position[3];
+      uint32_t colour;
+      float size;
+      float intensity;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until upload
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit AttributePoints(Layout _layout=Layout::Interleaved);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor releases the GL objects
+    //----------------------------------------------------------------------------------------------------------------------
+    ~AttributePoints();
+    AttributePoints(const AttributePoints &)=delete;
+    AttributePoints & operator=(const AttributePoints &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set every attribute from a set of positions, the other attributes are made from the positions
+    /// @param _xyz packed x y z floats
+    /// @param _count the number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPoints(const float *_xyz, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief move the points keeping the other attributes, the count must match the last setPoints
+    /// @param _xyz packed x y z floats
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPositions(const float *_xyz);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read a point back from the layout's streams
+    //----------------------------------------------------------------------------------------------------------------------
+    Point point(size_t _index) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy the streams changed since the last upload to the GPU, the buffers only grow
+    //----------------------------------------------------------------------------------------------------------------------
+    void upload();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief use the attribute shader and bind the VAO so the caller can draw ranges of the points, the
+    /// MVP is read from the FrameUniforms block so it must have been updated this frame
+    /// @param _sizeScale multiplies the size of each point in pixels
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind(ngl::Real _sizeScale=1.0f) const;
+    void unbind() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw all of the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw(ngl::Real _sizeScale=1.0f) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the GL objects
+    //----------------------------------------------------------------------------------------------------------------------
+    void release();
+    Layout layout() const {return m_layout;}
+    size_t size() const {return m_count;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes of all the attributes of a point
+    //----------------------------------------------------------------------------------------------------------------------
+    static size_t bytesPerPoint() {return sizeof(Point);}
+    size_t bytes() const {return m_count*bytesPerPoint();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the layout as a string for messages
+    //----------------------------------------------------------------------------------------------------------------------
+    static const char *layoutName(Layout _layout);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one GL buffer and the CPU copy it is filled from
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stream
+    {
+      size_t stride;
+      std::vector<unsigned char> data;
+      GLuint buffer=0;
+      size_t capacity=0;
+      bool dirty=false;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where an attribute is, the stream and the byte offset in each element of it
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Attribute
+    {
+      size_t stream;
+      size_t offset;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the attributes in location order, position colour size intensity
+    //----------------------------------------------------------------------------------------------------------------------
+    enum AttributeIndex : size_t {Position,Colour,Size,Intensity,NumAttributes};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the attribute program for this context from the ProgramCache and look up the per draw uniform
+    //----------------------------------------------------------------------------------------------------------------------
+    void createShader();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the vertex attribute pointers for the current buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    void setAttributePointers();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief work out the colour, size and intensity of a point
+    //----------------------------------------------------------------------------------------------------------------------
+    void shade(const float *_p, uint32_t &o_colour, float &o_size, float &o_intensity) const;
+    Layout m_layout;
+    size_t m_count=0;
+    std::vector<Stream> m_streams;
+    Attribute m_attributes[NumAttributes];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the centre and half size of the last setPoints, used to make the colours
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_centre[3]={0.0f,0.0f,0.0f};
+    float m_halfSize[3]={1.0f,1.0f,1.0f};
+    GLuint m_program=0;
+    GLint m_sizeScaleLocation=-1;
+    GLuint m_vao=0;
+};
+
+#endif
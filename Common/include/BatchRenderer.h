@@ -0,0 +1,63 @@
+#ifndef BATCHRENDERER_H_
+#define BATCHRENDERER_H_
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <functional>
+#include <ostream>
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchRenderer.h
+/// @brief renders a demo's scene to an image sequence with no window, for headless machines
+/// @class BatchRenderer
+/// @brief run makes an offscreen context, calls the scene's initialise once then draws the frames into an
+/// FBO (resolving it when multisampled) and reads each one back with a FrameCapture, so frame k is being
+/// copied and written while the next frames are drawn. The frames per second of the whole run, the
+/// render loop alone and the time spent waiting on readback are printed at the end. The context is kept
+/// current until we are destroyed so create us before the scene, its dtor can then still release its
+/// GL objects.
+//----------------------------------------------------------------------------------------------------------------------
+
+class BatchRenderer
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the settings for a run
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Options
+    {
+      unsigned int frames=100;
+      int width=1024;
+      int height=720;
+      /// @brief where each frame is written, see FrameCapture
+      std::string pattern="frame%04d.png";
+      /// @brief frames being read back at once
+      unsigned int numPBOs=3;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _options the settings for the run
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit BatchRenderer(const Options &_options) : m_options(_options){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor, releases the context
+    //----------------------------------------------------------------------------------------------------------------------
+    ~BatchRenderer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief render the frames
+    /// @param _format the format the demo would give its window
+    /// @param _initialise called once the context is current, e.g. the scene's initializeGL and resizeGL
+    /// @param _paint called for each frame with the FBO bound, e.g. the scene's paintGL
+    /// @param _log where the results are printed
+    /// @returns false if there is no context or any frame could not be written
+    //----------------------------------------------------------------------------------------------------------------------
+    bool run(const QSurfaceFormat &_format, const std::function<void()> &_initialise, const std::function<void()> &_paint,
+             std::ostream &_log);
+
+  private :
+    Options m_options;
+    QOffscreenSurface m_surface;
+    QOpenGLContext m_context;
+};
+
+#endif
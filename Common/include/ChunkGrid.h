@@ -0,0 +1,114 @@
+#ifndef CHUNKGRID_H_
+#define CHUNKGRID_H_
+#include <ngl/Mat4.h>
+#include <ngl/Types.h>
+#include <ngl/Vec3.h>
+#include "MortonSort.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ChunkGrid.h
+/// @brief splits a point set into spatially coherent chunks which can be frustum culled on the CPU
+/// @class ChunkGrid
+/// @brief build sorts the points by the Morton code of their cell in a uniform grid over their bounds,
+/// so each non empty cell becomes one contiguous range of the vertex buffer with its own tight AABB.
+/// cull tests every chunk against the frustum of the MVP and builds the first / count arrays for a
+/// single glMultiDrawArrays, neighbouring visible chunks are merged into one range so a mostly
+/// visible cloud costs only a few draws.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ChunkGrid
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a range of the sorted points and its bounds
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Chunk
+    {
+      ngl::Vec3 min;
+      ngl::Vec3 max;
+      GLint first;
+      GLsizei count;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the results of the last cull
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      size_t visibleChunks=0;
+      size_t totalChunks=0;
+      size_t visiblePoints=0;
+      size_t totalPoints=0;
+      size_t draws=0;
+      double cullMs=0.0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _resolution cells along each axis of the grid, rounded up to a power of 2 as the cells are indexed by
+    /// their Morton code, at most s_maxResolution
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit ChunkGrid(unsigned int _resolution=16);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the finest grid, build keeps a count per cell so this is 2M cells
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr unsigned int s_maxResolution=128;
+    unsigned int resolution() const {return m_resolution;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sort the points into chunks, this re-orders the points in place
+    /// @param io_xyz packed x y z floats
+    /// @param _count the number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(float *io_xyz, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make the chunks from points already in Morton order, each range of the sort at the grid's
+    /// resolution (rounded up to a power of 2) becomes a chunk so nothing is moved
+    /// @param _xyz the packed x y z floats in the order of _sorted
+    /// @param _sorted the sort of the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(const float *_xyz, const MortonSort &_sorted);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief find the visible chunks and build the draw ranges
+    /// @param _mvp the full model view projection used to draw the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void cull(const ngl::Mat4 &_mvp);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the visible ranges with one glMultiDrawArrays, the VAO must be bound
+    /// @param _mode the primitive type
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw(GLenum _mode) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the ranges found by the last cull, for drawing them some other way than glMultiDrawArrays
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<GLint> &visibleFirsts() const {return m_firsts;}
+    const std::vector<GLsizei> &visibleCounts() const {return m_counts;}
+    void clear();
+    bool empty() const {return m_chunks.empty();}
+    const std::vector<Chunk> &chunks() const {return m_chunks;}
+    const Stats &stats() const {return m_stats;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the stats as a line for the HUD
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string hudLine() const;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add a chunk for a range of the points with the bounds of its points rather than its cell
+    //----------------------------------------------------------------------------------------------------------------------
+    void addChunk(const float *_xyz, size_t _first, size_t _count);
+    unsigned int m_resolution;
+    std::vector<Chunk> m_chunks;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the arguments for glMultiDrawArrays
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<GLint> m_firsts;
+    std::vector<GLsizei> m_counts;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counting sort's cell of each point and cell starts, kept so a rebuild doesn't allocate
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<uint32_t> m_cellOf;
+    std::vector<size_t> m_cellStart;
+    Stats m_stats;
+};
+
+#endif
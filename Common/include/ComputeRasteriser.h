@@ -0,0 +1,114 @@
+#ifndef COMPUTERASTERISER_H_
+#define COMPUTERASTERISER_H_
+#include <ngl/Types.h>
+#include <cstddef>
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ComputeRasteriser.h
+/// @brief draws points with a compute shader instead of the GL_POINTS pipeline
+/// @class ComputeRasteriser
+/// @brief when there are far more points than pixels most of the fixed function work is overdraw, here
+/// each point is one compute invocation which projects it with the MVP from the FrameUniforms block and
+/// does an atomicMin of its packed depth into every pixel of its point size square in a storage buffer
+/// the size of the viewport. With 64 bit atomics (GL_NV_shader_atomic_int64) the depth is the high word
+/// and the RGBA8 colour the low word so the nearest point's colour wins in the same atomic, otherwise
+/// (e.g. Mesa llvmpipe) only the 32 bit depth is stored and the colour comes from a uniform. resolve
+/// then draws a full screen triangle which writes the colour and gl_FragDepth of every covered pixel, so
+/// the result depth tests against anything else drawn. The depth is the float bit pattern of the window
+/// z, which orders the same as the float for values in [0,1]. Needs GL 4.3 for compute and storage buffers.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ComputeRasteriser
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what each pixel of the target holds
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Packing{Depth32,DepthColour64};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief does the current context have compute shaders and storage buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool isSupported();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until the first begin
+    /// @param _pointSize the width in pixels of the square each point covers, like glPointSize
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit ComputeRasteriser(int _pointSize=5);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor releases the buffer and VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    ~ComputeRasteriser();
+    ComputeRasteriser(const ComputeRasteriser &)=delete;
+    ComputeRasteriser & operator=(const ComputeRasteriser &)=delete;
+    void setPointSize(int _pointSize);
+    int pointSize() const {return m_pointSize;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the colour of the points, packed into the target with 64 bit atomics
+    //----------------------------------------------------------------------------------------------------------------------
+    void setColour(float _r, float _g, float _b, float _a);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start a frame, sizes the target to the viewport and clears it to the far plane
+    /// @param _width the viewport width in pixels, must match the FrameUniforms viewport
+    /// @param _height the viewport height in pixels
+    //----------------------------------------------------------------------------------------------------------------------
+    void begin(int _width, int _height);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief splat points from a buffer of packed floats into the target, can be called many times a frame.
+    /// The FrameUniforms block must have been updated this frame.
+    /// @param _buffer the buffer holding the points
+    /// @param _first the index of the first point
+    /// @param _count the number of points
+    /// @param _stride the floats from one point to the next, the position is the first three
+    //----------------------------------------------------------------------------------------------------------------------
+    void rasterise(GLuint _buffer, size_t _first, size_t _count, unsigned int _stride=3);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write the covered pixels to the bound framebuffer with their depth
+    //----------------------------------------------------------------------------------------------------------------------
+    void resolve();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the GL objects
+    //----------------------------------------------------------------------------------------------------------------------
+    void release();
+    Packing packing() const {return m_packing;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bytes of the target buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t targetBytes() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mode as a line for the HUD
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string hudLine() const;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief pick the packing and build the rasterise and resolve programs for it
+    //----------------------------------------------------------------------------------------------------------------------
+    void createShaders();
+    int m_pointSize;
+    GLuint m_colour=0xFFFFFFFFu;
+    float m_rgba[4]={1.0f,1.0f,1.0f,1.0f};
+    Packing m_packing=Packing::Depth32;
+    GLuint m_rasteriseProgram=0;
+    GLuint m_resolveProgram=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the uniform locations, looked up once when the programs are linked
+    //----------------------------------------------------------------------------------------------------------------------
+    GLint m_firstLocation=-1;
+    GLint m_countLocation=-1;
+    GLint m_strideLocation=-1;
+    GLint m_pointSizeLocation=-1;
+    GLint m_packedColourLocation=-1;
+    GLint m_colourLocation=-1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one value per pixel, 4 or 8 bytes depending on m_packing
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_target=0;
+    int m_width=0;
+    int m_height=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the full screen triangle needs a VAO bound even with no attributes
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_vao=0;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef DIRTYRANGES_H_
+#define DIRTYRANGES_H_
+#include <cstddef>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DirtyRanges.h
+/// @brief records which bytes of a buffer have changed so only they are uploaded
+/// @class DirtyRanges
+/// @brief mark is called as points are changed in a CPU copy of the buffer, it just appends so marking is cheap
+/// whatever the order, marks that pile up between flushes are sorted and the overlapping ones merged. coalesce
+/// merges any that are at most gap bytes apart, a few unchanged bytes cost less to upload than another call,
+/// and the result is the fewest ranges to write. PointBuffer::flush uploads them with glBufferSubData or one
+/// explicitly flushed mapping. The counters keep the bytes that actually changed against the bytes uploaded
+/// and the number of ranges so the gap can be tuned.
+//----------------------------------------------------------------------------------------------------------------------
+
+class DirtyRanges
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a byte range of the buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Range
+    {
+      size_t offset;
+      size_t bytes;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief totals over every flush
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      size_t flushes=0;
+      /// @brief ranges written, each is one glBufferSubData or glFlushMappedBufferRange
+      size_t ranges=0;
+      /// @brief bytes marked (overlaps counted once) and bytes uploaded, which includes the merged gaps
+      size_t changedBytes=0;
+      size_t uploadedBytes=0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _gap ranges at most this many bytes apart are merged
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit DirtyRanges(size_t _gap=1024) : m_gap(_gap){}
+    void setGap(size_t _gap){m_gap=_gap;}
+    size_t gap() const {return m_gap;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief record that _bytes from _offset have changed
+    //----------------------------------------------------------------------------------------------------------------------
+    void mark(size_t _offset, size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief record that _count elements of _stride bytes from element _first have changed
+    //----------------------------------------------------------------------------------------------------------------------
+    void markElements(size_t _first, size_t _count, size_t _stride){mark(_first*_stride,_count*_stride);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief has anything been marked since the last clear
+    //----------------------------------------------------------------------------------------------------------------------
+    bool empty() const {return m_marks.empty();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief merge the marks into the fewest ranges with no more than gap bytes between the parts of each
+    /// @returns the ranges in offset order, valid until the next mark or clear
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<Range> &coalesce();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bytes changed and the bytes the ranges cover at the last coalesce
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t changedBytes() const {return m_changedBytes;}
+    size_t rangeBytes() const {return m_rangeBytes;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add the last coalesce to the stats as one flush and forget the marks, called once the ranges are written
+    //----------------------------------------------------------------------------------------------------------------------
+    void flushed();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief forget the marks without counting them, e.g. when the whole buffer is written anyway
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear();
+    const Stats &stats() const {return m_stats;}
+    void resetStats(){m_stats=Stats();}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sort the marks and merge the ones that overlap or touch
+    //----------------------------------------------------------------------------------------------------------------------
+    void compact();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the marks are compacted when there are this many, it grows with what is left after compacting
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr size_t s_minCompact=4096;
+    size_t m_compactAt=s_minCompact;
+    size_t m_gap;
+    std::vector<Range> m_marks;
+    std::vector<Range> m_ranges;
+    size_t m_changedBytes=0;
+    size_t m_rangeBytes=0;
+    Stats m_stats;
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef FRAMECAPTURE_H_
+#define FRAMECAPTURE_H_
+#include <ngl/Types.h>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameCapture.h
+/// @brief reads rendered frames back through a ring of pixel buffer objects and saves them as images
+/// @class FrameCapture
+/// @brief capture starts a glReadPixels of the bound read framebuffer into the next PBO of the ring and
+/// puts a fence after it, so the copy happens on the GPU and glReadPixels returns straight away. A PBO
+/// is only mapped once the ring comes back round to it, with three PBOs frame k is mapped while frame
+/// k+2 is being drawn so by then its fence has normally signalled. The mapped pixels are copied into a
+/// ScratchPool block and encoded and written on the ThreadPool, the number of frames waiting to be
+/// encoded is capped so a slow disk holds the render loop back rather than filling memory. Needs GL 2.1
+/// for PBOs, without GL 3.2 or ARB_sync there are no fences and mapping the oldest PBO waits instead.
+//----------------------------------------------------------------------------------------------------------------------
+
+class FrameCapture
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counters of a capture
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      /// @brief frames read back and frames written to disk
+      unsigned int captured=0;
+      unsigned int written=0;
+      /// @brief images that could not be saved
+      unsigned int failed=0;
+      /// @brief times a PBO was needed before its fence had signalled, and the total time spent waiting
+      unsigned int readbackWaits=0;
+      double readbackWaitMs=0.0;
+      /// @brief times the render loop waited for the encoders to catch up
+      unsigned int encodeWaits=0;
+      /// @brief the total time the workers spent encoding and writing
+      double encodeMs=0.0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until the first capture
+    /// @param _width the width of the frames in pixels
+    /// @param _height the height of the frames in pixels
+    /// @param _pattern the file name of each frame, a single printf style %d (e.g. %04d) is replaced by the
+    /// frame number and the extension picks the format (png, jpg, bmp, ppm)
+    /// @param _numPBOs the PBOs in the ring, the number of frames read back at once
+    //----------------------------------------------------------------------------------------------------------------------
+    FrameCapture(int _width, int _height, const std::string &_pattern, unsigned int _numPBOs=3);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor waits for the encoders, the GL objects must have been released with finish
+    //----------------------------------------------------------------------------------------------------------------------
+    ~FrameCapture();
+    FrameCapture(const FrameCapture &)=delete;
+    FrameCapture & operator=(const FrameCapture &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start reading back the bound read framebuffer as frame _frame, call after it has been drawn
+    //----------------------------------------------------------------------------------------------------------------------
+    void capture(unsigned int _frame);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read back every frame still in a PBO, wait for them all to be written and delete the GL objects
+    /// @returns false if any image could not be written
+    //----------------------------------------------------------------------------------------------------------------------
+    bool finish();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a copy of the counters, safe while the workers are running
+    //----------------------------------------------------------------------------------------------------------------------
+    Stats stats() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief is the pattern usable, it may hold at most one %d with an optional zero padded width
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool isValidPattern(const std::string &_pattern);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the file name of a frame
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::string fileName(const std::string &_pattern, unsigned int _frame);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one PBO of the ring and the frame it holds
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Slot
+    {
+      GLuint pbo=0;
+      GLsync fence=nullptr;
+      unsigned int frame=0;
+      bool pending=false;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocate the PBOs, called by the first capture
+    //----------------------------------------------------------------------------------------------------------------------
+    void create();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief wait for a slot's fence, copy its pixels out and hand them to the encoders
+    //----------------------------------------------------------------------------------------------------------------------
+    void collect(Slot &io_slot);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief flip and write one frame, runs on a worker
+    //----------------------------------------------------------------------------------------------------------------------
+    void encode(const unsigned char *_pixels, unsigned int _frame);
+    int m_width;
+    int m_height;
+    std::string m_pattern;
+    std::vector<Slot> m_slots;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the slot the next capture uses
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_next=0;
+    bool m_hasSync=false;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the most frames waiting to be encoded before capture waits
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_maxEncoding;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief frames handed to the workers and not yet written, and the counters, protected by m_mutex
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_encoding=0;
+    Stats m_stats;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_encoded;
+};
+
+#endif
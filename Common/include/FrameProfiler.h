@@ -0,0 +1,148 @@
+#ifndef FRAMEPROFILER_H_
+#define FRAMEPROFILER_H_
+#include <ngl/Types.h>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameProfiler.h
+/// @brief CPU and GPU timing of the phases of a frame
+/// @class RollingHistogram
+/// @brief keeps the last N samples (in ms) and can bucket them into a histogram
+//----------------------------------------------------------------------------------------------------------------------
+
+class RollingHistogram
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _size the number of samples to keep
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit RollingHistogram(size_t _size=240);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add a sample, replacing the oldest once full
+    //----------------------------------------------------------------------------------------------------------------------
+    void add(double _ms);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of samples held
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t size() const {return m_full ? m_samples.size() : m_next;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the most recent sample
+    //----------------------------------------------------------------------------------------------------------------------
+    double last() const;
+    double mean() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the _p percentile (0-100) of the samples held
+    //----------------------------------------------------------------------------------------------------------------------
+    double percentile(double _p) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief count the samples into _bins buckets of _binWidth ms, the last bucket also holds anything larger
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> bucket(size_t _bins, double _binWidth) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the samples oldest first
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<double> samples() const;
+
+  private :
+    std::vector<double> m_samples;
+    size_t m_next=0;
+    bool m_full=false;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class FrameProfiler
+/// @brief wraps named phases of a frame in GL_TIME_ELAPSED queries and times the whole frame on the CPU.
+/// The queries are double buffered, results are read a frame later and only if GL_QUERY_RESULT_AVAILABLE
+/// says they are ready so reading never stalls the pipeline (a late result is dropped and counted).
+/// Query objects can't be nested so phases must not overlap.
+//----------------------------------------------------------------------------------------------------------------------
+class FrameProfiler
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _phases the names of the phases to time, the index is used in begin/endPhase
+    /// @param _history number of frames kept in the histograms
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit FrameProfiler(const std::vector<std::string> &_phases, size_t _history=240);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor will delete the query objects
+    //----------------------------------------------------------------------------------------------------------------------
+    ~FrameProfiler();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the query objects, needs a current GL context
+    //----------------------------------------------------------------------------------------------------------------------
+    void initialize();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start a frame, collects the GPU results of the previous use of this query set if ready
+    //----------------------------------------------------------------------------------------------------------------------
+    void beginFrame();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief end the frame and record the CPU time
+    //----------------------------------------------------------------------------------------------------------------------
+    void endFrame();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start / stop timing a phase
+    //----------------------------------------------------------------------------------------------------------------------
+    void beginPhase(size_t _phase);
+    void endPhase(size_t _phase);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the CPU time from beginFrame to endFrame
+    //----------------------------------------------------------------------------------------------------------------------
+    const RollingHistogram &cpuTimes() const {return m_cpu;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the GPU time of all phases added together
+    //----------------------------------------------------------------------------------------------------------------------
+    const RollingHistogram &gpuTimes() const {return m_gpu;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the GPU time of one phase
+    //----------------------------------------------------------------------------------------------------------------------
+    const RollingHistogram &phaseTimes(size_t _phase) const {return m_phaseTimes[_phase];}
+    const std::string &phaseName(size_t _phase) const {return m_phases[_phase];}
+    size_t numPhases() const {return m_phases.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of GPU results that weren't ready in time and were dropped
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int droppedResults() const {return m_dropped;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief lines of text for a HUD, summary and a text histogram
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<std::string> hudLines() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write the histograms and the raw samples as CSV
+    /// @param _fname the file to write
+    //----------------------------------------------------------------------------------------------------------------------
+    bool dump(const std::string &_fname) const;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of query sets, one being written while the other is read back
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr size_t s_querySets=2;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief histogram bucket size and count used for the HUD and dump
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr double s_binWidth=2.0;
+    static constexpr size_t s_bins=17;
+    std::vector<std::string> m_phases;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the query ids per set, one per phase
+    //----------------------------------------------------------------------------------------------------------------------
+    std::array<std::vector<GLuint>,s_querySets> m_queries;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief which phases were actually issued in each set
+    //----------------------------------------------------------------------------------------------------------------------
+    std::array<std::vector<bool>,s_querySets> m_issued;
+    size_t m_set=0;
+    bool m_initialized=false;
+    unsigned int m_dropped=0;
+    std::chrono::steady_clock::time_point m_frameStart;
+    RollingHistogram m_cpu;
+    RollingHistogram m_gpu;
+    std::vector<RollingHistogram> m_phaseTimes;
+};
+
+#endif
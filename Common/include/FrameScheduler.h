@@ -0,0 +1,114 @@
+#ifndef FRAMESCHEDULER_H_
+#define FRAMESCHEDULER_H_
+#include <QElapsedTimer>
+#include <QString>
+#include <QSurfaceFormat>
+#include <QTimer>
+#include <cstdint>
+class QOpenGLWindow;
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameScheduler.h
+/// @brief drives the render loop from QOpenGLWindow::frameSwapped rather than a 1ms timer
+/// @class FrameScheduler
+/// @brief when a frame has been swapped the next one is requested straight away (Unthrottled / VSync,
+/// the swap interval does the pacing) or after the remainder of the frame period (FixedRate). In
+/// Paused mode nothing is requested so the window only redraws when an event calls update(), an idle
+/// viewer then uses no CPU. tick() gives the measured time since the last frame so animation
+/// runs at the same speed whatever the frame rate. When a Trace is recording each frame from tick to
+/// frameSwapped is recorded as "frame", what it holds after paintGL is Qt's swap.
+//----------------------------------------------------------------------------------------------------------------------
+
+class FrameScheduler
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how frames are paced
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Mode{Unthrottled,VSync,FixedRate,Paused};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _window the window to schedule, frameSwapped is connected in start
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit FrameScheduler(QOpenGLWindow *_window);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the swap interval a mode needs, this must be done before the window is shown
+    /// @param io_format the format to modify
+    /// @param _mode the mode that will be used
+    //----------------------------------------------------------------------------------------------------------------------
+    static void configureFormat(QSurfaceFormat &io_format, Mode _mode);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief parse a mode from the command line, one of unthrottled, vsync, paused or a number for a fixed rate
+    /// @param _mode the string to parse
+    /// @param o_mode the mode parsed
+    /// @param o_fps the rate if a number was given
+    /// @returns false if _mode isn't a mode or a rate above 0, the outputs are left alone
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool parseMode(const QString &_mode, Mode &o_mode, double &o_fps);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the mode
+    /// @param _mode the pacing mode
+    /// @param _fps the target rate for FixedRate
+    //----------------------------------------------------------------------------------------------------------------------
+    void setMode(Mode _mode, double _fps=60.0);
+    Mode mode() const {return m_mode;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief toggle between Paused and the previous mode
+    //----------------------------------------------------------------------------------------------------------------------
+    void togglePause();
+    bool isPaused() const {return m_mode == Mode::Paused;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief connect to the window and request the first frame, call once the GL context exists
+    //----------------------------------------------------------------------------------------------------------------------
+    void start();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief call once per frame (at the start of paintGL)
+    /// @returns the seconds since the previous frame, 0 when paused and clamped so a stall doesn't jump the animation
+    //----------------------------------------------------------------------------------------------------------------------
+    double tick();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make tick return a fixed step rather than the measured time, used when frames are rendered
+    /// offline (see BatchRenderer) so the animation doesn't depend on how long each frame took
+    /// @param _seconds the step, 0 goes back to the measured time
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFixedStep(double _seconds){m_fixedStep=_seconds;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the name of a mode for printing
+    //----------------------------------------------------------------------------------------------------------------------
+    static const char *modeName(Mode _mode);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called when the window has swapped, requests the next frame for the current mode
+    //----------------------------------------------------------------------------------------------------------------------
+    void frameSwapped();
+    QOpenGLWindow *m_window;
+    Mode m_mode=Mode::VSync;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mode to go back to when un-pausing
+    //----------------------------------------------------------------------------------------------------------------------
+    Mode m_resumeMode=Mode::VSync;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief frame period in ns for FixedRate
+    //----------------------------------------------------------------------------------------------------------------------
+    qint64 m_period=16666667;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief single shot timer used to wait out the rest of the frame period
+    //----------------------------------------------------------------------------------------------------------------------
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief time of the last tick and the start of the last frame, in ns from m_clock
+    //----------------------------------------------------------------------------------------------------------------------
+    qint64 m_lastTick=-1;
+    qint64 m_frameStart=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the start of the last frame in Trace ticks
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t m_traceStart=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the step tick returns when it is greater than 0
+    //----------------------------------------------------------------------------------------------------------------------
+    double m_fixedStep=0.0;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef FRAMEUNIFORMS_H_
+#define FRAMEUNIFORMS_H_
+#include <ngl/Mat4.h>
+#include <ngl/Types.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameUniforms.h
+/// @brief the per frame camera data in one uniform buffer shared by every program
+/// @class FrameUniforms
+/// @brief the view, projection, MVP, viewport and time are written once a frame into a std140 uniform
+/// block and bound to BindingPoint, so each program reads them from the FrameData block rather than
+/// having them set by name. Any program that declares the block (blockSource) has it connected to the
+/// binding point once with attach. The buffer is split into regions written in turn, with GL 4.4 or
+/// ARB_buffer_storage it is persistently mapped and each region has a fence put after the frame that
+/// used it, like RingBufferVAO. Otherwise each region is written with glBufferSubData.
+//----------------------------------------------------------------------------------------------------------------------
+
+class FrameUniforms
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the uniform buffer binding point the block is read from
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr GLuint BindingPoint=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the block as it is laid out in the buffer (std140), must match blockSource
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Block
+    {
+      float view[16];
+      float projection[16];
+      float MVP[16];
+      float viewport[4];
+      float time;
+      float dt;
+      float pad[2];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until the first update
+    /// @param _regions the number of frames that can be in flight
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit FrameUniforms(unsigned int _regions=3);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor releases the buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    ~FrameUniforms();
+    FrameUniforms(const FrameUniforms &)=delete;
+    FrameUniforms & operator=(const FrameUniforms &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write this frame's block into the next region and bind it, call once a frame before drawing
+    /// @param _view the view matrix
+    /// @param _projection the projection matrix
+    /// @param _MVP the full model view projection
+    /// @param _width the viewport width in pixels
+    /// @param _height the viewport height in pixels
+    /// @param _time seconds since the start
+    /// @param _dt seconds since the last frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void update(const ngl::Mat4 &_view, const ngl::Mat4 &_projection, const ngl::Mat4 &_MVP, int _width, int _height,
+                float _time, float _dt);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fence the region written by update, call after the last draw of the frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void endFrame();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the buffer and fences
+    //----------------------------------------------------------------------------------------------------------------------
+    void release();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the last block written
+    //----------------------------------------------------------------------------------------------------------------------
+    const Block &block() const {return m_block;}
+    bool isPersistent() const {return m_mapped != nullptr;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of times update found its region still in use by the GPU, and of updates
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int fenceWaits() const {return m_fenceWaits;}
+    unsigned int writes() const {return m_writes;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the GLSL declaration of the block, put it after the #version line of any shader using it
+    //----------------------------------------------------------------------------------------------------------------------
+    static const char *blockSource();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a shader's source with the block declared after its #version line
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::string withBlock(const std::string &_source);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief connect a linked program's FrameData block to BindingPoint, programs without it are left alone
+    //----------------------------------------------------------------------------------------------------------------------
+    static void attach(GLuint _program);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocate the buffer, mapping it when the context supports immutable storage
+    //----------------------------------------------------------------------------------------------------------------------
+    void create();
+    unsigned int m_numRegions;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the size of each region, the block rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_regionSize=0;
+    GLuint m_buffer=0;
+    char *m_mapped=nullptr;
+    unsigned int m_region=0;
+    std::vector<GLsync> m_fences;
+    Block m_block;
+    unsigned int m_fenceWaits=0;
+    unsigned int m_writes=0;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Frustum.h
+/// @brief the six clip planes of a view frustum for culling boxes on the CPU
+/// @class Frustum
+/// @brief the planes are taken straight from a model view projection matrix (Gribb / Hartmann) so they
+/// are in the model's space and boxes can be tested without transforming them first
+//----------------------------------------------------------------------------------------------------------------------
+
+class Frustum
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _mvp the full model view projection matrix used to draw
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit Frustum(const ngl::Mat4 &_mvp);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief is any part of an axis aligned box inside the frustum, this is conservative so a box
+    /// near a corner of the frustum may pass when it is just outside
+    /// @param _min the minimum corner of the box
+    /// @param _max the maximum corner of the box
+    //----------------------------------------------------------------------------------------------------------------------
+    bool intersects(const ngl::Vec3 &_min, const ngl::Vec3 &_max) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the clip space w of a point, for a perspective projection this is its distance along the view direction
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Real depth(const ngl::Vec3 &_p) const;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a b c d for each plane, a point is inside when a*x+b*y+c*z+d >= 0 for all of them
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Real m_planes[6][4];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the w row of the matrix
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Real m_w[4];
+};
+
+#endif
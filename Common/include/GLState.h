@@ -0,0 +1,142 @@
+#ifndef GLSTATE_H_
+#define GLSTATE_H_
+#include <ngl/AbstractVAO.h>
+#include <ngl/Types.h>
+#include <cstddef>
+#include <ostream>
+#include <string>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLState.h
+/// @brief a thin layer over the binds, draws and uploads made each frame which counts them and skips redundant binds
+/// @class GLState
+/// @brief remembers the bound VAO, GL_ARRAY_BUFFER and program so binding what is already bound is skipped, and
+/// unbindVertexArray doesn't bind 0 but leaves the VAO for the next bind to replace, so drawing the same VAO in
+/// several views or a program used twice a frame costs one bind. Every draw, bind actually made, skipped bind
+/// and upload is counted, beginFrame starts a new set of counters and keeps the last frame's for the HUD and
+/// dump. Anything binding behind our back (ngl::Text, ngl::ShaderLib, an ngl VAO being removed, Qt) must be
+/// followed by invalidate so the next bind is made for real, beginFrame does this too. Deleting through us
+/// keeps the cache right when GL reuses the names. Each thread has its own as each context here is only
+/// current on one thread.
+//----------------------------------------------------------------------------------------------------------------------
+
+class GLState
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what was done in a frame
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Counters
+    {
+      unsigned int drawCalls=0;
+      size_t vertices=0;
+      /// @brief binds passed on to GL
+      unsigned int vaoBinds=0;
+      unsigned int bufferBinds=0;
+      unsigned int programBinds=0;
+      /// @brief binds, unbinds and program changes that were skipped as they changed nothing
+      unsigned int skipped=0;
+      /// @brief writes of vertex data through glBufferData / glBufferSubData or a mapping
+      unsigned int uploads=0;
+      size_t uploadBytes=0;
+      Counters & operator+=(const Counters &_other);
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the state of the calling thread's context
+    //----------------------------------------------------------------------------------------------------------------------
+    static GLState *instance();
+    GLState(const GLState &)=delete;
+    GLState & operator=(const GLState &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind a VAO unless it is already bound
+    //----------------------------------------------------------------------------------------------------------------------
+    void bindVertexArray(GLuint _vao);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind an ngl VAO with its own bind so its bound flag is kept, unless it is already bound
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind(ngl::AbstractVAO &_vao);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finished with the VAO, nothing is issued as whatever is drawn next binds its own
+    //----------------------------------------------------------------------------------------------------------------------
+    void unbindVertexArray();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind a buffer, GL_ARRAY_BUFFER is skipped when already bound and other targets are just counted
+    //----------------------------------------------------------------------------------------------------------------------
+    void bindBuffer(GLenum _target, GLuint _buffer);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make a program current unless it already is
+    //----------------------------------------------------------------------------------------------------------------------
+    void useProgram(GLuint _program);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief record a program made current elsewhere, e.g. by ngl::ShaderLib::use
+    //----------------------------------------------------------------------------------------------------------------------
+    void programUsed(GLuint _program);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete VAOs / buffers, a deleted object that was bound is no longer bound
+    //----------------------------------------------------------------------------------------------------------------------
+    void deleteVertexArrays(GLsizei _count, const GLuint *_vaos);
+    void deleteBuffers(GLsizei _count, const GLuint *_buffers);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief remove an ngl VAO, its unbind binds 0 behind our back so the VAO binding is forgotten
+    //----------------------------------------------------------------------------------------------------------------------
+    void remove(ngl::AbstractVAO &_vao);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief glDrawArrays with the draw counted
+    //----------------------------------------------------------------------------------------------------------------------
+    void drawArrays(GLenum _mode, GLint _first, GLsizei _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief glMultiDrawArrays counted as one draw call
+    //----------------------------------------------------------------------------------------------------------------------
+    void multiDrawArrays(GLenum _mode, const GLint *_firsts, const GLsizei *_counts, GLsizei _drawCount);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief count a draw made elsewhere, e.g. by an ngl VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    void countDraw(size_t _vertices);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief glBufferData / glBufferSubData with the bytes counted, data of nullptr only allocates so isn't an upload
+    //----------------------------------------------------------------------------------------------------------------------
+    void bufferData(GLenum _target, size_t _bytes, const void *_data, GLenum _usage);
+    void bufferSubData(GLenum _target, size_t _offset, size_t _bytes, const void *_data);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief count data written some other way, e.g. through a mapping
+    //----------------------------------------------------------------------------------------------------------------------
+    void countUpload(size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief forget what is bound so the next binds are made for real, call after code that binds behind our back
+    //----------------------------------------------------------------------------------------------------------------------
+    void invalidate();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start a frame's counters, the finished frame's become lastFrame, and invalidate as Qt may have bound things
+    //----------------------------------------------------------------------------------------------------------------------
+    void beginFrame();
+    const Counters &frame() const {return m_frame;}
+    const Counters &lastFrame() const {return m_lastFrame;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief every frame before the current one
+    //----------------------------------------------------------------------------------------------------------------------
+    const Counters &total() const {return m_total;}
+    unsigned int frames() const {return m_frames;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the last frame's counters as a line for the HUD
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string hudLine() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief print the last frame's counters, the mean per frame and what is bound
+    //----------------------------------------------------------------------------------------------------------------------
+    void dump(std::ostream &_log) const;
+
+  private :
+    GLState()=default;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cached bindings, s_unknown until something is bound through us
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr GLuint s_unknown=~0u;
+    GLuint m_vao=s_unknown;
+    GLuint m_arrayBuffer=s_unknown;
+    GLuint m_program=s_unknown;
+    Counters m_frame;
+    Counters m_lastFrame;
+    Counters m_total;
+    unsigned int m_frames=0;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef MORTON_H_
+#define MORTON_H_
+#include <cstdint>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Morton.h
+/// @brief 3D Morton (Z order) codes, the bits of x y z are interleaved so cells that are close in
+/// space are mostly close in the code. Sorting by code gives spatially coherent runs and every
+/// octree node covers one contiguous range of codes. Up to 21 bits per axis fit in 64 bits.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace morton
+{
+  /// @brief the most bits per axis
+  constexpr unsigned int MaxBits=21;
+
+  /// @brief spread the low 21 bits of _v so there are two zero bits between each
+  inline uint64_t spread(uint64_t _v)
+  {
+    _v&=0x1fffff;
+    _v=(_v | (_v << 32)) & 0x1f00000000ffffull;
+    _v=(_v | (_v << 16)) & 0x1f0000ff0000ffull;
+    _v=(_v | (_v << 8)) & 0x100f00f00f00f00full;
+    _v=(_v | (_v << 4)) & 0x10c30c30c30c30c3ull;
+    _v=(_v | (_v << 2)) & 0x1249249249249249ull;
+    return _v;
+  }
+
+  /// @brief the inverse of spread, takes every third bit
+  inline uint32_t compact(uint64_t _v)
+  {
+    _v&=0x1249249249249249ull;
+    _v=(_v | (_v >> 2)) & 0x10c30c30c30c30c3ull;
+    _v=(_v | (_v >> 4)) & 0x100f00f00f00f00full;
+    _v=(_v | (_v >> 8)) & 0x1f0000ff0000ffull;
+    _v=(_v | (_v >> 16)) & 0x1f00000000ffffull;
+    _v=(_v | (_v >> 32)) & 0x1fffffull;
+    return static_cast<uint32_t>(_v);
+  }
+
+  /// @brief the code of a cell, x is the lowest bit of each triple
+  inline uint64_t encode(uint32_t _x, uint32_t _y, uint32_t _z)
+  {
+    return spread(_x) | (spread(_y) << 1) | (spread(_z) << 2);
+  }
+
+  /// @brief the cell of a code
+  inline void decode(uint64_t _code, uint32_t &o_x, uint32_t &o_y, uint32_t &o_z)
+  {
+    o_x=compact(_code);
+    o_y=compact(_code >> 1);
+    o_z=compact(_code >> 2);
+  }
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef MORTONSORT_H_
+#define MORTONSORT_H_
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MortonSort.h
+/// @brief puts points in Morton (Z curve) order so neighbouring vertices are close on screen
+/// @class MortonSort
+/// @brief sort quantises each point to a 2^10 (30 bit codes) or 2^21 (63 bit codes) grid over the bounds
+/// of the points and sorts the codes with a parallel LSD radix sort, 8 bits a pass. Each pass every
+/// thread counts the digits of its own block, the counts are summed in digit then block order and each
+/// block scatters its points to their slots, so the sort is stable. Passes where every code has the
+/// same digit are skipped. The sort only makes the order, gather / reorder then apply it to the positions
+/// and any other attributes so they all stay together. ranges splits the sorted points by the top bits of
+/// their codes, each range is one cell of a 2^(prefixBits/3) grid so can be used as a chunk.
+//----------------------------------------------------------------------------------------------------------------------
+
+class MortonSort
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the length of the codes
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Precision{Bits30,Bits63};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a run of sorted points sharing the top bits of their codes
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Range
+    {
+      uint64_t prefix;
+      size_t first;
+      size_t count;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _precision the length of the codes
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit MortonSort(Precision _precision=Precision::Bits30);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief work out the Morton order of a set of points, the points themselves aren't moved
+    /// @param _xyz packed x y z floats
+    /// @param _count the number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void sort(const float *_xyz, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy one value per point into Morton order, o_out[i]=_in[order()[i]]
+    /// @param _in the values in their original order
+    /// @param o_out where to write them, must not overlap _in
+    /// @param _stride the bytes of each point's value
+    //----------------------------------------------------------------------------------------------------------------------
+    void gather(const void *_in, void *o_out, size_t _stride) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief put a per point array into Morton order in place
+    //----------------------------------------------------------------------------------------------------------------------
+    template <typename T> void reorder(std::vector<T> &io_values) const
+    {
+      std::vector<T> sorted(io_values.size());
+      gather(io_values.data(),sorted.data(),sizeof(T));
+      io_values.swap(sorted);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the sorted point i was point order()[i]
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<uint32_t> &order() const {return m_order;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the codes in sorted order
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<uint64_t> &codes() const {return m_codes;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief split the sorted points by the top bits of their codes
+    /// @param _prefixBits the bits to group by, a multiple of 3 gives cubic cells
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<Range> ranges(unsigned int _prefixBits) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bits per axis and in each code
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int axisBits() const {return m_axisBits;}
+    unsigned int codeBits() const {return m_axisBits*3;}
+    size_t size() const {return m_order.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the time the last sort took and how many radix passes it needed
+    //----------------------------------------------------------------------------------------------------------------------
+    double sortMs() const {return m_sortMs;}
+    unsigned int passes() const {return m_passes;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief time sorting and gathering _count points at both precisions and print the throughput
+    /// @param _count the number of points
+    /// @param _iterations timed runs, the best is reported
+    /// @param _log where to write the results
+    //----------------------------------------------------------------------------------------------------------------------
+    static void benchmark(size_t _count, unsigned int _iterations, std::ostream &_log);
+
+  private :
+    unsigned int m_axisBits;
+    std::vector<uint64_t> m_codes;
+    std::vector<uint32_t> m_order;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the other half of the ping pong for each radix pass
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<uint64_t> m_codesScratch;
+    std::vector<uint32_t> m_orderScratch;
+    double m_sortMs=0.0;
+    unsigned int m_passes=0;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef OCTREEFILE_H_
+#define OCTREEFILE_H_
+#include <ngl/Vec3.h>
+#include <QFile>
+#include <cstdint>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OctreeFile.h
+/// @brief the on disk layout of a point cloud octree written by the OctreeBuilder tool
+/// @class OctreeFile
+/// @brief the file is an OctreeHeader, the point data of every node as packed float xyz and then a
+/// table of OctreeNode. Each node holds a random subsample of the points below it which are not in
+/// any of its ancestors, so drawing a node and its ancestors gives an even sample of its region
+/// and drawing every node draws every point exactly once. The file is memory mapped so points()
+/// can be read from any thread, only the pages of nodes actually drawn are read from disk.
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the start of the file
+//----------------------------------------------------------------------------------------------------------------------
+struct OctreeHeader
+{
+  char magic[8]={'N','G','L','O','C','T','R','E'};
+  uint32_t version=1;
+  uint32_t numNodes=0;
+  uint64_t numPoints=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the root cube
+  //----------------------------------------------------------------------------------------------------------------------
+  float min[3]={0.0f,0.0f,0.0f};
+  float size=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief byte offset of the OctreeNode table
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t nodeTableOffset=0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one node of the tree, node 0 is the root
+//----------------------------------------------------------------------------------------------------------------------
+struct OctreeNode
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the node's cube
+  //----------------------------------------------------------------------------------------------------------------------
+  float min[3]={0.0f,0.0f,0.0f};
+  float size=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief byte offset and count of this node's own points
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t offset=0;
+  uint32_t numPoints=0;
+  uint32_t level=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief index of each child octant, -1 where there is no child
+  //----------------------------------------------------------------------------------------------------------------------
+  int32_t children[8]={-1,-1,-1,-1,-1,-1,-1,-1};
+};
+
+class OctreeFile
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read the header and node table and map the file
+    /// @param _fname the file written by OctreeBuilder
+    /// @returns false with a message on std::cerr if the file can't be used
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief unmap and close the file
+    //----------------------------------------------------------------------------------------------------------------------
+    void close();
+    ~OctreeFile();
+    const OctreeHeader &header() const {return m_header;}
+    const std::vector<OctreeNode> &nodes() const {return m_nodes;}
+    const OctreeNode &node(size_t _index) const {return m_nodes[_index];}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a node's points as packed float xyz, this points into the mapping so the first access
+    /// reads the data from disk. Safe to call from any thread while the file is open.
+    //----------------------------------------------------------------------------------------------------------------------
+    const float *points(size_t _index) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the root cube
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Vec3 minBounds() const;
+    ngl::Vec3 maxBounds() const;
+
+  private :
+    QFile m_file;
+    OctreeHeader m_header;
+    std::vector<OctreeNode> m_nodes;
+    const unsigned char *m_data=nullptr;
+};
+
+#endif
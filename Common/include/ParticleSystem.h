@@ -0,0 +1,144 @@
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+#include <ngl/Types.h>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ParticleSystem.h
+/// @brief particles moved on the GPU with transform feedback
+/// @class ParticleSystem
+/// @brief each particle is a position and velocity (24 bytes) in one of two buffers. step runs the update
+/// shader over the current buffer with the rasteriser off and captures the new particles into the other
+/// buffer, then the two swap, so after init the particles never go back through the CPU. The update
+/// integrates a force (gravity and a spring to an attractor by default, or any GLSL given to the ctor)
+/// with semi implicit Euler, damps the velocity and bounces the particles off the walls of a box.
+/// validate reads a few particles back, runs them through a CPU copy of the default update and compares.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ParticleSystem
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the uniforms of the update shader
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Parameters
+    {
+      float gravity[3]={0.0f,-2.0f,0.0f};
+      float attractor[3]={0.0f,0.0f,0.0f};
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief spring constant pulling particles to the attractor
+      //----------------------------------------------------------------------------------------------------------------------
+      float attraction=3.0f;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the velocity is divided by 1+damping*dt each step
+      //----------------------------------------------------------------------------------------------------------------------
+      float damping=0.1f;
+      float boundsMin[3]={-5.0f,-5.0f,-5.0f};
+      float boundsMax[3]={5.0f,5.0f,5.0f};
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the fraction of the speed kept when bouncing off a wall
+      //----------------------------------------------------------------------------------------------------------------------
+      float restitution=0.7f;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one particle as it is stored in the buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Particle
+    {
+      float position[3];
+      float velocity[3];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until init
+    /// @param _forceSource GLSL defining vec3 force(vec3 _position, vec3 _velocity) to replace the default
+    /// gravity and attractor, the Parameters uniforms are still available to it. validate can only check the default.
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit ParticleSystem(const std::string &_forceSource="");
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor releases the GL objects
+    //----------------------------------------------------------------------------------------------------------------------
+    ~ParticleSystem();
+    ParticleSystem(const ParticleSystem &)=delete;
+    ParticleSystem & operator=(const ParticleSystem &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the buffers and fill them with random particles, a GL context must be current
+    /// @param _count the number of particles
+    /// @param _seed the PointGenerator seed for the positions and velocities
+    //----------------------------------------------------------------------------------------------------------------------
+    void init(size_t _count, uint64_t _seed);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advance every particle by _dt seconds on the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    void step(float _dt);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind the VAO of the current buffer, position is attribute 0 so the particles can be drawn
+    /// with any shader that draws points
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind() const;
+    void unbind() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw all of the particles with the current shader
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the GL objects
+    //----------------------------------------------------------------------------------------------------------------------
+    void release();
+    void setParameters(const Parameters &_parameters){m_parameters=_parameters;}
+    const Parameters &parameters() const {return m_parameters;}
+    size_t size() const {return m_count;}
+    size_t bytes() const {return 2*m_count*sizeof(Particle);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffer holding the latest particles, packed Particle structs
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint buffer() const {return m_buffers[m_current];}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of steps run since init
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t steps() const {return m_steps;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read _samples particles spread through the buffer back, run _steps GPU steps and the same steps
+    /// on the CPU and compare, a GL context must be current. The simulation is left _steps further on.
+    /// @param _steps the number of steps to compare
+    /// @param _dt the time step
+    /// @param _samples how many particles to read back
+    /// @param _log where to write the results
+    /// @returns true if every sample is within tolerance of the CPU result
+    //----------------------------------------------------------------------------------------------------------------------
+    bool validate(unsigned int _steps, float _dt, size_t _samples, std::ostream &_log);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the CPU reference of the default update shader
+    //----------------------------------------------------------------------------------------------------------------------
+    static void integrate(Particle &io_particle, const Parameters &_parameters, float _dt);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the update program for this context from the ProgramCache and look up its uniforms
+    //----------------------------------------------------------------------------------------------------------------------
+    void createShader();
+    std::string m_forceSource;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the program's name, one per force source, and its id in the current context
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_program;
+    GLuint m_programId=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the uniforms set each step, found once when the program is fetched
+    //----------------------------------------------------------------------------------------------------------------------
+    enum Uniform : size_t {Dt,Gravity,Attractor,Attraction,Damping,BoundsMin,BoundsMax,Restitution,NumUniforms};
+    GLint m_locations[NumUniforms];
+    Parameters m_parameters;
+    size_t m_count=0;
+    size_t m_steps=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the two particle buffers and a VAO reading each, m_current holds the latest particles
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_buffers[2]={0,0};
+    GLuint m_vaos[2]={0,0};
+    unsigned int m_current=0;
+};
+
+#endif
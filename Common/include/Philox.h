@@ -0,0 +1,72 @@
+#ifndef PHILOX_H_
+#define PHILOX_H_
+#include <cstdint>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Philox.h
+/// @brief the Philox4x32-10 counter based random number generator (Salmon et al. "Parallel Random
+/// Numbers: As Easy as 1, 2, 3"). The output is a pure function of a 128 bit counter and a 64 bit key
+/// so any element of a sequence can be generated independently, which is what lets us split the
+/// work across threads and still get bit identical results for a given seed.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace philox
+{
+  /// @brief multipliers and key increments from the paper
+  constexpr uint32_t M0=0xD2511F53u;
+  constexpr uint32_t M1=0xCD9E8D57u;
+  constexpr uint32_t W0=0x9E3779B9u;
+  constexpr uint32_t W1=0xBB67AE85u;
+  constexpr int Rounds=10;
+
+  /// @brief four 32 bit words, used for both the counter and the result
+  struct Block
+  {
+    uint32_t v[4];
+  };
+
+  /// @brief 32x32 -> 64 bit multiply split into high and low words
+  inline void mulhilo(uint32_t _a, uint32_t _b, uint32_t &o_hi, uint32_t &o_lo)
+  {
+    uint64_t p=static_cast<uint64_t>(_a)*_b;
+    o_hi=static_cast<uint32_t>(p>>32);
+    o_lo=static_cast<uint32_t>(p);
+  }
+
+  /// @brief generate one block of 4 random words
+  /// @param _counter the 128 bit counter
+  /// @param _seed the 64 bit key
+  inline Block generate(Block _counter, uint64_t _seed)
+  {
+    uint32_t k0=static_cast<uint32_t>(_seed);
+    uint32_t k1=static_cast<uint32_t>(_seed>>32);
+    Block c=_counter;
+    for(int r=0; r<Rounds; ++r)
+    {
+      uint32_t hi0,lo0,hi1,lo1;
+      mulhilo(M0,c.v[0],hi0,lo0);
+      mulhilo(M1,c.v[2],hi1,lo1);
+      c={{hi1^c.v[1]^k0,lo1,hi0^c.v[3]^k1,lo0}};
+      k0+=W0;
+      k1+=W1;
+    }
+    return c;
+  }
+
+  /// @brief convenience for the common case of a 64 bit index and a stream id
+  /// @param _index the element index
+  /// @param _stream allows several independent sequences for the same seed
+  /// @param _seed the 64 bit key
+  inline Block generate(uint64_t _index, uint32_t _stream, uint64_t _seed)
+  {
+    Block counter={{static_cast<uint32_t>(_index),static_cast<uint32_t>(_index>>32),_stream,0}};
+    return generate(counter,_seed);
+  }
+
+  /// @brief map a random word to a float in [0,1) using the top 24 bits, this is exact
+  inline float toUnitFloat(uint32_t _v)
+  {
+    return static_cast<float>(_v>>8)*(1.0f/16777216.0f);
+  }
+}
+
+#endif
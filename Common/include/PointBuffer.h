@@ -0,0 +1,164 @@
+#ifndef POINTBUFFER_H_
+#define POINTBUFFER_H_
+#include <ngl/Types.h>
+#include "DirtyRanges.h"
+#include "ScratchPool.h"
+#include "Trace.h"
+#include <cstddef>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PointBuffer.h
+/// @brief a GL buffer with a separate size and capacity, like std::vector
+/// @class PointBuffer
+/// @brief changing the number of points doesn't re-allocate every time. The capacity grows
+/// geometrically, when it does a new buffer is made and the used part of the old one copied
+/// across with glCopyBufferSubData, after that data is written with glBufferSubData. Shrinking
+/// only lowers the size, the memory is kept until shrinkToFit is called.
+/// When the capacity changes the buffer id changes so any VAO using it needs its attribute
+/// pointers set again, reserve / resize return true when this happens.
+/// write lets points be made straight into the buffer through glMapBufferRange instead of into a
+/// temporary array that glBufferSubData then copies. Rewriting the whole buffer invalidates it so the
+/// driver can hand back fresh memory rather than wait for the GPU, a range past anything drawn since the
+/// buffer was allocated is mapped unsynchronized. If the map fails the points are made in a ScratchPool
+/// block and uploaded. flush writes just the ranges of a CPU copy marked in a DirtyRanges, for data where a few
+/// scattered points change at a time.
+//----------------------------------------------------------------------------------------------------------------------
+
+class PointBuffer
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until the buffer is first sized
+    /// @param _usage the usage hint passed to glBufferData
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit PointBuffer(GLenum _usage=GL_DYNAMIC_DRAW) : m_usage(_usage){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor deletes the buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    ~PointBuffer();
+    PointBuffer(const PointBuffer &)=delete;
+    PointBuffer & operator=(const PointBuffer &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make sure the buffer can hold _bytes without re-allocating
+    /// @returns true if the buffer was re-allocated (the id has changed)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool reserve(size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the number of bytes in use, grows the capacity if needed but never shrinks it
+    /// @returns true if the buffer was re-allocated (the id has changed)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool resize(size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief release the unused capacity
+    /// @returns true if the buffer was re-allocated (the id has changed)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool shrinkToFit();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write data into the used part of the buffer with glBufferSubData
+    /// @param _offset byte offset to write at
+    /// @param _bytes the number of bytes to write
+    /// @param _data the data
+    //----------------------------------------------------------------------------------------------------------------------
+    void upload(size_t _offset, size_t _bytes, const void *_data);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fill part of the used buffer in place
+    /// @param _offset byte offset to write at
+    /// @param _bytes the number of bytes to write
+    /// @param _fill called as _fill(void *) with where to write the _bytes, it may be called twice if the
+    /// mapped data is lost on unmap
+    /// @returns true if the data was written through a mapping, false if the scratch fallback was used
+    //----------------------------------------------------------------------------------------------------------------------
+    template <typename F> bool write(size_t _offset, size_t _bytes, const F &_fill)
+    {
+      if(_bytes == 0)
+      {
+        return true;
+      }
+      TRACE_SCOPE("PointBuffer::write");
+      void *mapped=map(_offset,_bytes);
+      if(mapped != nullptr)
+      {
+        _fill(mapped);
+        if(unmap())
+        {
+          return true;
+        }
+      }
+      ++m_fallbacks;
+      ScratchPool::Block scratch=ScratchPool::instance()->acquire(_bytes);
+      _fill(scratch.data());
+      upload(_offset,_bytes,scratch.data());
+      return false;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief upload the ranges marked in _dirty from a copy of the whole buffer and clear the marks. With _mapped
+    /// the span from the first to the last range is mapped once with GL_MAP_FLUSH_EXPLICIT_BIT and each range
+    /// copied and flushed, otherwise each range is a glBufferSubData. The ranges must be inside size.
+    /// @param _dirty the changed ranges, coalesced here with its gap
+    /// @param _source the CPU copy, the bytes at each range's offset are written
+    /// @param _mapped write through a mapping rather than glBufferSubData
+    /// @returns true if the ranges were written through a mapping
+    //----------------------------------------------------------------------------------------------------------------------
+    bool flush(DirtyRanges &_dirty, const void *_source, bool _mapped=false);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map part of the used buffer for writing, the old contents of the range are discarded
+    /// @returns the mapped range or nullptr if it couldn't be mapped, must be followed by unmap
+    //----------------------------------------------------------------------------------------------------------------------
+    void *map(size_t _offset, size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief unmap the buffer
+    /// @returns false if the driver lost the data written (GL_FALSE from glUnmapBuffer) so it must be written again
+    //----------------------------------------------------------------------------------------------------------------------
+    bool unmap();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    void release();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffer id, 0 until the buffer is first sized
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint id() const {return m_id;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes in use
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t size() const {return m_size;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes allocated on the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t capacity() const {return m_capacity;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocated but unused bytes
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t wastedBytes() const {return m_capacity-m_size;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of times the buffer has been re-allocated
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int reallocations() const {return m_reallocations;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of writes made through a mapping and the number that fell back to a scratch upload
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int maps() const {return m_maps;}
+    unsigned int fallbacks() const {return m_fallbacks;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make a new buffer of _capacity bytes and copy the used part of the old one into it
+    //----------------------------------------------------------------------------------------------------------------------
+    void reallocate(size_t _capacity);
+    GLenum m_usage;
+    GLuint m_id=0;
+    size_t m_size=0;
+    size_t m_capacity=0;
+    unsigned int m_reallocations=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the most bytes in use since the buffer was allocated, the GPU may be reading anything below it
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_highWater=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ranges starting here have never been drawn so can be mapped unsynchronized
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_unsyncFrom=0;
+    unsigned int m_maps=0;
+    unsigned int m_fallbacks=0;
+};
+
+#endif
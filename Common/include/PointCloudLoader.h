@@ -0,0 +1,138 @@
+#ifndef POINTCLOUDLOADER_H_
+#define POINTCLOUDLOADER_H_
+#include <ngl/Vec3.h>
+#include <QElapsedTimer>
+#include <QFile>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PointCloudLoader.h
+/// @brief streams point clouds from disk into a GPU buffer a chunk at a time
+/// @class PointCloudLoader
+/// @brief reads raw float32 xyz files (.xyz / .raw, just x y z repeated) and binary PLY files.
+/// open only parses the header, the data is then memory mapped one chunk at a time in loadChunks and
+/// handed to an upload function, so there is never a full copy of the file in memory and the caller
+/// can draw the points loaded so far between chunks. When the vertex data is already packed float xyz
+/// the upload reads straight from the mapping, otherwise the chunk is converted into a chunk sized
+/// scratch array first.
+//----------------------------------------------------------------------------------------------------------------------
+
+class PointCloudLoader
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the file formats understood
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Format{Unknown,RawXYZ,BinaryPLY};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called with each chunk of packed float xyz data
+    /// @param _offset byte offset of the chunk in the packed point data
+    /// @param _bytes size of the chunk in bytes
+    /// @param _xyz the points, only valid during the call
+    //----------------------------------------------------------------------------------------------------------------------
+    using UploadFunction=std::function<void(size_t _offset, size_t _bytes, const float *_xyz)>;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _chunkPoints the number of points mapped and uploaded at a time
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit PointCloudLoader(size_t _chunkPoints=1<<20);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief open a file and read its header, no point data is read until loadChunks
+    /// @param _fname the file to open, PLY files are detected from their header anything else is raw xyz
+    /// @returns false with a message on std::cerr if the file can't be used
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief close the file, the bounds and counts are kept
+    //----------------------------------------------------------------------------------------------------------------------
+    void close();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map and upload chunks until all the points are loaded or _budgetMs has passed, at least
+    /// one chunk is always loaded so a small budget still makes progress
+    /// @param _budgetMs how long to spend, 0 or less loads everything
+    /// @param _upload where to send the chunks
+    /// @returns the number of points loaded by this call
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t loadChunks(double _budgetMs, const UploadFunction &_upload);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the total number of points in the file, use this to size the GPU buffer once up front
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t numPoints() const {return m_numPoints;}
+    size_t loadedPoints() const {return m_loaded;}
+    bool isOpen() const {return m_file.isOpen();}
+    bool done() const {return m_loaded == m_numPoints;}
+    Format format() const {return m_format;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bounds of the points loaded so far
+    //----------------------------------------------------------------------------------------------------------------------
+    const ngl::Vec3 &minBounds() const {return m_min;}
+    const ngl::Vec3 &maxBounds() const {return m_max;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes of the file read so far and the load rate in MB/s, the time between chunks
+    /// (while the caller draws) isn't counted so this is the rate the loader itself achieves
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t bytesRead() const {return m_bytesRead;}
+    double throughput() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write points as a raw float32 xyz file
+    /// @param _fname the file to write
+    /// @param _xyz packed x y z floats
+    /// @param _count the number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool writeRaw(const std::string &_fname, const float *_xyz, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write points as a binary little endian PLY file
+    /// @param _fname the file to write
+    /// @param _xyz packed x y z floats
+    /// @param _count the number of points
+    /// @param _withColour add a uchar red green blue per point so the file isn't packed xyz, this is
+    /// mainly to test the converting path of the loader
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool writePLY(const std::string &_fname, const float *_xyz, size_t _count, bool _withColour=false);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief parse a PLY header and find where x y z are in each vertex
+    //----------------------------------------------------------------------------------------------------------------------
+    bool readPLYHeader();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map, convert if needed and upload _count points starting at _first
+    //----------------------------------------------------------------------------------------------------------------------
+    bool loadChunk(size_t _first, size_t _count, const UploadFunction &_upload);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy x y z out of _count vertices into m_scratch
+    //----------------------------------------------------------------------------------------------------------------------
+    void convert(const unsigned char *_vertices, size_t _count);
+    void growBounds(const float *_xyz, size_t _count);
+    QFile m_file;
+    Format m_format=Format::Unknown;
+    size_t m_chunkPoints;
+    size_t m_numPoints=0;
+    size_t m_loaded=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where the vertex data starts in the file and the size of one vertex
+    //----------------------------------------------------------------------------------------------------------------------
+    qint64 m_dataOffset=0;
+    size_t m_stride=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief byte offset of x y z in a vertex, whether they are doubles and whether the file is
+    /// big endian, m_packed is set when the vertices are just three little endian floats
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_offsets[3]={0,4,8};
+    bool m_double=false;
+    bool m_bigEndian=false;
+    bool m_packed=true;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one chunk of converted points when the file isn't packed xyz
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<float> m_scratch;
+    ngl::Vec3 m_min;
+    ngl::Vec3 m_max;
+    size_t m_bytesRead=0;
+    qint64 m_loadNs=0;
+    QElapsedTimer m_sinceOpen;
+};
+
+#endif
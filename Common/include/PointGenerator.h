@@ -0,0 +1,77 @@
+#ifndef POINTGENERATOR_H_
+#define POINTGENERATOR_H_
+#include <cstddef>
+#include <cstdint>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PointGenerator.h
+/// @brief fills an array of xyz floats (the same layout as ngl::Vec3) with random points
+/// @class PointGenerator
+/// @brief replaces the serial ngl::Random::getRandomPoint loop. Point i is generated from the Philox
+/// counter based RNG using i as the counter and the seed as the key, so the range can be split across
+/// the ThreadPool and the result is bit identical for a seed no matter how many threads are used.
+/// On x86 there are SSE4.1 and AVX2 kernels which generate 4 / 8 points at once and write the x,y,z
+/// straight into the destination, the scalar kernel is the reference they are checked against.
+//----------------------------------------------------------------------------------------------------------------------
+
+class PointGenerator
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the kernels we can generate with, Auto picks the best one the CPU supports
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Kernel{Auto,Scalar,SSE41,AVX2};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _seed the seed for the sequence
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit PointGenerator(uint64_t _seed=0x5eed);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the seed, a new seed gives a completely new set of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSeed(uint64_t _seed){m_seed=_seed;}
+    uint64_t seed() const {return m_seed;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the half size of the box points are generated in, the same as getRandomPoint(x,y,z)
+    //----------------------------------------------------------------------------------------------------------------------
+    void setExtents(float _x, float _y, float _z);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate points in parallel using the ThreadPool
+    /// @param o_xyz where to write, must hold 3*_count floats
+    /// @param _count the number of points
+    /// @param _firstIndex the index of the first point in the sequence, lets a range be re-generated
+    /// @param _kernel the kernel to use
+    //----------------------------------------------------------------------------------------------------------------------
+    void generate(float *o_xyz, size_t _count, uint64_t _firstIndex=0, Kernel _kernel=Kernel::Auto) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate points on the calling thread only
+    //----------------------------------------------------------------------------------------------------------------------
+    void generateSerial(float *o_xyz, size_t _count, uint64_t _firstIndex=0, Kernel _kernel=Kernel::Auto) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the fastest kernel the CPU supports
+    //----------------------------------------------------------------------------------------------------------------------
+    static Kernel bestKernel();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief can this CPU run _kernel
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool isSupported(Kernel _kernel);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the name of a kernel for printing
+    //----------------------------------------------------------------------------------------------------------------------
+    static const char *kernelName(Kernel _kernel);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief resolve Auto into an actual kernel
+    //----------------------------------------------------------------------------------------------------------------------
+    static Kernel resolve(Kernel _kernel);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief seed used as the Philox key
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t m_seed;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief scale from the signed 24 bit random value to the box, extent / 2^23
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_scale[3];
+};
+
+#endif
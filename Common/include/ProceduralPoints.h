@@ -0,0 +1,80 @@
+#ifndef PROCEDURALPOINTS_H_
+#define PROCEDURALPOINTS_H_
+#include <ngl/Types.h>
+#include <cstddef>
+#include <cstdint>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ProceduralPoints.h
+/// @brief random points made in the vertex shader with no vertex data at all
+/// @class ProceduralPoints
+/// @brief the vertex shader runs the same Philox4x32-10 as PointGenerator with gl_VertexID as the counter
+/// and the seed as the key, so the points are the same as PointGenerator makes for that seed and the draw
+/// is just an empty VAO and glDrawArrays(GL_POINTS,0,N). A new set of points is a new seed uniform, there
+/// is nothing to generate or upload whatever the number of points. GLSL 3.30 has no 32x32 -> 64 bit
+/// multiply so the shader builds the high word from 16 bit halves.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ProceduralPoints
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until the first draw
+    /// @param _seed the seed, the same default as PointGenerator
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit ProceduralPoints(uint64_t _seed=0x5eed);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor releases the VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    ~ProceduralPoints();
+    ProceduralPoints(const ProceduralPoints &)=delete;
+    ProceduralPoints & operator=(const ProceduralPoints &)=delete;
+    void setSeed(uint64_t _seed){m_seed=_seed;}
+    uint64_t seed() const {return m_seed;}
+    void setSize(size_t _count){m_count=_count;}
+    size_t size() const {return m_count;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the half size of the box the points are in, the same as PointGenerator::setExtents
+    //----------------------------------------------------------------------------------------------------------------------
+    void setExtents(float _x, float _y, float _z);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a point made on the CPU with the same arithmetic as the shader (including the 16 bit multiply)
+    /// @param _index the gl_VertexID of the point
+    /// @param o_xyz the position
+    //----------------------------------------------------------------------------------------------------------------------
+    void point(uint32_t _index, float *o_xyz) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief use the procedural shader and bind the empty VAO so the caller can draw ranges of points, the
+    /// MVP is read from the FrameUniforms block so it must have been updated this frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind();
+    void unbind() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw all of the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    void release();
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the procedural program for this context from the ProgramCache and look up the per draw uniforms
+    //----------------------------------------------------------------------------------------------------------------------
+    void createShader();
+    uint64_t m_seed;
+    size_t m_count=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief extent / 2^23 as in PointGenerator
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_scale[3];
+    GLuint m_program=0;
+    GLint m_seedLocation=-1;
+    GLint m_scaleLocation=-1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief an empty VAO, the core profile needs one bound to draw
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_vao=0;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef PROGRAMCACHE_H_
+#define PROGRAMCACHE_H_
+#include <ngl/ShaderLib.h>
+#include <ngl/Types.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+class QOpenGLContextGroup;
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ProgramCache.h
+/// @brief keeps linked shader programs on disk so later runs skip compiling and linking them
+/// @class ProgramCache
+/// @brief build compiles and links a program through the ngl::ShaderLib the first time and saves it with
+/// glGetProgramBinary. The file is named by a hash of the sources and the GL vendor, renderer and version,
+/// so a new driver or an edited shader just misses. Later runs load it with glProgramBinary, a binary the
+/// driver rejects is deleted and the program compiled again. A loaded program isn't in the ShaderLib so it
+/// must be used by id and its uniforms set through locations looked up once, transform feedback varyings are
+/// given to build as they have to be set before linking. Needs GL 4.1 or ARB_get_program_binary and a driver with at least
+/// one binary format, otherwise or with no directory every program is compiled. program keeps one id per
+/// name for each group of sharing contexts so the classes using a program don't each hold their own.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ProgramCache
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one shader of a program
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stage
+    {
+      ngl::ShaderType type;
+      std::string source;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what the cache has done this run
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      /// @brief programs loaded from disk and programs compiled
+      unsigned int loaded=0;
+      unsigned int compiled=0;
+      /// @brief cached binaries the driver wouldn't take
+      unsigned int rejected=0;
+      /// @brief time spent in build loading and compiling
+      double loadMs=0.0;
+      double compileMs=0.0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cache shared by everything in the process
+    //----------------------------------------------------------------------------------------------------------------------
+    static ProgramCache *instance();
+    ProgramCache(const ProgramCache &)=delete;
+    ProgramCache & operator=(const ProgramCache &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where the binaries are kept, it is made if needed, an empty directory turns the cache off
+    //----------------------------------------------------------------------------------------------------------------------
+    void setDirectory(const std::string &_dir);
+    const std::string &directory() const {return m_dir;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the default directory, NGLPointsPrograms in the temporary directory
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::string defaultDirectory();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief can the current context save and load program binaries
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool isSupported();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief load a program from the cache or compile and link it, needs a current context
+    /// @param _name the ShaderLib name of the program, the shaders are called _name plus their stage e.g. Vertex
+    /// @param _stages the shaders and their sources
+    /// @param _varyings outputs captured by transform feedback, interleaved in this order
+    /// @returns the program id, 0 if it couldn't be compiled
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint build(const std::string &_name, const std::vector<Stage> &_stages,
+                 const std::vector<std::string> &_varyings=std::vector<std::string>());
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the program _name for the current context's share group, built the first time it is asked for in the
+    /// group and forgotten when the group's last context is destroyed (which deletes it)
+    /// @param _name the ShaderLib name of the program
+    /// @param _stages the shaders, only used the first time
+    /// @param _setup called once after building with the program in use, to bind blocks and set fixed uniforms
+    /// @param _varyings outputs captured by transform feedback as for build
+    /// @returns the program id, 0 if it couldn't be compiled or there is no current context
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint program(const std::string &_name, const std::vector<Stage> &_stages,
+                   const std::function<void(GLuint)> &_setup=std::function<void(GLuint)>(),
+                   const std::vector<std::string> &_varyings=std::vector<std::string>());
+    const Stats &stats() const {return m_stats;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the stats as a line for the log
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string summary() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the hash the files are named with, FNV-1a 64 over the strings in turn
+    //----------------------------------------------------------------------------------------------------------------------
+    static uint64_t hash(const std::vector<std::string> &_strings);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the header and binary of a cache file, reading fails if the key doesn't match or the file is short
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool writeFile(const std::string &_file, uint64_t _key, GLenum _format, const std::vector<char> &_binary);
+    static bool readFile(const std::string &_file, uint64_t _key, GLenum &o_format, std::vector<char> &o_binary);
+
+  private :
+    ProgramCache();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the file for a program, the key is the hash of everything the binary depends on
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string fileName(const std::string &_name, uint64_t _key) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make a program from a cached binary
+    /// @returns the program or 0 if there is no usable binary
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint load(const std::string &_file, uint64_t _key);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief compile and link with the ShaderLib
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint compile(const std::string &_name, const std::vector<Stage> &_stages, const std::vector<std::string> &_varyings,
+                   bool _retrievable);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write a linked program's binary
+    //----------------------------------------------------------------------------------------------------------------------
+    void save(GLuint _program, const std::string &_file, uint64_t _key);
+    std::string m_dir;
+    Stats m_stats;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the programs made by program for each share group
+    //----------------------------------------------------------------------------------------------------------------------
+    std::map<QOpenGLContextGroup *,std::map<std::string,GLuint>> m_programs;
+};
+
+#endif
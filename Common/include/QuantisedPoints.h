@@ -0,0 +1,117 @@
+#ifndef QUANTISEDPOINTS_H_
+#define QUANTISEDPOINTS_H_
+#include <ngl/Types.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file QuantisedPoints.h
+/// @brief points stored as normalised integers rather than floats to cut upload and vertex fetch bandwidth
+/// @class QuantisedPoints
+/// @brief the points are split into chunks of 2^chunkShift consecutive points and each chunk is
+/// quantised relative to its own bounding box, either to three 16 bit unsigned shorts (6 bytes, half the
+/// size of float xyz) or to GL_UNSIGNED_INT_2_10_10_10_REV (4 bytes). The bounds of every chunk are held in a
+/// buffer texture and the vertex shader finds its chunk from gl_VertexID, so the points can be drawn with any
+/// glDrawArrays / glMultiDrawArrays range. The error on each axis is at most half a step of the chunk's
+/// extent, the tighter the chunks (e.g. after sorting with ChunkGrid) the smaller it is.
+//----------------------------------------------------------------------------------------------------------------------
+
+class QuantisedPoints
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the vertex format
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Format{Short,Packed1010102};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, no GL calls are made until upload
+    /// @param _format the vertex format
+    /// @param _chunkShift each chunk is 2^_chunkShift points
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit QuantisedPoints(Format _format=Format::Short, unsigned int _chunkShift=14);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor releases the GL objects
+    //----------------------------------------------------------------------------------------------------------------------
+    ~QuantisedPoints();
+    QuantisedPoints(const QuantisedPoints &)=delete;
+    QuantisedPoints & operator=(const QuantisedPoints &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief quantise float xyz points on the CPU, split over the ThreadPool
+    /// @param _xyz packed x y z floats
+    /// @param _count the number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void quantise(const float *_xyz, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the position the vertex shader will compute for a point
+    /// @param _index the point
+    /// @param o_xyz the x y z
+    //----------------------------------------------------------------------------------------------------------------------
+    void dequantise(size_t _index, float *o_xyz) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the most a point can move on each axis, half a step of the largest chunk extent
+    //----------------------------------------------------------------------------------------------------------------------
+    void errorBound(float *o_xyz) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy the quantised points and the chunk bounds to the GPU, the buffers only grow
+    //----------------------------------------------------------------------------------------------------------------------
+    void upload();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief use the dequantising shader and bind the VAO so the caller can draw ranges of the points, the
+    /// MVP is read from the FrameUniforms block so it must have been updated this frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind() const;
+    void unbind() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw all of the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the GL objects
+    //----------------------------------------------------------------------------------------------------------------------
+    void release();
+    Format format() const {return m_format;}
+    size_t size() const {return m_count;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes of each vertex on the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t bytesPerPoint() const {return m_format == Format::Short ? 3*sizeof(uint16_t) : sizeof(uint32_t);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes used by the points and the chunk bounds
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t bytes() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the format as a string for messages
+    //----------------------------------------------------------------------------------------------------------------------
+    static const char *formatName(Format _format);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the dequantising program for this context from the ProgramCache and look up the per draw uniform
+    //----------------------------------------------------------------------------------------------------------------------
+    void createShader();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the largest quantised value on each axis
+    //----------------------------------------------------------------------------------------------------------------------
+    float maxValue() const {return m_format == Format::Short ? 65535.0f : 1023.0f;}
+    Format m_format;
+    unsigned int m_chunkShift;
+    size_t m_count=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the quantised points, bytesPerPoint() each
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned char> m_data;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief min xyz and extent xyz of each chunk padded to vec4 for the RGBA32F buffer texture
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<float> m_bounds;
+    GLuint m_program=0;
+    GLint m_chunkShiftLocation=-1;
+    GLuint m_vao=0;
+    GLuint m_vbo=0;
+    GLuint m_boundsBuffer=0;
+    GLuint m_boundsTexture=0;
+    size_t m_vboCapacity=0;
+    size_t m_boundsCapacity=0;
+};
+
+#endif
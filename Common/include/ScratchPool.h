@@ -0,0 +1,92 @@
+#ifndef SCRATCHPOOL_H_
+#define SCRATCHPOOL_H_
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ScratchPool.h
+/// @brief reusable CPU memory for point data that can't be written straight into a GL buffer
+/// @class ScratchPool
+/// @brief acquire hands out a block of at least the size asked for, taking the smallest idle block
+/// that fits and only going to the heap when none does. The block goes back to the pool when the
+/// Block handle is destroyed, so regenerating the same number of points again reuses it. Sizes are
+/// rounded up to s_granularity so small changes in the point count hit the same blocks. The counters
+/// show how often the heap was used, trim frees the idle blocks.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ScratchPool
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counters of a pool
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      /// @brief blocks that had to come from the heap and their total size
+      size_t allocations=0;
+      size_t bytesAllocated=0;
+      /// @brief acquires met by an idle block
+      size_t reuses=0;
+      /// @brief bytes owned by the pool, in use or idle
+      size_t bytesHeld=0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a block from the pool, move only, returned to the pool by the dtor
+    //----------------------------------------------------------------------------------------------------------------------
+    class Block
+    {
+      public :
+        Block()=default;
+        Block(Block &&_other);
+        Block & operator=(Block &&_other);
+        Block(const Block &)=delete;
+        Block & operator=(const Block &)=delete;
+        ~Block();
+        void *data() const {return m_data.get();}
+        float *floats() const {return reinterpret_cast<float *>(m_data.get());}
+        //----------------------------------------------------------------------------------------------------------------------
+        /// @brief the usable bytes, at least the size asked for
+        //----------------------------------------------------------------------------------------------------------------------
+        size_t capacity() const {return m_capacity;}
+
+      private :
+        friend class ScratchPool;
+        Block(ScratchPool *_pool, std::unique_ptr<char[]> _data, size_t _capacity);
+        ScratchPool *m_pool=nullptr;
+        std::unique_ptr<char[]> m_data;
+        size_t m_capacity=0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the pool shared by the demos
+    //----------------------------------------------------------------------------------------------------------------------
+    static ScratchPool *instance();
+    ScratchPool()=default;
+    ScratchPool(const ScratchPool &)=delete;
+    ScratchPool & operator=(const ScratchPool &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get a block of at least _bytes, the contents are undefined
+    //----------------------------------------------------------------------------------------------------------------------
+    Block acquire(size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief free every idle block, blocks in use still come back to the pool
+    //----------------------------------------------------------------------------------------------------------------------
+    void trim();
+    Stats stats() const;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief put a block back on the idle list, called by ~Block
+    //----------------------------------------------------------------------------------------------------------------------
+    void release(std::unique_ptr<char[]> _data, size_t _capacity);
+    struct Idle
+    {
+      std::unique_ptr<char[]> data;
+      size_t capacity;
+    };
+    mutable std::mutex m_mutex;
+    std::vector<Idle> m_idle;
+    Stats m_stats;
+};
+
+#endif
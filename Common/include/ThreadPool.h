@@ -0,0 +1,73 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ThreadPool.h
+/// @brief a simple persistent pool of worker threads shared by the demos
+/// @class ThreadPool
+/// @brief workers are created once and then wait for tasks. parallelFor splits a range into chunks
+/// which are pulled by the workers and the calling thread, it only returns once every chunk is done.
+/// As the caller also runs chunks it is safe to call parallelFor from inside a task.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ThreadPool
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the shared pool, this uses one thread per hardware core
+    //----------------------------------------------------------------------------------------------------------------------
+    static ThreadPool *instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _threads the total number of threads including the caller, 0 means one per core
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit ThreadPool(unsigned int _threads=0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor will finish any queued tasks then join the workers
+    //----------------------------------------------------------------------------------------------------------------------
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &)=delete;
+    ThreadPool & operator=(const ThreadPool &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of threads that run work, this includes the caller of parallelFor
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int numThreads() const {return static_cast<unsigned int>(m_workers.size())+1;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run _func over [_begin,_end) split into chunks, blocks until all chunks are complete
+    /// @param _begin the first index
+    /// @param _end one past the last index
+    /// @param _func called as _func(chunkBegin,chunkEnd) for each chunk
+    /// @param _grain the minimum chunk size, 0 will pick a size based on the number of threads
+    //----------------------------------------------------------------------------------------------------------------------
+    void parallelFor(size_t _begin, size_t _end, const std::function<void(size_t,size_t)> &_func, size_t _grain=0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief queue a task to run on one of the workers and return straight away
+    /// @param _task the task to run
+    //----------------------------------------------------------------------------------------------------------------------
+    void submit(std::function<void()> _task);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the loop each worker runs, pops and runs tasks until m_quit is set
+    //----------------------------------------------------------------------------------------------------------------------
+    void workerLoop();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our worker threads
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<std::thread> m_workers;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief tasks waiting to run, protected by m_mutex
+    //----------------------------------------------------------------------------------------------------------------------
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit=false;
+};
+
+#endif
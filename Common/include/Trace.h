@@ -0,0 +1,204 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+// the timestamps are read from the time stamp counter where there is one, it is a fraction of the cost
+// of the steady clock
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #define TRACE_TSC
+  #include <x86intrin.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Trace.h
+/// @brief scoped CPU trace markers written out as Chrome trace-event JSON, which chrome://tracing and
+/// ui.perfetto.dev open directly
+/// @class Trace
+/// @brief TRACE_SCOPE("name") records the time from where it is to the end of the enclosing block. While
+/// recording is off a marker is one relaxed load, with NO_TRACE defined it is compiled out completely.
+/// Each thread appends to its own buffer of fixed size chunks, the count of a chunk is only written by its
+/// thread and published with a release store so recording takes no lock (only a thread's first event,
+/// which registers its buffer, does). start begins a new capture, each thread rewinds its buffer the next
+/// time it records. Times are kept in ticks of the time stamp counter (invariant on any x86 from the last
+/// decade) and converted at write with the rate measured against the steady clock since start, elsewhere
+/// they are steady clock ns. The buffers are read when writing so that should be done once recording has stopped,
+/// a scope still open then is either in the file or not but never torn. The names must be string literals
+/// or otherwise outlive the trace as only the pointer is kept.
+//----------------------------------------------------------------------------------------------------------------------
+
+class Trace
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the shared trace
+    //----------------------------------------------------------------------------------------------------------------------
+    static Trace *instance();
+    ~Trace();
+    Trace(const Trace &)=delete;
+    Trace & operator=(const Trace &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief is a capture being recorded, this is what each marker checks
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool enabled() {return s_enabled.load(std::memory_order_relaxed);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the time in ticks for record
+    //----------------------------------------------------------------------------------------------------------------------
+    static uint64_t now()
+    {
+#ifdef TRACE_TSC
+      return __rdtsc();
+#else
+      return steadyNs();
+#endif
+    }
+    static uint64_t steadyNs();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add an event to the calling thread's buffer, does nothing unless recording
+    /// @param _name what happened, only the pointer is kept
+    /// @param _begin / _end when it happened from now()
+    //----------------------------------------------------------------------------------------------------------------------
+    static void record(const char *_name, uint64_t _begin, uint64_t _end);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief name the calling thread in the trace, threads not named are "thread" and their id
+    //----------------------------------------------------------------------------------------------------------------------
+    static void setThreadName(const char *_name);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start a new capture, anything recorded before is dropped
+    //----------------------------------------------------------------------------------------------------------------------
+    void start();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stop recording and write the capture to file()
+    /// @param _log where to say what was written
+    //----------------------------------------------------------------------------------------------------------------------
+    bool stop(std::ostream &_log);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start or stop, for a hotkey
+    //----------------------------------------------------------------------------------------------------------------------
+    void toggle(std::ostream &_log);
+    bool isRecording() const {return enabled();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where stop writes the capture, trace.json by default
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFile(const std::string &_fname){m_file=_fname;}
+    const std::string &file() const {return m_file;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write the capture as a Chrome trace-event JSON object, complete events with times in us from start
+    /// @returns the number of events written
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t writeJSON(std::ostream &_out) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief events lost since start because a thread's buffer was full
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t dropped() const;
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @class Scope
+    /// @brief records from construction to destruction, only if recording was on at construction
+    //----------------------------------------------------------------------------------------------------------------------
+    class Scope
+    {
+      public :
+        explicit Scope(const char *_name) : m_name(enabled() ? _name : nullptr)
+        {
+          if(m_name != nullptr)
+          {
+            m_begin=now();
+          }
+        }
+        ~Scope()
+        {
+          if(m_name != nullptr)
+          {
+            record(m_name,m_begin,now());
+          }
+        }
+        Scope(const Scope &)=delete;
+        Scope & operator=(const Scope &)=delete;
+
+      private :
+        const char *m_name;
+        uint64_t m_begin=0;
+    };
+
+  private :
+    Trace()=default;
+    struct Event
+    {
+      const char *name;
+      uint64_t begin;
+      uint64_t end;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief events per chunk and the most chunks a thread may use in one capture (about 24MB)
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr size_t s_chunkEvents=4096;
+    static constexpr size_t s_maxChunks=256;
+    struct Chunk
+    {
+      Event events[s_chunkEvents];
+      std::atomic<size_t> count{0};
+      std::atomic<Chunk *> next{nullptr};
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one per thread that has recorded, kept after the thread exits so its events can still be written
+    //----------------------------------------------------------------------------------------------------------------------
+    struct ThreadBuffer
+    {
+      ~ThreadBuffer();
+      Chunk head;
+      Chunk *tail=&head;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief chunks filled in this capture including the tail, the ones after it are kept for the next capture
+      //----------------------------------------------------------------------------------------------------------------------
+      size_t used=1;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the capture the events are from, only written by its thread but read when writing so atomic
+      //----------------------------------------------------------------------------------------------------------------------
+      std::atomic<uint32_t> generation{0};
+      uint32_t id=0;
+      std::atomic<const char *> name{nullptr};
+      std::atomic<size_t> dropped{0};
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the calling thread's buffer, registered on first use
+    //----------------------------------------------------------------------------------------------------------------------
+    ThreadBuffer *threadBuffer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief empty a buffer for a new capture, only called by its own thread
+    //----------------------------------------------------------------------------------------------------------------------
+    static void rewind(ThreadBuffer &io_buffer);
+    static std::atomic<bool> s_enabled;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bumped by start, a buffer recorded in an older capture is rewound
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::atomic<uint32_t> s_generation;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffers of every thread, protected by m_mutex which is only taken to add one or to write
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    mutable std::mutex m_mutex;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief when start was called in ticks and steady clock ns, to convert the ticks when writing
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t m_startTicks=0;
+    uint64_t m_startNs=0;
+    std::string m_file="trace.json";
+};
+
+#ifdef NO_TRACE
+  #define TRACE_SCOPE(_name) do{}while(false)
+#else
+  #define TRACE_CONCAT_(_a,_b) _a##_b
+  #define TRACE_CONCAT(_a,_b) TRACE_CONCAT_(_a,_b)
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief record the rest of the enclosing block as _name
+  //----------------------------------------------------------------------------------------------------------------------
+  #define TRACE_SCOPE(_name) Trace::Scope TRACE_CONCAT(traceScope,__LINE__)(_name)
+#endif
+
+#endif
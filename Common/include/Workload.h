@@ -0,0 +1,145 @@
+#ifndef WORKLOAD_H_
+#define WORKLOAD_H_
+#include "PointGenerator.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Workload.h
+/// @brief point sets shaped like real data for testing culling, LOD and sorting, not just uniform noise
+/// @class Workload
+/// @brief a drop in for PointGenerator (the same seed / generate calls) that fills the box with one of several
+/// shapes. Uniform is the PointGenerator so gives exactly the points the demos always had, the others are :
+/// Clusters, gaussian blobs of different sizes and populations; Sphere, the surface of a sphere with a little
+/// scanner noise; Terrain, a heightfield of summed waves over the xz plane; ScanLines, long thin lines across
+/// the box like passes of a scanner; HeavyTail, hotspots with Zipf populations whose density falls off as a
+/// power of the distance so a few cells hold most of the points. As with PointGenerator point i only depends
+/// on the seed and i (the parameters of the shape, centres, waves and lines, are made from the seed) so any
+/// range can be generated on its own, the work is split across the ThreadPool and a seed gives the same
+/// points however many threads are used. The shapes use the C maths library so are only guaranteed bit
+/// identical on the same platform.
+//----------------------------------------------------------------------------------------------------------------------
+
+class Workload
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the shapes we can generate
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Shape{Uniform,Clusters,Sphere,Terrain,ScanLines,HeavyTail};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _shape the shape of the points
+    /// @param _seed the seed for the points and the shape's parameters
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit Workload(Shape _shape=Shape::Uniform, uint64_t _seed=0x5eed);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the seed, a new seed gives new points and e.g. new cluster centres
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSeed(uint64_t _seed);
+    uint64_t seed() const {return m_generator.seed();}
+    void setShape(Shape _shape){m_shape=_shape;}
+    Shape shape() const {return m_shape;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the half size of the box every shape fits in, the same as getRandomPoint(x,y,z)
+    //----------------------------------------------------------------------------------------------------------------------
+    void setExtents(float _x, float _y, float _z);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate points in parallel using the ThreadPool
+    /// @param o_xyz where to write, must hold 3*_count floats
+    /// @param _count the number of points
+    /// @param _firstIndex the index of the first point in the sequence, lets a range be re-generated
+    //----------------------------------------------------------------------------------------------------------------------
+    void generate(float *o_xyz, size_t _count, uint64_t _firstIndex=0) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate points on the calling thread only
+    //----------------------------------------------------------------------------------------------------------------------
+    void generateSerial(float *o_xyz, size_t _count, uint64_t _firstIndex=0) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the name of a shape for printing and the command line
+    //----------------------------------------------------------------------------------------------------------------------
+    static const char *shapeName(Shape _shape);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief every shape name separated by commas, for help text
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::string shapeNames();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the shape called _name (any case)
+    /// @returns false if there isn't one
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool parseShape(const std::string &_name, Shape &o_shape);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief time generating _count points of every shape and print the throughput
+    /// @param _count the number of points
+    /// @param _iterations timed runs, the best is reported
+    /// @param _log where to write the results
+    //----------------------------------------------------------------------------------------------------------------------
+    static void benchmark(size_t _count, unsigned int _iterations, std::ostream &_log);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make the centres, waves and lines of the shapes from the seed
+    //----------------------------------------------------------------------------------------------------------------------
+    void makeParameters();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one point of each shape
+    //----------------------------------------------------------------------------------------------------------------------
+    void cluster(uint64_t _index, float *o_xyz) const;
+    void sphere(uint64_t _index, float *o_xyz) const;
+    void terrain(uint64_t _index, float *o_xyz) const;
+    void scanLine(uint64_t _index, float *o_xyz) const;
+    void heavyTail(uint64_t _index, float *o_xyz) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief scale a point from the -1 -> 1 box to the extents and clamp it inside them
+    //----------------------------------------------------------------------------------------------------------------------
+    void scaleToBox(float *io_xyz) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a cluster or hotspot in the unit box with its size and the running total of the populations up to it
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Centre
+    {
+      float position[3];
+      float size;
+      float cumulative;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one of the waves summed for the terrain, a sine along a direction in xz
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Wave
+    {
+      float direction[2];
+      float frequency;
+      float phase;
+      float amplitude;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a scan line in the unit box, it runs from start to start+direction
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Line
+    {
+      float start[3];
+      float direction[3];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the index of the centre a random word falls in by population
+    //----------------------------------------------------------------------------------------------------------------------
+    static size_t pick(const std::vector<Centre> &_centres, uint32_t _random);
+
+    Shape m_shape;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief makes the uniform points and holds the seed
+    //----------------------------------------------------------------------------------------------------------------------
+    PointGenerator m_generator;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the shapes are made in a -1 -> 1 box and scaled by these
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_extents[3];
+    std::vector<Centre> m_clusters;
+    std::vector<Centre> m_hotspots;
+    std::vector<Wave> m_waves;
+    std::vector<Line> m_lines;
+};
+
+#endif
@@ -0,0 +1,365 @@
+#include "AttributePoints.h"
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+namespace
+{
+  /// @brief the name of the attribute shader program in the ngl::ShaderLib
+  const char *s_shaderProgram="AttributePoints";
+
+  /// @brief MVP comes from the FrameData block
+  const char *s_vertexShader=R"(#version 330 core
+layout (location=0) in vec3 inPosition;
+layout (location=1) in vec4 inColour;
+layout (location=2) in float inSize;
+layout (location=3) in float inIntensity;
+uniform float sizeScale;
+out vec4 pointColour;
+void main()
+{
+  gl_Position=MVP*vec4(inPosition,1.0);
+  gl_PointSize=inSize*sizeScale;
+  pointColour=vec4(inColour.rgb*inIntensity,inColour.a);
+}
+)";
+
+  const char *s_fragmentShader=R"(#version 330 core
+in vec4 pointColour;
+layout (location=0) out vec4 fragColour;
+void main()
+{
+  fragColour=pointColour;
+}
+)";
+
+  /// @brief the cold attributes of the HotCold layout
+  struct ColdAttributes
+  {
+    uint32_t colour;
+    float size;
+    float intensity;
+  };
+
+  /// @brief the attribute type, component count and normalisation for each location
+  struct AttributeFormat
+  {
+    GLint components;
+    GLenum type;
+    GLboolean normalise;
+  };
+  const AttributeFormat s_formats[]=
+  {
+    {3,GL_FLOAT,GL_FALSE},
+    {4,GL_UNSIGNED_BYTE,GL_TRUE},
+    {1,GL_FLOAT,GL_FALSE},
+    {1,GL_FLOAT,GL_FALSE}
+  };
+}
+
+static_assert(sizeof(AttributePoints::Point) == 24,"Point is uploaded as the interleaved vertex so must be packed");
+static_assert(sizeof(ColdAttributes) == 12,"ColdAttributes is uploaded as the cold vertex so must be packed");
+
+AttributePoints::AttributePoints(Layout _layout) : m_layout(_layout)
+{
+  switch(m_layout)
+  {
+    case Layout::Interleaved :
+      m_streams.resize(1);
+      m_streams[0].stride=sizeof(Point);
+      m_attributes[Position]={0,offsetof(Point,position)};
+      m_attributes[Colour]={0,offsetof(Point,colour)};
+      m_attributes[Size]={0,offsetof(Point,size)};
+      m_attributes[Intensity]={0,offsetof(Point,intensity)};
+    break;
+    case Layout::Separate :
+      m_streams.resize(NumAttributes);
+      m_streams[Position].stride=3*sizeof(float);
+      m_streams[Colour].stride=sizeof(uint32_t);
+      m_streams[Size].stride=sizeof(float);
+      m_streams[Intensity].stride=sizeof(float);
+      for(size_t i=0; i<NumAttributes; ++i)
+      {
+        m_attributes[i]={i,0};
+      }
+    break;
+    case Layout::HotCold :
+      m_streams.resize(2);
+      m_streams[0].stride=3*sizeof(float);
+      m_streams[1].stride=sizeof(ColdAttributes);
+      m_attributes[Position]={0,0};
+      m_attributes[Colour]={1,offsetof(ColdAttributes,colour)};
+      m_attributes[Size]={1,offsetof(ColdAttributes,size)};
+      m_attributes[Intensity]={1,offsetof(ColdAttributes,intensity)};
+    break;
+  }
+}
+
+AttributePoints::~AttributePoints()
+{
+  release();
+}
+
+const char *AttributePoints::layoutName(Layout _layout)
+{
+  switch(_layout)
+  {
+    case Layout::Interleaved : return "AoS";
+    case Layout::Separate : return "SoA";
+    case Layout::HotCold : return "HotCold";
+  }
+  return "";
+}
+
+void AttributePoints::shade(const float *_p, uint32_t &o_colour, float &o_size, float &o_intensity) const
+{
+  float lengthSquared=0.0f;
+  uint32_t rgb[3];
+  for(int axis=0; axis<3; ++axis)
+  {
+    // -1 -> 1 across the bounds
+    float n=(_p[axis]-m_centre[axis])/m_halfSize[axis];
+    lengthSquared+=n*n;
+    rgb[axis]=static_cast<uint32_t>(std::min(std::max(n*0.5f+0.5f,0.0f),1.0f)*255.0f+0.5f);
+  }
+  float r=std::min(std::sqrt(lengthSquared/3.0f),1.0f);
+  o_colour=rgb[0] | (rgb[1]<<8) | (rgb[2]<<16) | (255u<<24);
+  o_intensity=1.0f-0.75f*r;
+  o_size=1.0f+4.0f*(1.0f-r);
+}
+
+void AttributePoints::setPoints(const float *_xyz, size_t _count)
+{
+  m_count=_count;
+  // the bounds give the colours so find them first, each chunk is reduced then merged
+  float min[3];
+  float max[3];
+  std::fill(min,min+3,std::numeric_limits<float>::max());
+  std::fill(max,max+3,std::numeric_limits<float>::lowest());
+  std::mutex boundsMutex;
+  ThreadPool::instance()->parallelFor(0,_count,[&](size_t _begin, size_t _end)
+  {
+    float chunkMin[3];
+    float chunkMax[3];
+    std::fill(chunkMin,chunkMin+3,std::numeric_limits<float>::max());
+    std::fill(chunkMax,chunkMax+3,std::numeric_limits<float>::lowest());
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      for(int axis=0; axis<3; ++axis)
+      {
+        chunkMin[axis]=std::min(chunkMin[axis],_xyz[i*3+axis]);
+        chunkMax[axis]=std::max(chunkMax[axis],_xyz[i*3+axis]);
+      }
+    }
+    std::lock_guard<std::mutex> lock(boundsMutex);
+    for(int axis=0; axis<3; ++axis)
+    {
+      min[axis]=std::min(min[axis],chunkMin[axis]);
+      max[axis]=std::max(max[axis],chunkMax[axis]);
+    }
+  });
+  for(int axis=0; axis<3; ++axis)
+  {
+    m_centre[axis]= _count ? (min[axis]+max[axis])*0.5f : 0.0f;
+    m_halfSize[axis]= _count && max[axis] > min[axis] ? (max[axis]-min[axis])*0.5f : 1.0f;
+  }
+  for(auto &s : m_streams)
+  {
+    s.data.resize(_count*s.stride);
+    s.dirty=true;
+  }
+  // each layout writes its streams front to back with the stores it needs and nothing else
+  switch(m_layout)
+  {
+    case Layout::Interleaved :
+    {
+      Point *points=reinterpret_cast<Point *>(m_streams[0].data.data());
+      ThreadPool::instance()->parallelFor(0,_count,[&](size_t _begin, size_t _end)
+      {
+        for(size_t i=_begin; i<_end; ++i)
+        {
+          Point p;
+          std::memcpy(p.position,&_xyz[i*3],sizeof(p.position));
+          shade(p.position,p.colour,p.size,p.intensity);
+          points[i]=p;
+        }
+      });
+    }
+    break;
+    case Layout::Separate :
+    {
+      uint32_t *colours=reinterpret_cast<uint32_t *>(m_streams[Colour].data.data());
+      float *sizes=reinterpret_cast<float *>(m_streams[Size].data.data());
+      float *intensities=reinterpret_cast<float *>(m_streams[Intensity].data.data());
+      unsigned char *positions=m_streams[Position].data.data();
+      ThreadPool::instance()->parallelFor(0,_count,[&](size_t _begin, size_t _end)
+      {
+        std::memcpy(positions+_begin*3*sizeof(float),&_xyz[_begin*3],(_end-_begin)*3*sizeof(float));
+        for(size_t i=_begin; i<_end; ++i)
+        {
+          shade(&_xyz[i*3],colours[i],sizes[i],intensities[i]);
+        }
+      });
+    }
+    break;
+    case Layout::HotCold :
+    {
+      unsigned char *positions=m_streams[0].data.data();
+      ColdAttributes *cold=reinterpret_cast<ColdAttributes *>(m_streams[1].data.data());
+      ThreadPool::instance()->parallelFor(0,_count,[&](size_t _begin, size_t _end)
+      {
+        std::memcpy(positions+_begin*3*sizeof(float),&_xyz[_begin*3],(_end-_begin)*3*sizeof(float));
+        for(size_t i=_begin; i<_end; ++i)
+        {
+          ColdAttributes c;
+          shade(&_xyz[i*3],c.colour,c.size,c.intensity);
+          cold[i]=c;
+        }
+      });
+    }
+    break;
+  }
+}
+
+void AttributePoints::setPositions(const float *_xyz)
+{
+  Stream &stream=m_streams[m_attributes[Position].stream];
+  stream.dirty=true;
+  if(m_layout == Layout::Interleaved)
+  {
+    // the positions are spread through the interleaved buffer so all of it is uploaded again
+    Point *points=reinterpret_cast<Point *>(stream.data.data());
+    ThreadPool::instance()->parallelFor(0,m_count,[&](size_t _begin, size_t _end)
+    {
+      for(size_t i=_begin; i<_end; ++i)
+      {
+        std::memcpy(points[i].position,&_xyz[i*3],sizeof(points[i].position));
+      }
+    });
+  }
+  else
+  {
+    std::memcpy(stream.data.data(),_xyz,m_count*3*sizeof(float));
+  }
+}
+
+AttributePoints::Point AttributePoints::point(size_t _index) const
+{
+  Point p;
+  auto read=[this,_index](AttributeIndex _attribute, void *o_value, size_t _bytes)
+  {
+    const Attribute &a=m_attributes[_attribute];
+    const Stream &s=m_streams[a.stream];
+    std::memcpy(o_value,&s.data[_index*s.stride+a.offset],_bytes);
+  };
+  read(Position,p.position,sizeof(p.position));
+  read(Colour,&p.colour,sizeof(p.colour));
+  read(Size,&p.size,sizeof(p.size));
+  read(Intensity,&p.intensity,sizeof(p.intensity));
+  return p;
+}
+
+void AttributePoints::createShader()
+{
+  m_program=ProgramCache::instance()->program(s_shaderProgram,{{ngl::ShaderType::VERTEX,FrameUniforms::withBlock(s_vertexShader)},
+                                                               {ngl::ShaderType::FRAGMENT,s_fragmentShader}},
+                                              FrameUniforms::attach);
+  m_sizeScaleLocation=glGetUniformLocation(m_program,"sizeScale");
+}
+
+void AttributePoints::setAttributePointers()
+{
+  GLState *state=GLState::instance();
+  state->bindVertexArray(m_vao);
+  for(size_t i=0; i<NumAttributes; ++i)
+  {
+    const Attribute &a=m_attributes[i];
+    const Stream &s=m_streams[a.stream];
+    state->bindBuffer(GL_ARRAY_BUFFER,s.buffer);
+    glVertexAttribPointer(static_cast<GLuint>(i),s_formats[i].components,s_formats[i].type,s_formats[i].normalise,
+                          static_cast<GLsizei>(s.stride),reinterpret_cast<const void *>(a.offset));
+    glEnableVertexAttribArray(static_cast<GLuint>(i));
+  }
+  state->unbindVertexArray();
+}
+
+void AttributePoints::upload()
+{
+  if(m_vao == 0)
+  {
+    createShader();
+    glGenVertexArrays(1,&m_vao);
+    for(auto &s : m_streams)
+    {
+      glGenBuffers(1,&s.buffer);
+    }
+    setAttributePointers();
+  }
+  GLState *state=GLState::instance();
+  for(auto &s : m_streams)
+  {
+    if(!s.dirty || s.data.empty())
+    {
+      continue;
+    }
+    state->bindBuffer(GL_ARRAY_BUFFER,s.buffer);
+    // like PointBuffer the storage only grows, a smaller set is written into the old buffer
+    if(s.data.size() > s.capacity)
+    {
+      state->bufferData(GL_ARRAY_BUFFER,s.data.size(),s.data.data(),GL_STATIC_DRAW);
+      s.capacity=s.data.size();
+    }
+    else
+    {
+      state->bufferSubData(GL_ARRAY_BUFFER,0,s.data.size(),s.data.data());
+    }
+    s.dirty=false;
+  }
+}
+
+void AttributePoints::bind(ngl::Real _sizeScale) const
+{
+  GLState *state=GLState::instance();
+  state->useProgram(m_program);
+  glUniform1f(m_sizeScaleLocation,_sizeScale);
+  // the size comes from the shader rather than glPointSize
+  glEnable(GL_PROGRAM_POINT_SIZE);
+  state->bindVertexArray(m_vao);
+}
+
+void AttributePoints::unbind() const
+{
+  GLState::instance()->unbindVertexArray();
+  glDisable(GL_PROGRAM_POINT_SIZE);
+}
+
+void AttributePoints::draw(ngl::Real _sizeScale) const
+{
+  bind(_sizeScale);
+  GLState::instance()->drawArrays(GL_POINTS,0,static_cast<GLsizei>(m_count));
+  unbind();
+}
+
+void AttributePoints::release()
+{
+  if(m_vao == 0)
+  {
+    return;
+  }
+  GLState *state=GLState::instance();
+  for(auto &s : m_streams)
+  {
+    state->deleteBuffers(1,&s.buffer);
+    s.buffer=0;
+    s.capacity=0;
+    s.dirty=true;
+  }
+  state->deleteVertexArrays(1,&m_vao);
+  m_vao=0;
+}
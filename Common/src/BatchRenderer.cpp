@@ -0,0 +1,79 @@
+#include "BatchRenderer.h"
+#include "FrameCapture.h"
+#include "ThreadPool.h"
+#include <QOpenGLFramebufferObject>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+BatchRenderer::~BatchRenderer()
+{
+  m_context.doneCurrent();
+}
+
+bool BatchRenderer::run(const QSurfaceFormat &_format, const std::function<void()> &_initialise, const std::function<void()> &_paint,
+                        std::ostream &_log)
+{
+  if(!FrameCapture::isValidPattern(m_options.pattern))
+  {
+    _log<<"the output needs a single %d for the frame number, e.g. frame%04d.png\n";
+    return false;
+  }
+  m_surface.setFormat(_format);
+  m_surface.create();
+  m_context.setFormat(_format);
+  if(!m_context.create() || !m_context.makeCurrent(&m_surface))
+  {
+    _log<<"unable to create an OpenGL context\n";
+    return false;
+  }
+  _initialise();
+  const int width=m_options.width;
+  const int height=m_options.height;
+  // the same samples the window would have, resolved into a plain FBO before it is read
+  QOpenGLFramebufferObjectFormat fboFormat;
+  fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+  fboFormat.setSamples(std::max(0,_format.samples()));
+  QOpenGLFramebufferObject target(width,height,fboFormat);
+  std::unique_ptr<QOpenGLFramebufferObject> resolve;
+  if(_format.samples() > 0)
+  {
+    resolve.reset(new QOpenGLFramebufferObject(width,height));
+  }
+  FrameCapture capture(width,height,m_options.pattern,m_options.numPBOs);
+  auto start=std::chrono::steady_clock::now();
+  for(unsigned int frame=0; frame<m_options.frames; ++frame)
+  {
+    target.bind();
+    _paint();
+    if(resolve)
+    {
+      QOpenGLFramebufferObject::blitFramebuffer(resolve.get(),&target);
+      glBindFramebuffer(GL_READ_FRAMEBUFFER,resolve->handle());
+    }
+    else
+    {
+      glBindFramebuffer(GL_READ_FRAMEBUFFER,target.handle());
+    }
+    capture.capture(frame);
+  }
+  double renderSeconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  bool ok=capture.finish();
+  double totalSeconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  target.release();
+
+  FrameCapture::Stats stats=capture.stats();
+  unsigned int frames=std::max(1u,m_options.frames);
+  _log<<stats.written<<" of "<<m_options.frames<<" frames of "<<width<<"x"<<height<<" written as "
+      <<m_options.pattern<<" in "<<totalSeconds<<" s, "
+      <<m_options.frames/std::max(totalSeconds,1.0e-9)<<" fps ("<<m_options.frames/std::max(renderSeconds,1.0e-9)
+      <<" fps render loop)\n"
+      <<"readback through "<<m_options.numPBOs<<" PBOs waited "<<stats.readbackWaits<<" times ("<<stats.readbackWaitMs
+      <<" ms), the encoders held the loop back "<<stats.encodeWaits<<" times, "<<stats.encodeMs/frames
+      <<" ms to encode a frame on "<<ThreadPool::instance()->numThreads()<<" threads\n";
+  if(!ok)
+  {
+    _log<<stats.failed<<" frames could not be written\n";
+  }
+  return ok;
+}
@@ -0,0 +1,184 @@
+#include "ChunkGrid.h"
+#include "Frustum.h"
+#include "GLState.h"
+#include "Morton.h"
+#include "ScratchPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+constexpr unsigned int ChunkGrid::s_maxResolution;
+
+ChunkGrid::ChunkGrid(unsigned int _resolution) : m_resolution(1)
+{
+  // the Morton code of a cell runs up to the next power of 2 cubed, so the grid is that size
+  unsigned int resolution=std::min(std::max(_resolution,1u),s_maxResolution);
+  while(m_resolution < resolution)
+  {
+    m_resolution<<=1;
+  }
+}
+
+void ChunkGrid::clear()
+{
+  m_chunks.clear();
+  m_firsts.clear();
+  m_counts.clear();
+  m_stats=Stats();
+}
+
+void ChunkGrid::build(float *io_xyz, size_t _count)
+{
+  clear();
+  if(_count == 0)
+  {
+    return;
+  }
+  float min[3];
+  float max[3];
+  std::fill(min,min+3,std::numeric_limits<float>::max());
+  std::fill(max,max+3,std::numeric_limits<float>::lowest());
+  for(size_t i=0; i<_count; ++i)
+  {
+    for(int axis=0; axis<3; ++axis)
+    {
+      min[axis]=std::min(min[axis],io_xyz[i*3+axis]);
+      max[axis]=std::max(max[axis],io_xyz[i*3+axis]);
+    }
+  }
+  float scale[3];
+  for(int axis=0; axis<3; ++axis)
+  {
+    float extent=max[axis]-min[axis];
+    scale[axis]= extent > 0.0f ? m_resolution/extent : 0.0f;
+  }
+  // counting sort on the Morton code of each point's cell
+  size_t cells=static_cast<size_t>(m_resolution)*m_resolution*m_resolution;
+  std::vector<uint32_t> &cellOf=m_cellOf;
+  std::vector<size_t> &start=m_cellStart;
+  cellOf.resize(_count);
+  start.assign(cells+1,0);
+  for(size_t i=0; i<_count; ++i)
+  {
+    uint32_t c[3];
+    for(int axis=0; axis<3; ++axis)
+    {
+      c[axis]=std::min(static_cast<uint32_t>((io_xyz[i*3+axis]-min[axis])*scale[axis]),m_resolution-1);
+    }
+    cellOf[i]=static_cast<uint32_t>(morton::encode(c[0],c[1],c[2]));
+    ++start[cellOf[i]+1];
+  }
+  for(size_t c=0; c<cells; ++c)
+  {
+    start[c+1]+=start[c];
+  }
+  ScratchPool::Block sorted=ScratchPool::instance()->acquire(_count*3*sizeof(float));
+  for(size_t i=0; i<_count; ++i)
+  {
+    // start[c] is used as the next free slot of cell c, it is moved back afterwards
+    size_t slot=start[cellOf[i]]++;
+    std::copy(io_xyz+i*3,io_xyz+i*3+3,sorted.floats()+slot*3);
+  }
+  std::copy(sorted.floats(),sorted.floats()+_count*3,io_xyz);
+  for(size_t c=cells; c>0; --c)
+  {
+    start[c]=start[c-1];
+  }
+  start[0]=0;
+
+  // one chunk per non empty cell
+  for(size_t c=0; c<cells; ++c)
+  {
+    if(start[c+1] != start[c])
+    {
+      addChunk(io_xyz,start[c],start[c+1]-start[c]);
+    }
+  }
+  m_stats.totalChunks=m_chunks.size();
+  m_stats.totalPoints=_count;
+}
+
+void ChunkGrid::build(const float *_xyz, const MortonSort &_sorted)
+{
+  clear();
+  unsigned int bits=0;
+  while((1u<<bits) < m_resolution)
+  {
+    ++bits;
+  }
+  for(auto &range : _sorted.ranges(std::min(bits,_sorted.axisBits())*3))
+  {
+    addChunk(_xyz,range.first,range.count);
+  }
+  m_stats.totalChunks=m_chunks.size();
+  m_stats.totalPoints=_sorted.size();
+}
+
+void ChunkGrid::addChunk(const float *_xyz, size_t _first, size_t _count)
+{
+  Chunk chunk;
+  chunk.first=static_cast<GLint>(_first);
+  chunk.count=static_cast<GLsizei>(_count);
+  const float inf=std::numeric_limits<float>::max();
+  chunk.min.set(inf,inf,inf);
+  chunk.max.set(-inf,-inf,-inf);
+  for(size_t i=_first; i<_first+_count; ++i)
+  {
+    for(int axis=0; axis<3; ++axis)
+    {
+      chunk.min[axis]=std::min(chunk.min[axis],_xyz[i*3+axis]);
+      chunk.max[axis]=std::max(chunk.max[axis],_xyz[i*3+axis]);
+    }
+  }
+  m_chunks.push_back(chunk);
+}
+
+void ChunkGrid::cull(const ngl::Mat4 &_mvp)
+{
+  auto start=std::chrono::steady_clock::now();
+  Frustum frustum(_mvp);
+  m_firsts.clear();
+  m_counts.clear();
+  m_stats.visibleChunks=0;
+  m_stats.visiblePoints=0;
+  for(auto &chunk : m_chunks)
+  {
+    if(!frustum.intersects(chunk.min,chunk.max))
+    {
+      continue;
+    }
+    ++m_stats.visibleChunks;
+    m_stats.visiblePoints+=static_cast<size_t>(chunk.count);
+    // chunks are stored in order so a chunk following the last range just extends it
+    if(!m_firsts.empty() && m_firsts.back()+m_counts.back() == chunk.first)
+    {
+      m_counts.back()+=chunk.count;
+    }
+    else
+    {
+      m_firsts.push_back(chunk.first);
+      m_counts.push_back(chunk.count);
+    }
+  }
+  m_stats.draws=m_firsts.size();
+  m_stats.cullMs=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+void ChunkGrid::draw(GLenum _mode) const
+{
+  if(!m_firsts.empty())
+  {
+    GLState::instance()->multiDrawArrays(_mode,m_firsts.data(),m_counts.data(),static_cast<GLsizei>(m_firsts.size()));
+  }
+}
+
+std::string ChunkGrid::hudLine() const
+{
+  char buffer[256];
+  std::snprintf(buffer,sizeof(buffer),"chunks %zu/%zu, points %zu/%zu (%.1f%%), %zu ranges, cull %.3f ms",
+                m_stats.visibleChunks,m_stats.totalChunks,m_stats.visiblePoints,m_stats.totalPoints,
+                m_stats.totalPoints ? 100.0*m_stats.visiblePoints/m_stats.totalPoints : 0.0,
+                m_stats.draws,m_stats.cullMs);
+  return buffer;
+}
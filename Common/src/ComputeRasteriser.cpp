@@ -0,0 +1,313 @@
+#include "ComputeRasteriser.h"
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include <QOpenGLContext>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+  /// @brief invocations per work group, must match local_size_x
+  const GLuint s_groupSize=256;
+
+  /// @brief PACK64 is defined when the 64 bit atomics are available, MVP and viewport come from FrameData
+  const char *s_rasteriseShader=R"(
+layout(local_size_x=256) in;
+layout(std430,binding=0) readonly buffer Points
+{
+  float xyz[];
+};
+#ifdef PACK64
+layout(std430,binding=1) buffer Target
+{
+  uint64_t target[];
+};
+uniform uint packedColour;
+#else
+layout(std430,binding=1) buffer Target
+{
+  uint target[];
+};
+#endif
+uniform uint first;
+uniform uint count;
+uniform uint stride;
+uniform int pointSize;
+void main()
+{
+  uint i=gl_GlobalInvocationID.x;
+  if(i >= count)
+  {
+    return;
+  }
+  uint p=(first+i)*stride;
+  vec4 clip=MVP*vec4(xyz[p],xyz[p+1u],xyz[p+2u],1.0);
+  // outside the frustum, the near and far planes included
+  if(clip.w <= 0.0 || any(greaterThan(abs(clip.xyz),vec3(clip.w))))
+  {
+    return;
+  }
+  vec3 ndc=clip.xyz/clip.w;
+  ivec2 size=ivec2(viewport.zw);
+  // like GL_POINTS the square covers the pixels whose centres are inside it
+  vec2 window=(ndc.xy*0.5+0.5)*vec2(size);
+  ivec2 lo=ivec2(ceil(window-vec2(0.5*float(pointSize)+0.5)));
+  ivec2 hi=min(lo+ivec2(pointSize),size);
+  lo=max(lo,ivec2(0));
+  // positive floats order the same as their bits so the window z can be compared as an integer
+  uint depth=floatBitsToUint(ndc.z*0.5+0.5);
+#ifdef PACK64
+  uint64_t value=(uint64_t(depth) << 32) | uint64_t(packedColour);
+#else
+  uint value=depth;
+#endif
+  for(int y=lo.y; y<hi.y; ++y)
+  {
+    for(int x=lo.x; x<hi.x; ++x)
+    {
+      atomicMin(target[y*size.x+x],value);
+    }
+  }
+}
+)";
+
+  /// @brief a triangle covering the screen made from gl_VertexID
+  const char *s_resolveVertexShader=R"(#version 430 core
+void main()
+{
+  vec2 p=vec2((gl_VertexID << 1) & 2,gl_VertexID & 2);
+  gl_Position=vec4(p*2.0-1.0,0.0,1.0);
+}
+)";
+
+  /// @brief the 64 bit values are read as uvec2, x is the low (colour) word
+  const char *s_resolveFragmentShader=R"(
+#ifdef PACK64
+layout(std430,binding=1) readonly buffer Target
+{
+  uvec2 target[];
+};
+#else
+layout(std430,binding=1) readonly buffer Target
+{
+  uint target[];
+};
+uniform vec4 Colour;
+#endif
+layout (location=0) out vec4 fragColour;
+void main()
+{
+  ivec2 pixel=ivec2(gl_FragCoord.xy);
+  uint index=uint(pixel.y*int(viewport.z)+pixel.x);
+#ifdef PACK64
+  uint depth=target[index].y;
+  vec4 colour=unpackUnorm4x8(target[index].x);
+#else
+  uint depth=target[index];
+  vec4 colour=Colour;
+#endif
+  if(depth == 0xFFFFFFFFu)
+  {
+    discard;
+  }
+  gl_FragDepth=uintBitsToFloat(depth);
+  fragColour=colour;
+}
+)";
+
+  /// @brief put the #version, any extensions, the FrameData block and the packing define in front of a body,
+  /// the extensions have to come before anything else so withBlock can't be used
+  std::string source(ComputeRasteriser::Packing _packing, const char *_body)
+  {
+    if(_packing == ComputeRasteriser::Packing::DepthColour64)
+    {
+      return std::string("#version 430 core\n"
+                         "#extension GL_ARB_gpu_shader_int64 : require\n"
+                         "#extension GL_NV_shader_atomic_int64 : require\n")+
+             FrameUniforms::blockSource()+"#define PACK64\n"+_body;
+    }
+    return std::string("#version 430 core\n")+FrameUniforms::blockSource()+_body;
+  }
+
+  /// @brief get a program for this context from the ProgramCache, the ids are shared by every rasteriser
+  GLuint program(const std::string &_name, const std::string &_first, ngl::ShaderType _firstType,
+                 const std::string &_second=std::string())
+  {
+    std::vector<ProgramCache::Stage> stages={{_firstType,_first}};
+    if(!_second.empty())
+    {
+      stages.push_back({ngl::ShaderType::FRAGMENT,_second});
+    }
+    return ProgramCache::instance()->program(_name,stages,FrameUniforms::attach);
+  }
+}
+
+bool ComputeRasteriser::isSupported()
+{
+  QOpenGLContext *context=QOpenGLContext::currentContext();
+  if(context == nullptr)
+  {
+    return false;
+  }
+  return context->format().version() >= qMakePair(4,3) ||
+         (context->hasExtension("GL_ARB_compute_shader") && context->hasExtension("GL_ARB_shader_storage_buffer_object"));
+}
+
+ComputeRasteriser::ComputeRasteriser(int _pointSize)
+{
+  setPointSize(_pointSize);
+}
+
+ComputeRasteriser::~ComputeRasteriser()
+{
+  release();
+}
+
+void ComputeRasteriser::setPointSize(int _pointSize)
+{
+  m_pointSize=std::max(1,std::min(_pointSize,64));
+}
+
+void ComputeRasteriser::setColour(float _r, float _g, float _b, float _a)
+{
+  m_rgba[0]=_r;
+  m_rgba[1]=_g;
+  m_rgba[2]=_b;
+  m_rgba[3]=_a;
+  // the same layout as GLSL packUnorm4x8, r in the low byte
+  m_colour=0;
+  for(int c=3; c>=0; --c)
+  {
+    float v=std::max(0.0f,std::min(m_rgba[c],1.0f));
+    m_colour=(m_colour << 8) | static_cast<GLuint>(v*255.0f+0.5f);
+  }
+}
+
+void ComputeRasteriser::createShaders()
+{
+  QOpenGLContext *context=QOpenGLContext::currentContext();
+  bool atomic64=context != nullptr && context->hasExtension("GL_ARB_gpu_shader_int64") &&
+                context->hasExtension("GL_NV_shader_atomic_int64");
+  m_packing= atomic64 ? Packing::DepthColour64 : Packing::Depth32;
+  std::string suffix= atomic64 ? "64" : "32";
+  m_rasteriseProgram=program("ComputeRasterise"+suffix,source(m_packing,s_rasteriseShader),ngl::ShaderType::COMPUTE);
+  m_resolveProgram=program("ComputeResolve"+suffix,s_resolveVertexShader,ngl::ShaderType::VERTEX,
+                           source(m_packing,s_resolveFragmentShader));
+  m_firstLocation=glGetUniformLocation(m_rasteriseProgram,"first");
+  m_countLocation=glGetUniformLocation(m_rasteriseProgram,"count");
+  m_strideLocation=glGetUniformLocation(m_rasteriseProgram,"stride");
+  m_pointSizeLocation=glGetUniformLocation(m_rasteriseProgram,"pointSize");
+  m_packedColourLocation=glGetUniformLocation(m_rasteriseProgram,"packedColour");
+  m_colourLocation=glGetUniformLocation(m_resolveProgram,"Colour");
+}
+
+size_t ComputeRasteriser::targetBytes() const
+{
+  size_t bytes= m_packing == Packing::DepthColour64 ? 8 : 4;
+  return static_cast<size_t>(m_width)*static_cast<size_t>(m_height)*bytes;
+}
+
+void ComputeRasteriser::begin(int _width, int _height)
+{
+  if(m_rasteriseProgram == 0)
+  {
+    createShaders();
+    glGenVertexArrays(1,&m_vao);
+  }
+  if(m_target == 0 || _width != m_width || _height != m_height)
+  {
+    if(m_target == 0)
+    {
+      glGenBuffers(1,&m_target);
+    }
+    m_width=std::max(_width,1);
+    m_height=std::max(_height,1);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER,m_target);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,static_cast<GLsizeiptr>(targetBytes()),nullptr,GL_DYNAMIC_COPY);
+  }
+  // every word set to all ones is the far plane for both packings
+  const GLuint clear=0xFFFFFFFFu;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER,m_target);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER,GL_R32UI,GL_RED_INTEGER,GL_UNSIGNED_INT,&clear);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER,0);
+}
+
+void ComputeRasteriser::rasterise(GLuint _buffer, size_t _first, size_t _count, unsigned int _stride)
+{
+  if(_count == 0 || m_target == 0)
+  {
+    return;
+  }
+  GLState::instance()->useProgram(m_rasteriseProgram);
+  glUniform1ui(m_strideLocation,_stride);
+  glUniform1i(m_pointSizeLocation,m_pointSize);
+  if(m_packing == Packing::DepthColour64)
+  {
+    glUniform1ui(m_packedColourLocation,m_colour);
+  }
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,0,_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,1,m_target);
+  // one dispatch can only have so many groups so large clouds are split
+  GLint maxGroups=65535;
+  glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT,0,&maxGroups);
+  size_t batch=static_cast<size_t>(maxGroups)*s_groupSize;
+  for(size_t start=0; start<_count; start+=batch)
+  {
+    size_t count=std::min(batch,_count-start);
+    glUniform1ui(m_firstLocation,static_cast<GLuint>(_first+start));
+    glUniform1ui(m_countLocation,static_cast<GLuint>(count));
+    glDispatchCompute(static_cast<GLuint>((count+s_groupSize-1)/s_groupSize),1,1);
+  }
+}
+
+void ComputeRasteriser::resolve()
+{
+  if(m_target == 0)
+  {
+    return;
+  }
+  // the atomics have to land before the fragment shader reads them
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  GLState *state=GLState::instance();
+  state->useProgram(m_resolveProgram);
+  if(m_packing == Packing::Depth32)
+  {
+    glUniform4f(m_colourLocation,m_rgba[0],m_rgba[1],m_rgba[2],m_rgba[3]);
+  }
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,1,m_target);
+  state->bindVertexArray(m_vao);
+  state->drawArrays(GL_TRIANGLES,0,3);
+  state->unbindVertexArray();
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,0,0);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,1,0);
+}
+
+void ComputeRasteriser::release()
+{
+  if(m_target != 0)
+  {
+    GLState::instance()->deleteBuffers(1,&m_target);
+    m_target=0;
+  }
+  if(m_vao != 0)
+  {
+    GLState::instance()->deleteVertexArrays(1,&m_vao);
+    m_vao=0;
+  }
+  m_width=0;
+  m_height=0;
+  // the programs are shared so are kept, the next begin looks them up again
+  m_rasteriseProgram=0;
+  m_resolveProgram=0;
+}
+
+std::string ComputeRasteriser::hudLine() const
+{
+  char buffer[128];
+  std::snprintf(buffer,sizeof(buffer),"compute raster %s, %d px points, target %.2f MB",
+                m_packing == Packing::DepthColour64 ? "64 bit depth+colour" : "32 bit depth",
+                m_pointSize,targetBytes()/(1024.0*1024.0));
+  return buffer;
+}
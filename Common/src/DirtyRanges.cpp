@@ -0,0 +1,81 @@
+#include "DirtyRanges.h"
+#include <algorithm>
+
+void DirtyRanges::mark(size_t _offset, size_t _bytes)
+{
+  if(_bytes == 0)
+  {
+    return;
+  }
+  m_marks.push_back({_offset,_bytes});
+  // the same points marked tick after tick without a flush would grow without limit
+  if(m_marks.size() >= m_compactAt)
+  {
+    compact();
+    m_compactAt=std::max<size_t>(s_minCompact,m_marks.size()*2);
+  }
+}
+
+void DirtyRanges::compact()
+{
+  std::sort(m_marks.begin(),m_marks.end(),[](const Range &_a, const Range &_b){return _a.offset < _b.offset;});
+  // merge only what overlaps or touches so the changed bytes are still exact
+  size_t merged=0;
+  for(size_t i=1; i<m_marks.size(); ++i)
+  {
+    Range &last=m_marks[merged];
+    if(m_marks[i].offset <= last.offset+last.bytes)
+    {
+      last.bytes=std::max(last.offset+last.bytes,m_marks[i].offset+m_marks[i].bytes)-last.offset;
+    }
+    else
+    {
+      m_marks[++merged]=m_marks[i];
+    }
+  }
+  m_marks.resize(m_marks.empty() ? 0 : merged+1);
+}
+
+const std::vector<DirtyRanges::Range> &DirtyRanges::coalesce()
+{
+  compact();
+  m_ranges.clear();
+  m_changedBytes=0;
+  m_rangeBytes=0;
+  for(const auto &m : m_marks)
+  {
+    m_changedBytes+=m.bytes;
+    if(!m_ranges.empty() && m.offset <= m_ranges.back().offset+m_ranges.back().bytes+m_gap)
+    {
+      // the marks are sorted and apart so this one always ends past the last range
+      m_ranges.back().bytes=m.offset+m.bytes-m_ranges.back().offset;
+    }
+    else
+    {
+      m_ranges.push_back(m);
+    }
+  }
+  for(const auto &r : m_ranges)
+  {
+    m_rangeBytes+=r.bytes;
+  }
+  return m_ranges;
+}
+
+void DirtyRanges::flushed()
+{
+  ++m_stats.flushes;
+  m_stats.ranges+=m_ranges.size();
+  m_stats.changedBytes+=m_changedBytes;
+  m_stats.uploadedBytes+=m_rangeBytes;
+  clear();
+}
+
+void DirtyRanges::clear()
+{
+  m_marks.clear();
+  m_compactAt=s_minCompact;
+  m_ranges.clear();
+  m_changedBytes=0;
+  m_rangeBytes=0;
+}
@@ -0,0 +1,259 @@
+#include "FrameCapture.h"
+#include "ScratchPool.h"
+#include "ThreadPool.h"
+#include <QImage>
+#include <QOpenGLContext>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+  /// @brief split a pattern around its %d, %% is a literal %
+  /// @returns false unless there is exactly one %d, optionally with a width like %04d
+  bool splitPattern(const std::string &_pattern, std::string &o_prefix, std::string &o_suffix, size_t &o_width, char &o_pad)
+  {
+    o_prefix.clear();
+    o_suffix.clear();
+    o_width=0;
+    o_pad=' ';
+    bool found=false;
+    for(size_t i=0; i<_pattern.size(); ++i)
+    {
+      std::string &out= found ? o_suffix : o_prefix;
+      if(_pattern[i] != '%')
+      {
+        out+=_pattern[i];
+        continue;
+      }
+      if(++i == _pattern.size())
+      {
+        return false;
+      }
+      if(_pattern[i] == '%')
+      {
+        out+='%';
+        continue;
+      }
+      if(found)
+      {
+        return false;
+      }
+      if(_pattern[i] == '0')
+      {
+        o_pad='0';
+        ++i;
+      }
+      while(i < _pattern.size() && _pattern[i] >= '0' && _pattern[i] <= '9')
+      {
+        o_width=o_width*10+static_cast<size_t>(_pattern[i++]-'0');
+      }
+      if(i == _pattern.size() || _pattern[i] != 'd' || o_width > 32)
+      {
+        return false;
+      }
+      found=true;
+    }
+    return found;
+  }
+
+  /// @brief fences need GL 3.2 or ARB_sync
+  bool hasSync()
+  {
+    QOpenGLContext *context=QOpenGLContext::currentContext();
+    if(context == nullptr)
+    {
+      return false;
+    }
+    return context->format().version() >= qMakePair(3,2) || context->hasExtension("GL_ARB_sync");
+  }
+}
+
+FrameCapture::FrameCapture(int _width, int _height, const std::string &_pattern, unsigned int _numPBOs) :
+  m_width(_width), m_height(_height), m_pattern(_pattern), m_slots(std::max(_numPBOs,1u))
+{
+  // a couple of frames per worker keeps them all busy without holding many frames in memory
+  m_maxEncoding=2*ThreadPool::instance()->numThreads();
+}
+
+FrameCapture::~FrameCapture()
+{
+  // the workers use our members so must be done before we go
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_encoded.wait(lock,[this]{return m_encoding == 0;});
+}
+
+bool FrameCapture::isValidPattern(const std::string &_pattern)
+{
+  std::string prefix;
+  std::string suffix;
+  size_t width;
+  char pad;
+  return splitPattern(_pattern,prefix,suffix,width,pad);
+}
+
+std::string FrameCapture::fileName(const std::string &_pattern, unsigned int _frame)
+{
+  std::string prefix;
+  std::string suffix;
+  size_t width;
+  char pad;
+  if(!splitPattern(_pattern,prefix,suffix,width,pad))
+  {
+    // still give every frame its own file
+    return _pattern+"."+std::to_string(_frame);
+  }
+  std::string number=std::to_string(_frame);
+  if(number.size() < width)
+  {
+    number.insert(0,width-number.size(),pad);
+  }
+  return prefix+number+suffix;
+}
+
+FrameCapture::Stats FrameCapture::stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void FrameCapture::create()
+{
+  m_hasSync=hasSync();
+  for(auto &slot : m_slots)
+  {
+    glGenBuffers(1,&slot.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER,static_cast<GLsizeiptr>(m_width)*m_height*4,nullptr,GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER,0);
+  m_next=0;
+}
+
+void FrameCapture::capture(unsigned int _frame)
+{
+  if(m_slots[0].pbo == 0)
+  {
+    create();
+  }
+  Slot &slot=m_slots[m_next];
+  // the ring has come round, this is the oldest frame so its copy has had the longest to finish
+  if(slot.pending)
+  {
+    collect(slot);
+  }
+  // with a pack buffer bound the pixels go into it on the GPU and glReadPixels doesn't wait
+  glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.pbo);
+  glPixelStorei(GL_PACK_ALIGNMENT,4);
+  glReadPixels(0,0,m_width,m_height,GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER,0);
+  if(m_hasSync)
+  {
+    slot.fence=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+  }
+  slot.frame=_frame;
+  slot.pending=true;
+  m_next=(m_next+1)%m_slots.size();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_stats.captured;
+}
+
+void FrameCapture::collect(Slot &io_slot)
+{
+  if(io_slot.fence != nullptr)
+  {
+    GLenum status=glClientWaitSync(io_slot.fence,0,0);
+    if(status == GL_TIMEOUT_EXPIRED)
+    {
+      auto start=std::chrono::steady_clock::now();
+      do
+      {
+        status=glClientWaitSync(io_slot.fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000);
+      } while(status == GL_TIMEOUT_EXPIRED);
+      std::lock_guard<std::mutex> lock(m_mutex);
+      ++m_stats.readbackWaits;
+      m_stats.readbackWaitMs+=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+    }
+    glDeleteSync(io_slot.fence);
+    io_slot.fence=nullptr;
+  }
+  io_slot.pending=false;
+  {
+    // hold the render loop back rather than queue frames faster than they can be written
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_encoding >= m_maxEncoding)
+    {
+      ++m_stats.encodeWaits;
+      m_encoded.wait(lock,[this]{return m_encoding < m_maxEncoding;});
+    }
+    ++m_encoding;
+  }
+  // copy out so the PBO can be unmapped and reused straight away, the block goes back to the pool once written
+  size_t bytes=static_cast<size_t>(m_width)*m_height*4;
+  std::shared_ptr<ScratchPool::Block> block=std::make_shared<ScratchPool::Block>(ScratchPool::instance()->acquire(bytes));
+  glBindBuffer(GL_PIXEL_PACK_BUFFER,io_slot.pbo);
+  void *pixels=glMapBuffer(GL_PIXEL_PACK_BUFFER,GL_READ_ONLY);
+  bool mapped= pixels != nullptr;
+  if(mapped)
+  {
+    std::memcpy(block->data(),pixels,bytes);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER,0);
+  if(!mapped)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.failed;
+    --m_encoding;
+    m_encoded.notify_all();
+    return;
+  }
+  unsigned int frame=io_slot.frame;
+  ThreadPool::instance()->submit([this,block,frame]
+  {
+    encode(static_cast<const unsigned char *>(block->data()),frame);
+  });
+}
+
+void FrameCapture::encode(const unsigned char *_pixels, unsigned int _frame)
+{
+  auto start=std::chrono::steady_clock::now();
+  // GL rows start at the bottom
+  QImage image(_pixels,m_width,m_height,m_width*4,QImage::Format_RGBA8888);
+  bool saved=image.mirrored().save(QString::fromStdString(fileName(m_pattern,_frame)));
+  double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(saved)
+  {
+    ++m_stats.written;
+  }
+  else
+  {
+    ++m_stats.failed;
+  }
+  m_stats.encodeMs+=ms;
+  --m_encoding;
+  m_encoded.notify_all();
+}
+
+bool FrameCapture::finish()
+{
+  if(m_slots[0].pbo != 0)
+  {
+    // oldest first, m_next is the slot written longest ago
+    for(size_t i=0; i<m_slots.size(); ++i)
+    {
+      Slot &slot=m_slots[(m_next+i)%m_slots.size()];
+      if(slot.pending)
+      {
+        collect(slot);
+      }
+      glDeleteBuffers(1,&slot.pbo);
+      slot.pbo=0;
+    }
+  }
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_encoded.wait(lock,[this]{return m_encoding == 0;});
+  return m_stats.failed == 0;
+}
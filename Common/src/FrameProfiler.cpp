@@ -0,0 +1,258 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+RollingHistogram::RollingHistogram(size_t _size) : m_samples(std::max<size_t>(_size,1),0.0)
+{
+}
+
+void RollingHistogram::add(double _ms)
+{
+  m_samples[m_next]=_ms;
+  if(++m_next == m_samples.size())
+  {
+    m_next=0;
+    m_full=true;
+  }
+}
+
+double RollingHistogram::last() const
+{
+  if(size() == 0)
+  {
+    return 0.0;
+  }
+  return m_samples[(m_next+m_samples.size()-1)%m_samples.size()];
+}
+
+std::vector<double> RollingHistogram::samples() const
+{
+  std::vector<double> s;
+  s.reserve(size());
+  if(m_full)
+  {
+    s.insert(s.end(),m_samples.begin()+m_next,m_samples.end());
+  }
+  s.insert(s.end(),m_samples.begin(),m_samples.begin()+m_next);
+  return s;
+}
+
+double RollingHistogram::mean() const
+{
+  if(size() == 0)
+  {
+    return 0.0;
+  }
+  auto end=m_full ? m_samples.end() : m_samples.begin()+m_next;
+  return std::accumulate(m_samples.begin(),end,0.0)/size();
+}
+
+double RollingHistogram::percentile(double _p) const
+{
+  std::vector<double> s=samples();
+  if(s.empty())
+  {
+    return 0.0;
+  }
+  size_t index=std::min(s.size()-1,static_cast<size_t>((_p/100.0)*(s.size()-1)+0.5));
+  std::nth_element(s.begin(),s.begin()+index,s.end());
+  return s[index];
+}
+
+std::vector<unsigned int> RollingHistogram::bucket(size_t _bins, double _binWidth) const
+{
+  std::vector<unsigned int> bins(_bins,0);
+  for(double v : samples())
+  {
+    size_t b=std::min(_bins-1,static_cast<size_t>(std::max(0.0,v)/_binWidth));
+    ++bins[b];
+  }
+  return bins;
+}
+
+FrameProfiler::FrameProfiler(const std::vector<std::string> &_phases, size_t _history) :
+  m_phases(_phases),
+  m_cpu(_history),
+  m_gpu(_history),
+  m_phaseTimes(_phases.size(),RollingHistogram(_history))
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+  if(m_initialized)
+  {
+    for(auto &set : m_queries)
+    {
+      glDeleteQueries(static_cast<GLsizei>(set.size()),set.data());
+    }
+  }
+}
+
+void FrameProfiler::initialize()
+{
+  for(size_t i=0; i<s_querySets; ++i)
+  {
+    m_queries[i].resize(m_phases.size());
+    m_issued[i].assign(m_phases.size(),false);
+    glGenQueries(static_cast<GLsizei>(m_phases.size()),m_queries[i].data());
+  }
+  m_initialized=true;
+}
+
+void FrameProfiler::beginFrame()
+{
+  m_frameStart=std::chrono::steady_clock::now();
+  if(!m_initialized)
+  {
+    return;
+  }
+  // move to the set we used last frame but one, its results should be ready by now
+  m_set=(m_set+1)%s_querySets;
+  auto &queries=m_queries[m_set];
+  auto &issued=m_issued[m_set];
+  bool any=false;
+  bool ready=true;
+  for(size_t i=0; i<queries.size() && ready; ++i)
+  {
+    if(issued[i])
+    {
+      any=true;
+      GLint available=GL_FALSE;
+      glGetQueryObjectiv(queries[i],GL_QUERY_RESULT_AVAILABLE,&available);
+      ready= available == GL_TRUE;
+    }
+  }
+  if(any && !ready)
+  {
+    // never wait for the GPU, just lose this sample
+    ++m_dropped;
+  }
+  else if(any)
+  {
+    double total=0.0;
+    for(size_t i=0; i<queries.size(); ++i)
+    {
+      if(issued[i])
+      {
+        GLuint64 ns=0;
+        glGetQueryObjectui64v(queries[i],GL_QUERY_RESULT,&ns);
+        double ms=ns/1.0e6;
+        m_phaseTimes[i].add(ms);
+        total+=ms;
+      }
+    }
+    m_gpu.add(total);
+  }
+  std::fill(issued.begin(),issued.end(),false);
+}
+
+void FrameProfiler::endFrame()
+{
+  auto end=std::chrono::steady_clock::now();
+  m_cpu.add(std::chrono::duration<double,std::milli>(end-m_frameStart).count());
+}
+
+void FrameProfiler::beginPhase(size_t _phase)
+{
+  if(m_initialized)
+  {
+    glBeginQuery(GL_TIME_ELAPSED,m_queries[m_set][_phase]);
+  }
+}
+
+void FrameProfiler::endPhase(size_t _phase)
+{
+  if(m_initialized)
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+    m_issued[m_set][_phase]=true;
+  }
+}
+
+std::vector<std::string> FrameProfiler::hudLines() const
+{
+  std::vector<std::string> lines;
+  char buffer[256];
+  std::snprintf(buffer,sizeof(buffer),"CPU %6.2f ms  mean %6.2f  p99 %6.2f",m_cpu.last(),m_cpu.mean(),m_cpu.percentile(99.0));
+  lines.push_back(buffer);
+  std::snprintf(buffer,sizeof(buffer),"GPU %6.2f ms  mean %6.2f  p99 %6.2f",m_gpu.last(),m_gpu.mean(),m_gpu.percentile(99.0));
+  lines.push_back(buffer);
+  for(size_t i=0; i<m_phases.size(); ++i)
+  {
+    std::snprintf(buffer,sizeof(buffer),"  %-8s %6.3f ms",m_phases[i].c_str(),m_phaseTimes[i].mean());
+    lines.push_back(buffer);
+  }
+  // text histogram, only show up to the last non empty bucket
+  std::vector<unsigned int> cpu=m_cpu.bucket(s_bins,s_binWidth);
+  std::vector<unsigned int> gpu=m_gpu.bucket(s_bins,s_binWidth);
+  size_t used=0;
+  unsigned int largest=1;
+  for(size_t b=0; b<s_bins; ++b)
+  {
+    if(cpu[b] || gpu[b])
+    {
+      used=b+1;
+    }
+    largest=std::max(largest,std::max(cpu[b],gpu[b]));
+  }
+  const unsigned int width=20;
+  for(size_t b=0; b<used; ++b)
+  {
+    std::string cpuBar(cpu[b]*width/largest,'#');
+    std::string gpuBar(gpu[b]*width/largest,'#');
+    if(b+1 == s_bins)
+    {
+      std::snprintf(buffer,sizeof(buffer),">%3.0f ms C %-20s G %s",b*s_binWidth,cpuBar.c_str(),gpuBar.c_str());
+    }
+    else
+    {
+      std::snprintf(buffer,sizeof(buffer),"%3.0f ms C %-20s G %s",b*s_binWidth,cpuBar.c_str(),gpuBar.c_str());
+    }
+    lines.push_back(buffer);
+  }
+  return lines;
+}
+
+bool FrameProfiler::dump(const std::string &_fname) const
+{
+  std::ofstream file(_fname);
+  if(!file.is_open())
+  {
+    std::cerr<<"unable to open "<<_fname<<" for writing\n";
+    return false;
+  }
+  file<<"# series,samples,mean_ms,p50_ms,p90_ms,p99_ms\n";
+  auto summary=[&file](const std::string &_name, const RollingHistogram &_h)
+  {
+    file<<"# "<<_name<<','<<_h.size()<<','<<_h.mean()<<','<<_h.percentile(50.0)<<','
+        <<_h.percentile(90.0)<<','<<_h.percentile(99.0)<<'\n';
+  };
+  summary("cpu",m_cpu);
+  summary("gpu",m_gpu);
+  for(size_t i=0; i<m_phases.size(); ++i)
+  {
+    summary("gpu_"+m_phases[i],m_phaseTimes[i]);
+  }
+  file<<"# gpu results dropped because they were not ready "<<m_dropped<<'\n';
+  file<<"bin_start_ms,bin_end_ms,cpu_count,gpu_count\n";
+  std::vector<unsigned int> cpu=m_cpu.bucket(s_bins,s_binWidth);
+  std::vector<unsigned int> gpu=m_gpu.bucket(s_bins,s_binWidth);
+  for(size_t b=0; b<s_bins; ++b)
+  {
+    file<<b*s_binWidth<<',';
+    if(b+1 == s_bins)
+    {
+      file<<"inf";
+    }
+    else
+    {
+      file<<(b+1)*s_binWidth;
+    }
+    file<<','<<cpu[b]<<','<<gpu[b]<<'\n';
+  }
+  return true;
+}
@@ -0,0 +1,143 @@
+#include "FrameScheduler.h"
+#include "Trace.h"
+#include <QOpenGLWindow>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+  /// @brief the longest step tick will return, stops the animation jumping after a stall
+  constexpr double s_maxDelta=0.1;
+}
+
+FrameScheduler::FrameScheduler(QOpenGLWindow *_window) : m_window(_window)
+{
+  m_timer.setSingleShot(true);
+  m_timer.setTimerType(Qt::PreciseTimer);
+  QObject::connect(&m_timer,&QTimer::timeout,[this]{m_window->update();});
+  m_clock.start();
+}
+
+void FrameScheduler::configureFormat(QSurfaceFormat &io_format, Mode _mode)
+{
+  // only vsync wants the swap to wait, the others pace themselves
+  io_format.setSwapInterval(_mode == Mode::VSync ? 1 : 0);
+}
+
+bool FrameScheduler::parseMode(const QString &_mode, Mode &o_mode, double &o_fps)
+{
+  QString mode=_mode.toLower();
+  if(mode == "vsync")
+  {
+    o_mode=Mode::VSync;
+    return true;
+  }
+  if(mode == "unthrottled")
+  {
+    o_mode=Mode::Unthrottled;
+    return true;
+  }
+  if(mode == "paused")
+  {
+    o_mode=Mode::Paused;
+    return true;
+  }
+  bool ok=false;
+  double fps=mode.toDouble(&ok);
+  // also rejects nan and infinity
+  if(!ok || !(fps > 0.0 && fps < std::numeric_limits<double>::infinity()))
+  {
+    return false;
+  }
+  o_mode=Mode::FixedRate;
+  o_fps=fps;
+  return true;
+}
+
+const char *FrameScheduler::modeName(Mode _mode)
+{
+  switch(_mode)
+  {
+    case Mode::Unthrottled : return "unthrottled";
+    case Mode::VSync : return "vsync";
+    case Mode::FixedRate : return "fixed rate";
+    case Mode::Paused : return "paused";
+  }
+  return "unknown";
+}
+
+void FrameScheduler::setMode(Mode _mode, double _fps)
+{
+  if(_fps > 0.0)
+  {
+    m_period=static_cast<qint64>(1.0e9/_fps);
+  }
+  if(_mode != Mode::Paused)
+  {
+    m_resumeMode=_mode;
+  }
+  bool wasPaused=isPaused();
+  m_mode=_mode;
+  if(isPaused())
+  {
+    m_timer.stop();
+  }
+  else if(wasPaused)
+  {
+    // restart the clock so the time spent paused isn't seen as one long frame
+    m_lastTick=-1;
+    m_window->update();
+  }
+}
+
+void FrameScheduler::togglePause()
+{
+  setMode(isPaused() ? m_resumeMode : Mode::Paused);
+}
+
+void FrameScheduler::start()
+{
+  QObject::connect(m_window,&QOpenGLWindow::frameSwapped,&m_timer,[this]{frameSwapped();});
+  m_window->update();
+}
+
+double FrameScheduler::tick()
+{
+  qint64 now=m_clock.nsecsElapsed();
+  m_frameStart=now;
+  m_traceStart=Trace::now();
+  if(m_fixedStep > 0.0)
+  {
+    m_lastTick=now;
+    return m_fixedStep;
+  }
+  if(isPaused() || m_lastTick < 0)
+  {
+    m_lastTick=now;
+    return 0.0;
+  }
+  double delta=(now-m_lastTick)/1.0e9;
+  m_lastTick=now;
+  return std::min(delta,s_maxDelta);
+}
+
+void FrameScheduler::frameSwapped()
+{
+  Trace::record("frame",m_traceStart,Trace::now());
+  switch(m_mode)
+  {
+    case Mode::Unthrottled :
+    case Mode::VSync :
+      m_window->update();
+    break;
+    case Mode::FixedRate :
+    {
+      // wait for whatever is left of this frame's period
+      qint64 remaining=m_period-(m_clock.nsecsElapsed()-m_frameStart);
+      m_timer.start(static_cast<int>(std::max<qint64>(0,remaining/1000000)));
+    }
+    break;
+    case Mode::Paused :
+    break;
+  }
+}
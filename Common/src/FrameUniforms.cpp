@@ -0,0 +1,170 @@
+#include "FrameUniforms.h"
+#include <QOpenGLContext>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  const char *s_blockSource=R"(
+layout(std140) uniform FrameData
+{
+  mat4 view;
+  mat4 projection;
+  mat4 MVP;
+  vec4 viewport;
+  float time;
+  float dt;
+};
+)";
+
+  /// @brief immutable storage is needed to keep the buffer mapped
+  bool hasBufferStorage()
+  {
+    QOpenGLContext *context=QOpenGLContext::currentContext();
+    if(context == nullptr)
+    {
+      return false;
+    }
+    return context->format().version() >= qMakePair(4,4) || context->hasExtension("GL_ARB_buffer_storage");
+  }
+}
+
+constexpr GLuint FrameUniforms::BindingPoint;
+
+FrameUniforms::FrameUniforms(unsigned int _regions) : m_numRegions(std::max(_regions,1u))
+{
+  std::memset(&m_block,0,sizeof(Block));
+}
+
+FrameUniforms::~FrameUniforms()
+{
+  release();
+}
+
+const char *FrameUniforms::blockSource()
+{
+  return s_blockSource;
+}
+
+std::string FrameUniforms::withBlock(const std::string &_source)
+{
+  size_t version=_source.find("#version");
+  size_t line= version == std::string::npos ? 0 : _source.find('\n',version);
+  if(line == std::string::npos)
+  {
+    return _source+"\n"+s_blockSource;
+  }
+  // the block starts with a new line so goes after the end of the #version line
+  return _source.substr(0,line)+s_blockSource+_source.substr(line+1);
+}
+
+void FrameUniforms::attach(GLuint _program)
+{
+  GLuint index=glGetUniformBlockIndex(_program,"FrameData");
+  if(index != GL_INVALID_INDEX)
+  {
+    glUniformBlockBinding(_program,index,BindingPoint);
+  }
+}
+
+void FrameUniforms::create()
+{
+  GLint alignment=256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+  alignment=std::max(alignment,1);
+  m_regionSize=(sizeof(Block)+alignment-1)/alignment*alignment;
+  m_fences.assign(m_numRegions,nullptr);
+  glGenBuffers(1,&m_buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER,m_buffer);
+  GLsizeiptr size=static_cast<GLsizeiptr>(m_regionSize*m_numRegions);
+  if(hasBufferStorage())
+  {
+    const GLbitfield flags=GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_UNIFORM_BUFFER,size,nullptr,flags);
+    m_mapped=static_cast<char *>(glMapBufferRange(GL_UNIFORM_BUFFER,0,size,flags));
+  }
+  else
+  {
+    glBufferData(GL_UNIFORM_BUFFER,size,nullptr,GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER,0);
+}
+
+void FrameUniforms::update(const ngl::Mat4 &_view, const ngl::Mat4 &_projection, const ngl::Mat4 &_MVP, int _width, int _height,
+                           float _time, float _dt)
+{
+  if(m_buffer == 0)
+  {
+    create();
+  }
+  std::memcpy(m_block.view,_view.m_openGL,sizeof(m_block.view));
+  std::memcpy(m_block.projection,_projection.m_openGL,sizeof(m_block.projection));
+  std::memcpy(m_block.MVP,_MVP.m_openGL,sizeof(m_block.MVP));
+  m_block.viewport[0]=0.0f;
+  m_block.viewport[1]=0.0f;
+  m_block.viewport[2]=static_cast<float>(_width);
+  m_block.viewport[3]=static_cast<float>(_height);
+  m_block.time=_time;
+  m_block.dt=_dt;
+  ++m_writes;
+  m_region=(m_region+1)%m_numRegions;
+  GLintptr offset=static_cast<GLintptr>(m_region*m_regionSize);
+  if(m_mapped != nullptr)
+  {
+    GLsync &fence=m_fences[m_region];
+    if(fence != nullptr)
+    {
+      // only wait if the GPU is still reading a frame m_numRegions back
+      GLenum status=glClientWaitSync(fence,0,0);
+      if(status == GL_TIMEOUT_EXPIRED)
+      {
+        ++m_fenceWaits;
+        do
+        {
+          status=glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000);
+        } while(status == GL_TIMEOUT_EXPIRED);
+      }
+      glDeleteSync(fence);
+      fence=nullptr;
+    }
+    std::memcpy(m_mapped+offset,&m_block,sizeof(Block));
+  }
+  else
+  {
+    glBindBuffer(GL_UNIFORM_BUFFER,m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER,offset,sizeof(Block),&m_block);
+  }
+  glBindBufferRange(GL_UNIFORM_BUFFER,BindingPoint,m_buffer,offset,sizeof(Block));
+}
+
+void FrameUniforms::endFrame()
+{
+  if(m_mapped != nullptr && m_fences[m_region] == nullptr)
+  {
+    m_fences[m_region]=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+  }
+}
+
+void FrameUniforms::release()
+{
+  for(auto &fence : m_fences)
+  {
+    if(fence != nullptr)
+    {
+      glDeleteSync(fence);
+    }
+  }
+  m_fences.clear();
+  if(m_buffer != 0)
+  {
+    if(m_mapped != nullptr)
+    {
+      glBindBuffer(GL_UNIFORM_BUFFER,m_buffer);
+      glUnmapBuffer(GL_UNIFORM_BUFFER);
+      glBindBuffer(GL_UNIFORM_BUFFER,0);
+    }
+    glDeleteBuffers(1,&m_buffer);
+  }
+  m_buffer=0;
+  m_mapped=nullptr;
+}
@@ -0,0 +1,38 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const ngl::Mat4 &_mvp)
+{
+  // m_openGL is column major so row r of the matrix is m_openGL[r], [4+r], [8+r], [12+r]
+  auto row=[&_mvp](int _r, int _c){return _mvp.m_openGL[_c*4+_r];};
+  for(int c=0; c<4; ++c)
+  {
+    m_w[c]=row(3,c);
+    // left right, bottom top, near far are w+row and w-row for rows x y z
+    for(int axis=0; axis<3; ++axis)
+    {
+      m_planes[axis*2][c]=row(3,c)+row(axis,c);
+      m_planes[axis*2+1][c]=row(3,c)-row(axis,c);
+    }
+  }
+}
+
+bool Frustum::intersects(const ngl::Vec3 &_min, const ngl::Vec3 &_max) const
+{
+  for(auto &p : m_planes)
+  {
+    // test the corner furthest along the plane normal, if that is outside the whole box is
+    ngl::Real x= p[0] >= 0.0f ? _max.m_x : _min.m_x;
+    ngl::Real y= p[1] >= 0.0f ? _max.m_y : _min.m_y;
+    ngl::Real z= p[2] >= 0.0f ? _max.m_z : _min.m_z;
+    if(p[0]*x+p[1]*y+p[2]*z+p[3] < 0.0f)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+ngl::Real Frustum::depth(const ngl::Vec3 &_p) const
+{
+  return m_w[0]*_p.m_x+m_w[1]*_p.m_y+m_w[2]*_p.m_z+m_w[3];
+}
@@ -0,0 +1,217 @@
+#include "GLState.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+  /// @brief an id for printing, the cache may not know what is bound
+  std::string bindingName(GLuint _id, GLuint _unknown)
+  {
+    return _id == _unknown ? std::string("unknown") : std::to_string(_id);
+  }
+}
+
+GLState::Counters & GLState::Counters::operator+=(const Counters &_other)
+{
+  drawCalls+=_other.drawCalls;
+  vertices+=_other.vertices;
+  vaoBinds+=_other.vaoBinds;
+  bufferBinds+=_other.bufferBinds;
+  programBinds+=_other.programBinds;
+  skipped+=_other.skipped;
+  uploads+=_other.uploads;
+  uploadBytes+=_other.uploadBytes;
+  return *this;
+}
+
+GLState *GLState::instance()
+{
+  // a context is only ever current on one thread so the state is kept per thread, not shared
+  static thread_local GLState s_state;
+  return &s_state;
+}
+
+void GLState::bindVertexArray(GLuint _vao)
+{
+  if(m_vao == _vao)
+  {
+    ++m_frame.skipped;
+    return;
+  }
+  glBindVertexArray(_vao);
+  m_vao=_vao;
+  ++m_frame.vaoBinds;
+}
+
+void GLState::bind(ngl::AbstractVAO &_vao)
+{
+  if(m_vao == _vao.getID())
+  {
+    ++m_frame.skipped;
+    return;
+  }
+  _vao.bind();
+  m_vao=_vao.getID();
+  ++m_frame.vaoBinds;
+}
+
+void GLState::unbindVertexArray()
+{
+  ++m_frame.skipped;
+}
+
+void GLState::bindBuffer(GLenum _target, GLuint _buffer)
+{
+  if(_target == GL_ARRAY_BUFFER)
+  {
+    if(m_arrayBuffer == _buffer)
+    {
+      ++m_frame.skipped;
+      return;
+    }
+    m_arrayBuffer=_buffer;
+  }
+  glBindBuffer(_target,_buffer);
+  ++m_frame.bufferBinds;
+}
+
+void GLState::useProgram(GLuint _program)
+{
+  if(m_program == _program)
+  {
+    ++m_frame.skipped;
+    return;
+  }
+  glUseProgram(_program);
+  m_program=_program;
+  ++m_frame.programBinds;
+}
+
+void GLState::programUsed(GLuint _program)
+{
+  m_program=_program;
+  ++m_frame.programBinds;
+}
+
+void GLState::deleteVertexArrays(GLsizei _count, const GLuint *_vaos)
+{
+  // GL binds 0 in place of a deleted VAO that is bound
+  if(std::find(_vaos,_vaos+_count,m_vao) != _vaos+_count)
+  {
+    m_vao=0;
+  }
+  glDeleteVertexArrays(_count,_vaos);
+}
+
+void GLState::deleteBuffers(GLsizei _count, const GLuint *_buffers)
+{
+  if(std::find(_buffers,_buffers+_count,m_arrayBuffer) != _buffers+_count)
+  {
+    m_arrayBuffer=0;
+  }
+  glDeleteBuffers(_count,_buffers);
+}
+
+void GLState::remove(ngl::AbstractVAO &_vao)
+{
+  _vao.removeVAO();
+  m_vao=s_unknown;
+  m_arrayBuffer=s_unknown;
+}
+
+void GLState::drawArrays(GLenum _mode, GLint _first, GLsizei _count)
+{
+  glDrawArrays(_mode,_first,_count);
+  countDraw(static_cast<size_t>(std::max(_count,0)));
+}
+
+void GLState::multiDrawArrays(GLenum _mode, const GLint *_firsts, const GLsizei *_counts, GLsizei _drawCount)
+{
+  glMultiDrawArrays(_mode,_firsts,_counts,_drawCount);
+  size_t vertices=0;
+  for(GLsizei i=0; i<_drawCount; ++i)
+  {
+    vertices+=static_cast<size_t>(std::max(_counts[i],0));
+  }
+  countDraw(vertices);
+}
+
+void GLState::countDraw(size_t _vertices)
+{
+  ++m_frame.drawCalls;
+  m_frame.vertices+=_vertices;
+}
+
+void GLState::bufferData(GLenum _target, size_t _bytes, const void *_data, GLenum _usage)
+{
+  glBufferData(_target,static_cast<GLsizeiptr>(_bytes),_data,_usage);
+  if(_data != nullptr)
+  {
+    countUpload(_bytes);
+  }
+}
+
+void GLState::bufferSubData(GLenum _target, size_t _offset, size_t _bytes, const void *_data)
+{
+  glBufferSubData(_target,static_cast<GLintptr>(_offset),static_cast<GLsizeiptr>(_bytes),_data);
+  countUpload(_bytes);
+}
+
+void GLState::countUpload(size_t _bytes)
+{
+  ++m_frame.uploads;
+  m_frame.uploadBytes+=_bytes;
+}
+
+void GLState::invalidate()
+{
+  m_vao=s_unknown;
+  m_arrayBuffer=s_unknown;
+  m_program=s_unknown;
+}
+
+void GLState::beginFrame()
+{
+  m_total+=m_frame;
+  m_lastFrame=m_frame;
+  m_frame=Counters();
+  ++m_frames;
+  invalidate();
+}
+
+std::string GLState::hudLine() const
+{
+  std::ostringstream line;
+  line<<m_lastFrame.drawCalls<<" draws "
+      <<m_lastFrame.vaoBinds+m_lastFrame.bufferBinds+m_lastFrame.programBinds<<" binds "
+      <<m_lastFrame.skipped<<" skipped "
+      <<m_lastFrame.uploads<<" uploads "
+      <<std::fixed<<std::setprecision(2)<<m_lastFrame.uploadBytes/(1024.0*1024.0)<<" MB";
+  return line.str();
+}
+
+void GLState::dump(std::ostream &_log) const
+{
+  auto print=[&_log](const char *_name, double _last, double _total, unsigned int _frames)
+  {
+    _log<<"  "<<std::left<<std::setw(14)<<_name<<std::right<<std::setw(14)<<_last
+        <<std::setw(16)<<(_frames > 0 ? _total/_frames : 0.0)<<'\n';
+  };
+  std::ios_base::fmtflags flags=_log.flags();
+  std::streamsize precision=_log.precision();
+  _log<<std::fixed<<std::setprecision(1)
+      <<"GL calls, the last frame and the mean of "<<m_frames<<" frames\n";
+  print("draw calls",m_lastFrame.drawCalls,m_total.drawCalls,m_frames);
+  print("vertices",m_lastFrame.vertices,m_total.vertices,m_frames);
+  print("VAO binds",m_lastFrame.vaoBinds,m_total.vaoBinds,m_frames);
+  print("buffer binds",m_lastFrame.bufferBinds,m_total.bufferBinds,m_frames);
+  print("program binds",m_lastFrame.programBinds,m_total.programBinds,m_frames);
+  print("skipped",m_lastFrame.skipped,m_total.skipped,m_frames);
+  print("uploads",m_lastFrame.uploads,m_total.uploads,m_frames);
+  print("upload KB",m_lastFrame.uploadBytes/1024.0,m_total.uploadBytes/1024.0,m_frames);
+  _log<<"  bound VAO "<<bindingName(m_vao,s_unknown)<<" array buffer "<<bindingName(m_arrayBuffer,s_unknown)
+      <<" program "<<bindingName(m_program,s_unknown)<<'\n';
+  _log.flags(flags);
+  _log.precision(precision);
+}
@@ -0,0 +1,239 @@
+#include "MortonSort.h"
+#include "Morton.h"
+#include "PointGenerator.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  /// @brief bits sorted each pass
+  const unsigned int s_digitBits=8;
+  const size_t s_buckets=size_t(1)<<s_digitBits;
+  using Histogram=std::array<size_t,s_buckets>;
+
+  /// @brief split [0,_count) into one block per thread, the same split is used by every pass
+  std::vector<size_t> blockStarts(size_t _count)
+  {
+    size_t blocks=std::max<size_t>(1,std::min<size_t>(ThreadPool::instance()->numThreads(),_count/4096));
+    std::vector<size_t> starts(blocks+1);
+    for(size_t b=0; b<=blocks; ++b)
+    {
+      starts[b]=_count*b/blocks;
+    }
+    return starts;
+  }
+}
+
+MortonSort::MortonSort(Precision _precision) : m_axisBits(_precision == Precision::Bits30 ? 10 : morton::MaxBits)
+{
+}
+
+void MortonSort::sort(const float *_xyz, size_t _count)
+{
+  TRACE_SCOPE("MortonSort::sort");
+  auto start=std::chrono::steady_clock::now();
+  ThreadPool *pool=ThreadPool::instance();
+  std::vector<size_t> starts=blockStarts(_count);
+  size_t blocks=starts.size()-1;
+  m_codes.resize(_count);
+  m_order.resize(_count);
+  m_codesScratch.resize(_count);
+  m_orderScratch.resize(_count);
+  m_passes=0;
+  if(_count == 0)
+  {
+    m_sortMs=0.0;
+    return;
+  }
+  // the bounds, each block finds its own then they are combined
+  std::vector<std::array<float,6>> blockBounds(blocks);
+  pool->parallelFor(0,blocks,[&](size_t _begin, size_t _end)
+  {
+    for(size_t b=_begin; b<_end; ++b)
+    {
+      std::array<float,6> &bounds=blockBounds[b];
+      std::fill(bounds.begin(),bounds.begin()+3,std::numeric_limits<float>::max());
+      std::fill(bounds.begin()+3,bounds.end(),std::numeric_limits<float>::lowest());
+      for(size_t i=starts[b]; i<starts[b+1]; ++i)
+      {
+        for(int axis=0; axis<3; ++axis)
+        {
+          bounds[axis]=std::min(bounds[axis],_xyz[i*3+axis]);
+          bounds[axis+3]=std::max(bounds[axis+3],_xyz[i*3+axis]);
+        }
+      }
+    }
+  },1);
+  float min[3];
+  float scale[3];
+  uint32_t maxCell=(1u<<m_axisBits)-1;
+  for(int axis=0; axis<3; ++axis)
+  {
+    float lo=std::numeric_limits<float>::max();
+    float hi=std::numeric_limits<float>::lowest();
+    for(auto &bounds : blockBounds)
+    {
+      lo=std::min(lo,bounds[axis]);
+      hi=std::max(hi,bounds[axis+3]);
+    }
+    min[axis]=lo;
+    scale[axis]= hi > lo ? (maxCell+1)/(hi-lo) : 0.0f;
+  }
+  // the codes and the starting order, counting the digits of every pass at the same time
+  std::vector<std::vector<Histogram>> counts(blocks,std::vector<Histogram>((codeBits()+s_digitBits-1)/s_digitBits));
+  pool->parallelFor(0,blocks,[&](size_t _begin, size_t _end)
+  {
+    for(size_t b=_begin; b<_end; ++b)
+    {
+      for(auto &histogram : counts[b])
+      {
+        histogram.fill(0);
+      }
+      for(size_t i=starts[b]; i<starts[b+1]; ++i)
+      {
+        uint32_t c[3];
+        for(int axis=0; axis<3; ++axis)
+        {
+          c[axis]=std::min(static_cast<uint32_t>(std::max(0.0f,(_xyz[i*3+axis]-min[axis])*scale[axis])),maxCell);
+        }
+        uint64_t code=morton::encode(c[0],c[1],c[2]);
+        m_codes[i]=code;
+        m_order[i]=static_cast<uint32_t>(i);
+        // every pass's digits are counted up front, the totals say which passes can be skipped and
+        // until the first scatter the blocks still hold these codes so its counts are ready too
+        for(size_t pass=0; pass<counts[b].size(); ++pass)
+        {
+          ++counts[b][pass][(code >> (pass*s_digitBits)) & (s_buckets-1)];
+        }
+      }
+    }
+  },1);
+  for(size_t pass=0; pass<counts[0].size(); ++pass)
+  {
+    size_t largest=0;
+    for(size_t digit=0; digit<s_buckets; ++digit)
+    {
+      size_t digitCount=0;
+      for(size_t b=0; b<blocks; ++b)
+      {
+        digitCount+=counts[b][pass][digit];
+      }
+      largest=std::max(largest,digitCount);
+    }
+    if(largest == _count)
+    {
+      continue;
+    }
+    unsigned int shift=static_cast<unsigned int>(pass*s_digitBits);
+    std::vector<Histogram> blockCounts(blocks);
+    if(m_passes == 0)
+    {
+      for(size_t b=0; b<blocks; ++b)
+      {
+        blockCounts[b]=counts[b][pass];
+      }
+    }
+    else
+    {
+      // the last scatter moved codes between blocks so count again
+      pool->parallelFor(0,blocks,[&](size_t _begin, size_t _end)
+      {
+        for(size_t b=_begin; b<_end; ++b)
+        {
+          blockCounts[b].fill(0);
+          for(size_t i=starts[b]; i<starts[b+1]; ++i)
+          {
+            ++blockCounts[b][(m_codes[i] >> shift) & (s_buckets-1)];
+          }
+        }
+      },1);
+    }
+    // slot of each digit in each block, digit major so equal digits keep their block order
+    std::vector<Histogram> offsets(blocks);
+    size_t total=0;
+    for(size_t digit=0; digit<s_buckets; ++digit)
+    {
+      for(size_t b=0; b<blocks; ++b)
+      {
+        offsets[b][digit]=total;
+        total+=blockCounts[b][digit];
+      }
+    }
+    pool->parallelFor(0,blocks,[&](size_t _begin, size_t _end)
+    {
+      for(size_t b=_begin; b<_end; ++b)
+      {
+        Histogram &next=offsets[b];
+        for(size_t i=starts[b]; i<starts[b+1]; ++i)
+        {
+          size_t slot=next[(m_codes[i] >> shift) & (s_buckets-1)]++;
+          m_codesScratch[slot]=m_codes[i];
+          m_orderScratch[slot]=m_order[i];
+        }
+      }
+    },1);
+    m_codes.swap(m_codesScratch);
+    m_order.swap(m_orderScratch);
+    ++m_passes;
+  }
+  m_sortMs=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+void MortonSort::gather(const void *_in, void *o_out, size_t _stride) const
+{
+  const unsigned char *in=static_cast<const unsigned char *>(_in);
+  unsigned char *out=static_cast<unsigned char *>(o_out);
+  ThreadPool::instance()->parallelFor(0,m_order.size(),[&](size_t _begin, size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      std::memcpy(out+i*_stride,in+m_order[i]*_stride,_stride);
+    }
+  },4096);
+}
+
+std::vector<MortonSort::Range> MortonSort::ranges(unsigned int _prefixBits) const
+{
+  std::vector<Range> result;
+  unsigned int shift=codeBits()-std::min(_prefixBits,codeBits());
+  for(size_t i=0; i<m_codes.size(); ++i)
+  {
+    uint64_t prefix=m_codes[i] >> shift;
+    if(result.empty() || result.back().prefix != prefix)
+    {
+      result.push_back({prefix,i,0});
+    }
+    ++result.back().count;
+  }
+  return result;
+}
+
+void MortonSort::benchmark(size_t _count, unsigned int _iterations, std::ostream &_log)
+{
+  std::vector<float> points(_count*3);
+  std::vector<float> sorted(_count*3);
+  PointGenerator gen;
+  gen.generate(points.data(),_count);
+  for(auto precision : {Precision::Bits30,Precision::Bits63})
+  {
+    MortonSort sorter(precision);
+    double bestSort=std::numeric_limits<double>::max();
+    double bestGather=std::numeric_limits<double>::max();
+    for(unsigned int i=0; i<std::max(1u,_iterations); ++i)
+    {
+      sorter.sort(points.data(),_count);
+      bestSort=std::min(bestSort,sorter.sortMs());
+      auto start=std::chrono::steady_clock::now();
+      sorter.gather(points.data(),sorted.data(),3*sizeof(float));
+      bestGather=std::min(bestGather,std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count());
+    }
+    _log<<"MortonSort "<<sorter.codeBits()<<" bit "<<_count<<" points, sort "<<bestSort<<" ms ("
+        <<_count/(bestSort*1000.0)<<" Mpoints/s, "<<sorter.passes()<<" passes) gather "<<bestGather<<" ms ("
+        <<_count/(bestGather*1000.0)<<" Mpoints/s) on "<<ThreadPool::instance()->numThreads()<<" threads\n";
+  }
+}
@@ -0,0 +1,91 @@
+#include "OctreeFile.h"
+#include <cstring>
+#include <iostream>
+
+OctreeFile::~OctreeFile()
+{
+  close();
+}
+
+bool OctreeFile::open(const std::string &_fname)
+{
+  close();
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    std::cerr<<"unable to open octree "<<_fname<<'\n';
+    return false;
+  }
+  OctreeHeader expected;
+  qint64 fileSize=m_file.size();
+  if(m_file.read(reinterpret_cast<char *>(&m_header),sizeof(OctreeHeader)) != sizeof(OctreeHeader) ||
+     std::memcmp(m_header.magic,expected.magic,sizeof(expected.magic)) != 0 || m_header.version != expected.version)
+  {
+    std::cerr<<_fname<<" is not an octree written by OctreeBuilder\n";
+    close();
+    return false;
+  }
+  qint64 tableBytes=static_cast<qint64>(m_header.numNodes)*static_cast<qint64>(sizeof(OctreeNode));
+  if(m_header.numNodes == 0 || static_cast<qint64>(m_header.nodeTableOffset)+tableBytes > fileSize)
+  {
+    std::cerr<<_fname<<" is truncated\n";
+    close();
+    return false;
+  }
+  m_nodes.resize(m_header.numNodes);
+  m_file.seek(static_cast<qint64>(m_header.nodeTableOffset));
+  m_file.read(reinterpret_cast<char *>(m_nodes.data()),tableBytes);
+  for(auto &n : m_nodes)
+  {
+    bool valid= n.offset+static_cast<uint64_t>(n.numPoints)*3*sizeof(float) <= m_header.nodeTableOffset;
+    for(auto c : n.children)
+    {
+      valid&= c >= -1 && c < static_cast<int32_t>(m_header.numNodes);
+    }
+    if(!valid)
+    {
+      std::cerr<<_fname<<" has a corrupt node table\n";
+      close();
+      return false;
+    }
+  }
+  // map everything, only the pages of the nodes that are loaded are ever read
+  m_data=m_file.map(0,fileSize);
+  if(m_data == nullptr)
+  {
+    std::cerr<<"unable to map "<<_fname<<" : "<<m_file.errorString().toStdString()<<'\n';
+    close();
+    return false;
+  }
+  std::cout<<"Octree "<<_fname<<" has "<<m_header.numPoints<<" points in "<<m_header.numNodes<<" nodes\n";
+  return true;
+}
+
+void OctreeFile::close()
+{
+  if(m_data != nullptr)
+  {
+    m_file.unmap(const_cast<unsigned char *>(m_data));
+    m_data=nullptr;
+  }
+  if(m_file.isOpen())
+  {
+    m_file.close();
+  }
+  m_nodes.clear();
+}
+
+const float *OctreeFile::points(size_t _index) const
+{
+  return reinterpret_cast<const float *>(m_data+m_nodes[_index].offset);
+}
+
+ngl::Vec3 OctreeFile::minBounds() const
+{
+  return ngl::Vec3(m_header.min[0],m_header.min[1],m_header.min[2]);
+}
+
+ngl::Vec3 OctreeFile::maxBounds() const
+{
+  return ngl::Vec3(m_header.min[0]+m_header.size,m_header.min[1]+m_header.size,m_header.min[2]+m_header.size);
+}
@@ -0,0 +1,263 @@
+#include "ParticleSystem.h"
+#include "GLState.h"
+#include "PointGenerator.h"
+#include "ProgramCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+
+namespace
+{
+  /// @brief everything before the force function, the inputs, captured outputs and uniforms
+  const char *s_updateHeader=R"(#version 330 core
+layout (location=0) in vec3 inPosition;
+layout (location=1) in vec3 inVelocity;
+out vec3 outPosition;
+out vec3 outVelocity;
+uniform float dt;
+uniform vec3 gravity;
+uniform vec3 attractor;
+uniform float attraction;
+uniform float damping;
+uniform vec3 boundsMin;
+uniform vec3 boundsMax;
+uniform float restitution;
+)";
+
+  /// @brief the default force, ParticleSystem::integrate must match this
+  const char *s_defaultForce=R"(
+vec3 force(vec3 _position, vec3 _velocity)
+{
+  return gravity+(attractor-_position)*attraction;
+}
+)";
+
+  /// @brief semi implicit Euler then bounce off the walls, ParticleSystem::integrate must match this
+  const char *s_updateMain=R"(
+void main()
+{
+  vec3 v=(inVelocity+force(inPosition,inVelocity)*dt)/(1.0+damping*dt);
+  vec3 p=inPosition+v*dt;
+  for(int axis=0; axis<3; ++axis)
+  {
+    if(p[axis] < boundsMin[axis] || p[axis] > boundsMax[axis])
+    {
+      p[axis]=clamp(p[axis],boundsMin[axis],boundsMax[axis]);
+      v[axis]=-v[axis]*restitution;
+    }
+  }
+  outPosition=p;
+  outVelocity=v;
+}
+)";
+
+  /// @brief the starting velocities are random in this box
+  const float s_initialSpeed=2.0f;
+
+  /// @brief the uniforms of the update shader in the order of ParticleSystem::Uniform
+  const char *s_uniformNames[]={"dt","gravity","attractor","attraction","damping","boundsMin","boundsMax","restitution"};
+}
+
+ParticleSystem::ParticleSystem(const std::string &_forceSource) : m_forceSource(_forceSource)
+{
+  // each different force needs its own program
+  m_program= m_forceSource.empty() ? "ParticleSystem" : "ParticleSystem"+std::to_string(std::hash<std::string>()(m_forceSource));
+}
+
+ParticleSystem::~ParticleSystem()
+{
+  release();
+}
+
+void ParticleSystem::createShader()
+{
+  std::string source=std::string(s_updateHeader)+(m_forceSource.empty() ? s_defaultForce : m_forceSource)+s_updateMain;
+  // interleaved the captured outputs match Particle
+  m_programId=ProgramCache::instance()->program(m_program,{{ngl::ShaderType::VERTEX,source}},
+                                                std::function<void(GLuint)>(),{"outPosition","outVelocity"});
+  for(size_t i=0; i<NumUniforms; ++i)
+  {
+    m_locations[i]=glGetUniformLocation(m_programId,s_uniformNames[i]);
+  }
+}
+
+void ParticleSystem::init(size_t _count, uint64_t _seed)
+{
+  release();
+  createShader();
+  m_count=_count;
+  m_steps=0;
+  m_current=0;
+  std::vector<float> positions(_count*3);
+  std::vector<float> velocities(_count*3);
+  PointGenerator generator(_seed);
+  generator.generate(positions.data(),_count);
+  // a different part of the sequence for the velocities so they aren't the positions scaled
+  generator.setExtents(s_initialSpeed,s_initialSpeed,s_initialSpeed);
+  generator.generate(velocities.data(),_count,_count);
+  std::vector<Particle> particles(_count);
+  for(size_t i=0; i<_count; ++i)
+  {
+    std::copy(&positions[i*3],&positions[i*3+3],particles[i].position);
+    std::copy(&velocities[i*3],&velocities[i*3+3],particles[i].velocity);
+  }
+  glGenBuffers(2,m_buffers);
+  glGenVertexArrays(2,m_vaos);
+  GLState *state=GLState::instance();
+  for(int i=0; i<2; ++i)
+  {
+    state->bindVertexArray(m_vaos[i]);
+    state->bindBuffer(GL_ARRAY_BUFFER,m_buffers[i]);
+    // only the first buffer starts with data, the second is written by the first step
+    state->bufferData(GL_ARRAY_BUFFER,_count*sizeof(Particle),i == 0 ? particles.data() : nullptr,GL_DYNAMIC_COPY);
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(Particle),reinterpret_cast<const void *>(offsetof(Particle,position)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(Particle),reinterpret_cast<const void *>(offsetof(Particle,velocity)));
+    glEnableVertexAttribArray(1);
+  }
+  state->unbindVertexArray();
+}
+
+void ParticleSystem::step(float _dt)
+{
+  if(m_count == 0)
+  {
+    return;
+  }
+  GLState *state=GLState::instance();
+  state->useProgram(m_programId);
+  const Parameters &p=m_parameters;
+  glUniform1f(m_locations[Dt],_dt);
+  glUniform3fv(m_locations[Gravity],1,p.gravity);
+  glUniform3fv(m_locations[Attractor],1,p.attractor);
+  glUniform1f(m_locations[Attraction],p.attraction);
+  glUniform1f(m_locations[Damping],p.damping);
+  glUniform3fv(m_locations[BoundsMin],1,p.boundsMin);
+  glUniform3fv(m_locations[BoundsMax],1,p.boundsMax);
+  glUniform1f(m_locations[Restitution],p.restitution);
+  unsigned int next=1-m_current;
+  // nothing is drawn, the vertex shader outputs are written straight into the other buffer
+  glEnable(GL_RASTERIZER_DISCARD);
+  state->bindVertexArray(m_vaos[m_current]);
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER,0,m_buffers[next]);
+  glBeginTransformFeedback(GL_POINTS);
+  state->drawArrays(GL_POINTS,0,static_cast<GLsizei>(m_count));
+  glEndTransformFeedback();
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER,0,0);
+  state->unbindVertexArray();
+  glDisable(GL_RASTERIZER_DISCARD);
+  m_current=next;
+  ++m_steps;
+}
+
+void ParticleSystem::bind() const
+{
+  GLState::instance()->bindVertexArray(m_vaos[m_current]);
+}
+
+void ParticleSystem::unbind() const
+{
+  GLState::instance()->unbindVertexArray();
+}
+
+void ParticleSystem::draw() const
+{
+  bind();
+  GLState::instance()->drawArrays(GL_POINTS,0,static_cast<GLsizei>(m_count));
+  unbind();
+}
+
+void ParticleSystem::release()
+{
+  if(m_vaos[0] == 0)
+  {
+    return;
+  }
+  GLState *state=GLState::instance();
+  state->deleteVertexArrays(2,m_vaos);
+  state->deleteBuffers(2,m_buffers);
+  m_vaos[0]=m_vaos[1]=0;
+  m_buffers[0]=m_buffers[1]=0;
+  m_count=0;
+}
+
+void ParticleSystem::integrate(Particle &io_particle, const Parameters &_parameters, float _dt)
+{
+  const Parameters &p=_parameters;
+  float *position=io_particle.position;
+  float *velocity=io_particle.velocity;
+  for(int axis=0; axis<3; ++axis)
+  {
+    float force=p.gravity[axis]+(p.attractor[axis]-position[axis])*p.attraction;
+    velocity[axis]=(velocity[axis]+force*_dt)/(1.0f+p.damping*_dt);
+    position[axis]+=velocity[axis]*_dt;
+    if(position[axis] < p.boundsMin[axis] || position[axis] > p.boundsMax[axis])
+    {
+      position[axis]=std::min(std::max(position[axis],p.boundsMin[axis]),p.boundsMax[axis]);
+      velocity[axis]=-velocity[axis]*p.restitution;
+    }
+  }
+}
+
+bool ParticleSystem::validate(unsigned int _steps, float _dt, size_t _samples, std::ostream &_log)
+{
+  if(!m_forceSource.empty())
+  {
+    _log<<"ParticleSystem can only validate the default force\n";
+    return false;
+  }
+  if(m_count == 0)
+  {
+    return false;
+  }
+  _samples=std::min(_samples,m_count);
+  std::vector<size_t> indices(_samples);
+  std::vector<Particle> cpu(_samples);
+  auto readBack=[this,&indices](std::vector<Particle> &o_particles)
+  {
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_buffers[m_current]);
+    for(size_t i=0; i<indices.size(); ++i)
+    {
+      glGetBufferSubData(GL_ARRAY_BUFFER,indices[i]*sizeof(Particle),sizeof(Particle),&o_particles[i]);
+    }
+  };
+  for(size_t i=0; i<_samples; ++i)
+  {
+    indices[i]=i*m_count/_samples;
+  }
+  readBack(cpu);
+  for(unsigned int s=0; s<_steps; ++s)
+  {
+    step(_dt);
+    for(auto &p : cpu)
+    {
+      integrate(p,m_parameters,_dt);
+    }
+  }
+  std::vector<Particle> gpu(_samples);
+  readBack(gpu);
+  // the GPU may fuse or re-order the sums so allow a little drift relative to the box
+  float size=0.0f;
+  for(int axis=0; axis<3; ++axis)
+  {
+    size=std::max(size,m_parameters.boundsMax[axis]-m_parameters.boundsMin[axis]);
+  }
+  const float tolerance=1e-4f*size*_steps;
+  float worst=0.0f;
+  size_t failed=0;
+  for(size_t i=0; i<_samples; ++i)
+  {
+    float error=0.0f;
+    for(int axis=0; axis<3; ++axis)
+    {
+      error=std::max(error,std::abs(gpu[i].position[axis]-cpu[i].position[axis]));
+      error=std::max(error,std::abs(gpu[i].velocity[axis]-cpu[i].velocity[axis])*_dt);
+    }
+    worst=std::max(worst,error);
+    failed+= error > tolerance;
+  }
+  _log<<"ParticleSystem "<<_samples<<" particles after "<<_steps<<" steps, largest difference from the CPU "
+      <<worst<<" (tolerance "<<tolerance<<"), "<<(failed ? std::to_string(failed)+" FAILED" : std::string("all match"))<<"\n";
+  return failed == 0;
+}
@@ -0,0 +1,195 @@
+#include "PointBuffer.h"
+#include "GLState.h"
+#include <algorithm>
+#include <cstring>
+
+PointBuffer::~PointBuffer()
+{
+  release();
+}
+
+void PointBuffer::release()
+{
+  if(m_id !=0)
+  {
+    GLState::instance()->deleteBuffers(1,&m_id);
+  }
+  m_id=0;
+  m_size=0;
+  m_capacity=0;
+  m_highWater=0;
+  m_unsyncFrom=0;
+}
+
+bool PointBuffer::reserve(size_t _bytes)
+{
+  if(m_id !=0 && _bytes <= m_capacity)
+  {
+    return false;
+  }
+  // grow by at least 1.5x so a run of small increases is amortised
+  reallocate(std::max(_bytes,m_capacity+m_capacity/2));
+  return true;
+}
+
+bool PointBuffer::resize(size_t _bytes)
+{
+  bool changed=reserve(_bytes);
+  // anything past what has been in use so far hasn't been drawn yet
+  m_unsyncFrom=m_highWater;
+  m_size=_bytes;
+  m_highWater=std::max(m_highWater,_bytes);
+  return changed;
+}
+
+bool PointBuffer::shrinkToFit()
+{
+  if(m_id == 0 || m_size == m_capacity)
+  {
+    return false;
+  }
+  reallocate(m_size);
+  return true;
+}
+
+void PointBuffer::upload(size_t _offset, size_t _bytes, const void *_data)
+{
+  if(_bytes == 0)
+  {
+    return;
+  }
+  TRACE_SCOPE("PointBuffer::upload");
+  GLState *state=GLState::instance();
+  state->bindBuffer(GL_ARRAY_BUFFER,m_id);
+  state->bufferSubData(GL_ARRAY_BUFFER,_offset,_bytes,_data);
+}
+
+bool PointBuffer::flush(DirtyRanges &_dirty, const void *_source, bool _mapped)
+{
+  if(_dirty.empty() || m_id == 0)
+  {
+    _dirty.clear();
+    return false;
+  }
+  TRACE_SCOPE("PointBuffer::flush");
+  const std::vector<DirtyRanges::Range> &ranges=_dirty.coalesce();
+  const char *source=static_cast<const char *>(_source);
+  GLState *state=GLState::instance();
+  bool mapped=false;
+  if(_mapped)
+  {
+    size_t begin=ranges.front().offset;
+    size_t end=ranges.back().offset+ranges.back().bytes;
+    // the bytes between the ranges must be kept so nothing can be invalidated, only flushed ranges are written
+    GLbitfield access=GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+    if(begin >= m_unsyncFrom)
+    {
+      access|=GL_MAP_UNSYNCHRONIZED_BIT;
+    }
+    state->bindBuffer(GL_ARRAY_BUFFER,m_id);
+    char *span=static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER,static_cast<GLintptr>(begin),
+                                                    static_cast<GLsizeiptr>(end-begin),access));
+    if(span != nullptr)
+    {
+      ++m_maps;
+      m_unsyncFrom=m_highWater;
+      for(const auto &r : ranges)
+      {
+        std::memcpy(span+(r.offset-begin),source+r.offset,r.bytes);
+        glFlushMappedBufferRange(GL_ARRAY_BUFFER,static_cast<GLintptr>(r.offset-begin),static_cast<GLsizeiptr>(r.bytes));
+        state->countUpload(r.bytes);
+      }
+      mapped=unmap();
+      if(!mapped)
+      {
+        // the whole store is undefined once the driver loses a mapping, luckily we have a copy of all of it
+        ++m_fallbacks;
+        upload(0,m_size,_source);
+        _dirty.flushed();
+        return false;
+      }
+    }
+    else
+    {
+      ++m_fallbacks;
+    }
+  }
+  if(!mapped)
+  {
+    for(const auto &r : ranges)
+    {
+      upload(r.offset,r.bytes,source+r.offset);
+    }
+  }
+  _dirty.flushed();
+  return mapped;
+}
+
+void *PointBuffer::map(size_t _offset, size_t _bytes)
+{
+  if(m_id == 0 || _bytes == 0 || _offset+_bytes > m_size)
+  {
+    return nullptr;
+  }
+  GLbitfield access=GL_MAP_WRITE_BIT;
+  if(_offset == 0 && _bytes == m_size)
+  {
+    // everything in use is being replaced so let the driver orphan the storage rather than stall
+    access|=GL_MAP_INVALIDATE_BUFFER_BIT;
+  }
+  else
+  {
+    access|=GL_MAP_INVALIDATE_RANGE_BIT;
+    if(_offset >= m_unsyncFrom)
+    {
+      // no draw has used this range so there is nothing to wait for
+      access|=GL_MAP_UNSYNCHRONIZED_BIT;
+    }
+  }
+  GLState *state=GLState::instance();
+  state->bindBuffer(GL_ARRAY_BUFFER,m_id);
+  void *mapped=glMapBufferRange(GL_ARRAY_BUFFER,static_cast<GLintptr>(_offset),static_cast<GLsizeiptr>(_bytes),access);
+  if(mapped != nullptr)
+  {
+    ++m_maps;
+    state->countUpload(_bytes);
+    // once written it can be drawn
+    m_unsyncFrom=m_highWater;
+  }
+  return mapped;
+}
+
+bool PointBuffer::unmap()
+{
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_id);
+  return glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+}
+
+void PointBuffer::reallocate(size_t _capacity)
+{
+  GLuint buffer;
+  glGenBuffers(1,&buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER,buffer);
+  // GL doesn't like zero sized buffers so always allocate something
+  glBufferData(GL_COPY_WRITE_BUFFER,static_cast<GLsizeiptr>(std::max<size_t>(_capacity,4)),nullptr,m_usage);
+  size_t keep=std::min(m_size,_capacity);
+  if(m_id !=0)
+  {
+    // the copy stays on the GPU
+    if(keep > 0)
+    {
+      glBindBuffer(GL_COPY_READ_BUFFER,m_id);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER,GL_COPY_WRITE_BUFFER,0,0,static_cast<GLsizeiptr>(keep));
+      glBindBuffer(GL_COPY_READ_BUFFER,0);
+    }
+    GLState::instance()->deleteBuffers(1,&m_id);
+    ++m_reallocations;
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER,0);
+  m_id=buffer;
+  m_capacity=_capacity;
+  m_size=keep;
+  // only the copy can be in use in the new buffer
+  m_highWater=keep;
+  m_unsyncFrom=keep;
+}
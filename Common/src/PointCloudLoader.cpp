@@ -0,0 +1,384 @@
+#include "PointCloudLoader.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+  /// @brief size in bytes of a PLY scalar type, 0 if it isn't one
+  size_t plyTypeSize(const QByteArray &_type)
+  {
+    if(_type == "char" || _type == "uchar" || _type == "int8" || _type == "uint8")
+    {
+      return 1;
+    }
+    if(_type == "short" || _type == "ushort" || _type == "int16" || _type == "uint16")
+    {
+      return 2;
+    }
+    if(_type == "int" || _type == "uint" || _type == "float" || _type == "int32" || _type == "uint32" || _type == "float32")
+    {
+      return 4;
+    }
+    if(_type == "double" || _type == "float64")
+    {
+      return 8;
+    }
+    return 0;
+  }
+
+  constexpr double s_mb=1024.0*1024.0;
+}
+
+PointCloudLoader::PointCloudLoader(size_t _chunkPoints) : m_chunkPoints(std::max<size_t>(_chunkPoints,1))
+{
+}
+
+bool PointCloudLoader::open(const std::string &_fname)
+{
+  close();
+  m_format=Format::Unknown;
+  m_numPoints=0;
+  m_loaded=0;
+  m_bytesRead=0;
+  m_loadNs=0;
+  m_dataOffset=0;
+  m_stride=3*sizeof(float);
+  m_offsets[0]=0; m_offsets[1]=4; m_offsets[2]=8;
+  m_double=false;
+  m_bigEndian=false;
+  m_packed=true;
+  const float inf=std::numeric_limits<float>::infinity();
+  m_min.set(inf,inf,inf);
+  m_max.set(-inf,-inf,-inf);
+
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    std::cerr<<"unable to open point cloud "<<_fname<<'\n';
+    return false;
+  }
+  m_sinceOpen.start();
+  QByteArray magic=m_file.peek(4);
+  if(magic == "ply\n" || magic == "ply\r")
+  {
+    m_format=Format::BinaryPLY;
+    if(!readPLYHeader())
+    {
+      close();
+      return false;
+    }
+  }
+  else
+  {
+    m_format=Format::RawXYZ;
+    m_numPoints=static_cast<size_t>(m_file.size())/m_stride;
+    if(static_cast<size_t>(m_file.size())%m_stride)
+    {
+      std::cerr<<_fname<<" is not a whole number of float xyz points, the last "
+               <<m_file.size()%m_stride<<" bytes are ignored\n";
+    }
+  }
+  if(static_cast<size_t>(m_file.size()-m_dataOffset) < m_numPoints*m_stride)
+  {
+    std::cerr<<_fname<<" is truncated, expected "<<m_numPoints<<" points\n";
+    close();
+    return false;
+  }
+  // floats read from the mapping must be aligned, pages are so only the header can upset this
+  m_packed = m_packed && m_dataOffset%sizeof(float) == 0;
+  if(!m_packed)
+  {
+    m_scratch.resize(std::min(m_chunkPoints,m_numPoints)*3);
+  }
+  std::cout<<"Loading "<<m_numPoints<<" points ("<<m_numPoints*m_stride/s_mb<<" MB) from "<<_fname
+           <<(m_format == Format::BinaryPLY ? " as PLY" : " as raw xyz")
+           <<(m_packed ? ", uploading from the mapping\n" : ", converting each chunk\n");
+  return true;
+}
+
+bool PointCloudLoader::readPLYHeader()
+{
+  struct Element
+  {
+    QByteArray name;
+    size_t count=0;
+    size_t size=0;
+    bool hasList=false;
+  };
+  std::vector<Element> elements;
+  QByteArray xyzTypes[3];
+  bool found[3]={false,false,false};
+  bool binary=false;
+  while(!m_file.atEnd())
+  {
+    QList<QByteArray> tokens=m_file.readLine().simplified().split(' ');
+    if(tokens.isEmpty() || tokens[0].isEmpty() || tokens[0] == "comment" || tokens[0] == "obj_info" || tokens[0] == "ply")
+    {
+      continue;
+    }
+    if(tokens[0] == "end_header")
+    {
+      break;
+    }
+    if(tokens[0] == "format" && tokens.size() > 1)
+    {
+      binary = tokens[1] == "binary_little_endian" || tokens[1] == "binary_big_endian";
+      m_bigEndian = tokens[1] == "binary_big_endian";
+      if(!binary)
+      {
+        std::cerr<<"only binary PLY files are supported, this one is "<<tokens[1].constData()<<'\n';
+        return false;
+      }
+    }
+    else if(tokens[0] == "element" && tokens.size() > 2)
+    {
+      Element e;
+      e.name=tokens[1];
+      e.count=tokens[2].toULongLong();
+      elements.push_back(e);
+    }
+    else if(tokens[0] == "property" && tokens.size() > 2 && !elements.empty())
+    {
+      Element &e=elements.back();
+      if(tokens[1] == "list")
+      {
+        e.hasList=true;
+        continue;
+      }
+      if(e.name == "vertex")
+      {
+        for(int axis=0; axis<3; ++axis)
+        {
+          if(tokens[2] == QByteArray(1,"xyz"[axis]))
+          {
+            m_offsets[axis]=e.size;
+            xyzTypes[axis]=tokens[1];
+            found[axis]=true;
+          }
+        }
+      }
+      size_t size=plyTypeSize(tokens[1]);
+      if(size == 0)
+      {
+        std::cerr<<"unknown PLY property type "<<tokens[1].constData()<<'\n';
+        return false;
+      }
+      e.size+=size;
+    }
+  }
+  if(!binary)
+  {
+    std::cerr<<"PLY header has no binary format line\n";
+    return false;
+  }
+  // the vertex data starts after any elements that come before it
+  m_dataOffset=m_file.pos();
+  auto vertex=elements.begin();
+  for(; vertex != elements.end() && vertex->name != "vertex"; ++vertex)
+  {
+    if(vertex->hasList)
+    {
+      std::cerr<<"can't skip the "<<vertex->name.constData()<<" list element before the vertices\n";
+      return false;
+    }
+    m_dataOffset+=static_cast<qint64>(vertex->count*vertex->size);
+  }
+  if(vertex == elements.end() || vertex->hasList || !found[0] || !found[1] || !found[2])
+  {
+    std::cerr<<"PLY file needs a vertex element with float or double x y z and no lists\n";
+    return false;
+  }
+  for(auto &type : xyzTypes)
+  {
+    bool isFloat = type == "float" || type == "float32";
+    bool isDouble = type == "double" || type == "float64";
+    if(!isFloat && !isDouble)
+    {
+      std::cerr<<"PLY vertex positions must be float or double not "<<type.constData()<<'\n';
+      return false;
+    }
+    m_double|=isDouble;
+  }
+  if(m_double && !(xyzTypes[0] == xyzTypes[1] && xyzTypes[1] == xyzTypes[2]))
+  {
+    std::cerr<<"PLY vertex positions must all be the same type\n";
+    return false;
+  }
+  m_numPoints=vertex->count;
+  m_stride=vertex->size;
+  m_packed= !m_double && !m_bigEndian && m_stride == 3*sizeof(float) &&
+            m_offsets[0] == 0 && m_offsets[1] == 4 && m_offsets[2] == 8;
+  return true;
+}
+
+void PointCloudLoader::close()
+{
+  if(m_file.isOpen())
+  {
+    m_file.close();
+  }
+  m_scratch.clear();
+  m_scratch.shrink_to_fit();
+}
+
+size_t PointCloudLoader::loadChunks(double _budgetMs, const UploadFunction &_upload)
+{
+  if(!m_file.isOpen())
+  {
+    return 0;
+  }
+  TRACE_SCOPE("PointCloudLoader::loadChunks");
+  QElapsedTimer timer;
+  timer.start();
+  size_t start=m_loaded;
+  do
+  {
+    size_t count=std::min(m_chunkPoints,m_numPoints-m_loaded);
+    if(count == 0 || !loadChunk(m_loaded,count,_upload))
+    {
+      break;
+    }
+    if(start == 0 && m_loaded == count)
+    {
+      std::cout<<"First chunk of "<<count<<" points ready "<<m_sinceOpen.elapsed()<<" ms after opening\n";
+    }
+  }
+  while(!done() && (_budgetMs <= 0.0 || timer.nsecsElapsed() < _budgetMs*1.0e6));
+
+  if(done())
+  {
+    std::cout<<"Loaded "<<m_numPoints<<" points, "<<m_bytesRead/s_mb<<" MB in "<<m_loadNs/1.0e6
+             <<" ms of loading ("<<throughput()<<" MB/s), "<<m_sinceOpen.elapsed()<<" ms wall clock\n";
+    close();
+  }
+  return m_loaded-start;
+}
+
+bool PointCloudLoader::loadChunk(size_t _first, size_t _count, const UploadFunction &_upload)
+{
+  QElapsedTimer timer;
+  timer.start();
+  qint64 bytes=static_cast<qint64>(_count*m_stride);
+  // only the chunk being uploaded is mapped so the resident memory stays at about one chunk
+  uchar *data=m_file.map(m_dataOffset+static_cast<qint64>(_first*m_stride),bytes);
+  if(data == nullptr)
+  {
+    std::cerr<<"unable to map "<<m_file.fileName().toStdString()<<" : "<<m_file.errorString().toStdString()<<'\n';
+    close();
+    return false;
+  }
+  const float *xyz=reinterpret_cast<const float *>(data);
+  if(!m_packed)
+  {
+    convert(data,_count);
+    xyz=m_scratch.data();
+  }
+  growBounds(xyz,_count);
+  _upload(_first*3*sizeof(float),_count*3*sizeof(float),xyz);
+  m_file.unmap(data);
+  m_loaded+=_count;
+  m_bytesRead+=static_cast<size_t>(bytes);
+  m_loadNs+=timer.nsecsElapsed();
+  return true;
+}
+
+void PointCloudLoader::convert(const unsigned char *_vertices, size_t _count)
+{
+  size_t size=m_double ? sizeof(double) : sizeof(float);
+  unsigned char value[sizeof(double)];
+  for(size_t i=0; i<_count; ++i)
+  {
+    const unsigned char *vertex=_vertices+i*m_stride;
+    for(size_t axis=0; axis<3; ++axis)
+    {
+      std::memcpy(value,vertex+m_offsets[axis],size);
+      if(m_bigEndian)
+      {
+        std::reverse(value,value+size);
+      }
+      float v;
+      if(m_double)
+      {
+        double d;
+        std::memcpy(&d,value,sizeof(double));
+        v=static_cast<float>(d);
+      }
+      else
+      {
+        std::memcpy(&v,value,sizeof(float));
+      }
+      m_scratch[i*3+axis]=v;
+    }
+  }
+}
+
+void PointCloudLoader::growBounds(const float *_xyz, size_t _count)
+{
+  for(size_t i=0; i<_count; ++i)
+  {
+    for(int axis=0; axis<3; ++axis)
+    {
+      float v=_xyz[i*3+axis];
+      m_min[axis]=std::min(m_min[axis],v);
+      m_max[axis]=std::max(m_max[axis],v);
+    }
+  }
+}
+
+double PointCloudLoader::throughput() const
+{
+  if(m_loadNs == 0)
+  {
+    return 0.0;
+  }
+  return (m_bytesRead/s_mb)/(m_loadNs/1.0e9);
+}
+
+bool PointCloudLoader::writeRaw(const std::string &_fname, const float *_xyz, size_t _count)
+{
+  std::ofstream file(_fname,std::ios::binary);
+  if(!file.is_open())
+  {
+    std::cerr<<"unable to open "<<_fname<<" for writing\n";
+    return false;
+  }
+  file.write(reinterpret_cast<const char *>(_xyz),static_cast<std::streamsize>(_count*3*sizeof(float)));
+  return file.good();
+}
+
+bool PointCloudLoader::writePLY(const std::string &_fname, const float *_xyz, size_t _count, bool _withColour)
+{
+  std::ofstream file(_fname,std::ios::binary);
+  if(!file.is_open())
+  {
+    std::cerr<<"unable to open "<<_fname<<" for writing\n";
+    return false;
+  }
+  // the floats are written as they are in memory so this assumes a little endian host
+  std::string header="element vertex "+std::to_string(_count)+"\nproperty float x\nproperty float y\nproperty float z\n";
+  if(_withColour)
+  {
+    header+="property uchar red\nproperty uchar green\nproperty uchar blue\n";
+  }
+  header+="end_header\n";
+  // pad the comment so the vertex data is float aligned and can be uploaded straight from the mapping
+  std::string comment="ply\nformat binary_little_endian 1.0\ncomment written by PointCloudLoader";
+  comment.append((4-(comment.size()+1+header.size())%4)%4,' ');
+  file<<comment<<'\n'<<header;
+  if(!_withColour)
+  {
+    file.write(reinterpret_cast<const char *>(_xyz),static_cast<std::streamsize>(_count*3*sizeof(float)));
+    return file.good();
+  }
+  for(size_t i=0; i<_count; ++i)
+  {
+    file.write(reinterpret_cast<const char *>(_xyz+i*3),3*sizeof(float));
+    const unsigned char colour[3]={255,255,255};
+    file.write(reinterpret_cast<const char *>(colour),sizeof(colour));
+  }
+  return file.good();
+}
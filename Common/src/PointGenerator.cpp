@@ -0,0 +1,255 @@
+#include "PointGenerator.h"
+#include "Philox.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+// the SIMD kernels are compiled with target attributes and picked at runtime so the
+// rest of the program doesn't need to be built with -mavx2
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #define POINTGENERATOR_X86
+  #include <immintrin.h>
+  #define POINTGENERATOR_TARGET(x) __attribute__((target(x)))
+#endif
+
+namespace
+{
+  /// @brief the random words are 24 bit signed values once shifted and offset, this is 2^23
+  constexpr int32_t s_half=0x800000;
+  /// @brief the minimum number of points each thread is given
+  constexpr size_t s_grain=16384;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief reference kernel, everything else must match this bit for bit
+  //----------------------------------------------------------------------------------------------------------------------
+  void generateScalar(float *o_xyz, size_t _count, uint64_t _first, uint64_t _seed, const float *_scale)
+  {
+    for(size_t i=0; i<_count; ++i)
+    {
+      philox::Block r=philox::generate(_first+i,0,_seed);
+      for(int c=0; c<3; ++c)
+      {
+        int32_t s=static_cast<int32_t>(r.v[c]>>8)-s_half;
+        o_xyz[i*3+c]=static_cast<float>(s)*_scale[c];
+      }
+    }
+  }
+
+#ifdef POINTGENERATOR_X86
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert 4 points from SoA x,y,z registers to AoS and store them
+  //----------------------------------------------------------------------------------------------------------------------
+  POINTGENERATOR_TARGET("sse4.1")
+  inline void storeInterleaved(float *o_xyz, __m128 _x, __m128 _y, __m128 _z)
+  {
+    __m128 xyLo=_mm_unpacklo_ps(_x,_y); // x0 y0 x1 y1
+    __m128 xyHi=_mm_unpackhi_ps(_x,_y); // x2 y2 x3 y3
+    __m128 yzLo=_mm_unpacklo_ps(_y,_z); // y0 z0 y1 z1
+    __m128 yzHi=_mm_unpackhi_ps(_y,_z); // y2 z2 y3 z3
+    __m128 zxLo=_mm_unpacklo_ps(_z,_x); // z0 x0 z1 x1
+    __m128 zxHi=_mm_unpackhi_ps(_z,_x); // z2 x2 z3 x3
+    _mm_storeu_ps(o_xyz,  _mm_shuffle_ps(xyLo,zxLo,_MM_SHUFFLE(3,0,1,0))); // x0 y0 z0 x1
+    _mm_storeu_ps(o_xyz+4,_mm_shuffle_ps(yzLo,xyHi,_MM_SHUFFLE(1,0,3,2))); // y1 z1 x2 y2
+    _mm_storeu_ps(o_xyz+8,_mm_shuffle_ps(zxHi,yzHi,_MM_SHUFFLE(3,2,3,0))); // z2 x3 y3 z3
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 4 wide 32x32 -> 64 multiply split into hi and lo words
+  //----------------------------------------------------------------------------------------------------------------------
+  POINTGENERATOR_TARGET("sse4.1")
+  inline void mulhilo4(__m128i _a, __m128i _m, __m128i &o_hi, __m128i &o_lo)
+  {
+    __m128i even=_mm_mul_epu32(_a,_m);
+    __m128i odd=_mm_mul_epu32(_mm_srli_epi64(_a,32),_m);
+    o_lo=_mm_blend_epi16(even,_mm_slli_epi64(odd,32),0xCC);
+    o_hi=_mm_blend_epi16(_mm_srli_epi64(even,32),odd,0xCC);
+  }
+
+  POINTGENERATOR_TARGET("sse4.1")
+  void generateSSE41(float *o_xyz, size_t _count, uint64_t _first, uint64_t _seed, const float *_scale)
+  {
+    const __m128i m0=_mm_set1_epi32(static_cast<int>(philox::M0));
+    const __m128i m1=_mm_set1_epi32(static_cast<int>(philox::M1));
+    const __m128i lane=_mm_setr_epi32(0,1,2,3);
+    const __m128i half=_mm_set1_epi32(s_half);
+    const __m128 sx=_mm_set1_ps(_scale[0]);
+    const __m128 sy=_mm_set1_ps(_scale[1]);
+    const __m128 sz=_mm_set1_ps(_scale[2]);
+    size_t i=0;
+    for(; i+4<=_count; i+=4)
+    {
+      uint64_t index=_first+i;
+      uint32_t lo=static_cast<uint32_t>(index);
+      // the low word would wrap inside this block, rare enough to leave to the scalar kernel
+      if(lo > 0xFFFFFFFFu-3)
+      {
+        generateScalar(o_xyz+i*3,4,index,_seed,_scale);
+        continue;
+      }
+      __m128i c0=_mm_add_epi32(_mm_set1_epi32(static_cast<int>(lo)),lane);
+      __m128i c1=_mm_set1_epi32(static_cast<int>(index>>32));
+      __m128i c2=_mm_setzero_si128();
+      __m128i c3=_mm_setzero_si128();
+      uint32_t k0=static_cast<uint32_t>(_seed);
+      uint32_t k1=static_cast<uint32_t>(_seed>>32);
+      for(int r=0; r<philox::Rounds; ++r)
+      {
+        __m128i hi0,lo0,hi1,lo1;
+        mulhilo4(c0,m0,hi0,lo0);
+        mulhilo4(c2,m1,hi1,lo1);
+        c0=_mm_xor_si128(_mm_xor_si128(hi1,c1),_mm_set1_epi32(static_cast<int>(k0)));
+        c1=lo1;
+        c2=_mm_xor_si128(_mm_xor_si128(hi0,c3),_mm_set1_epi32(static_cast<int>(k1)));
+        c3=lo0;
+        k0+=philox::W0;
+        k1+=philox::W1;
+      }
+      // words 0,1,2 of the result are x,y,z
+      __m128 x=_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(c0,8),half)),sx);
+      __m128 y=_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(c1,8),half)),sy);
+      __m128 z=_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(c2,8),half)),sz);
+      storeInterleaved(o_xyz+i*3,x,y,z);
+    }
+    generateScalar(o_xyz+i*3,_count-i,_first+i,_seed,_scale);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief 8 wide 32x32 -> 64 multiply split into hi and lo words
+  //----------------------------------------------------------------------------------------------------------------------
+  POINTGENERATOR_TARGET("avx2")
+  inline void mulhilo8(__m256i _a, __m256i _m, __m256i &o_hi, __m256i &o_lo)
+  {
+    __m256i even=_mm256_mul_epu32(_a,_m);
+    __m256i odd=_mm256_mul_epu32(_mm256_srli_epi64(_a,32),_m);
+    o_lo=_mm256_blend_epi32(even,_mm256_slli_epi64(odd,32),0xAA);
+    o_hi=_mm256_blend_epi32(_mm256_srli_epi64(even,32),odd,0xAA);
+  }
+
+  POINTGENERATOR_TARGET("avx2")
+  void generateAVX2(float *o_xyz, size_t _count, uint64_t _first, uint64_t _seed, const float *_scale)
+  {
+    const __m256i m0=_mm256_set1_epi32(static_cast<int>(philox::M0));
+    const __m256i m1=_mm256_set1_epi32(static_cast<int>(philox::M1));
+    const __m256i lane=_mm256_setr_epi32(0,1,2,3,4,5,6,7);
+    const __m256i half=_mm256_set1_epi32(s_half);
+    const __m256 sx=_mm256_set1_ps(_scale[0]);
+    const __m256 sy=_mm256_set1_ps(_scale[1]);
+    const __m256 sz=_mm256_set1_ps(_scale[2]);
+    size_t i=0;
+    for(; i+8<=_count; i+=8)
+    {
+      uint64_t index=_first+i;
+      uint32_t lo=static_cast<uint32_t>(index);
+      if(lo > 0xFFFFFFFFu-7)
+      {
+        generateScalar(o_xyz+i*3,8,index,_seed,_scale);
+        continue;
+      }
+      __m256i c0=_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(lo)),lane);
+      __m256i c1=_mm256_set1_epi32(static_cast<int>(index>>32));
+      __m256i c2=_mm256_setzero_si256();
+      __m256i c3=_mm256_setzero_si256();
+      uint32_t k0=static_cast<uint32_t>(_seed);
+      uint32_t k1=static_cast<uint32_t>(_seed>>32);
+      for(int r=0; r<philox::Rounds; ++r)
+      {
+        __m256i hi0,lo0,hi1,lo1;
+        mulhilo8(c0,m0,hi0,lo0);
+        mulhilo8(c2,m1,hi1,lo1);
+        c0=_mm256_xor_si256(_mm256_xor_si256(hi1,c1),_mm256_set1_epi32(static_cast<int>(k0)));
+        c1=lo1;
+        c2=_mm256_xor_si256(_mm256_xor_si256(hi0,c3),_mm256_set1_epi32(static_cast<int>(k1)));
+        c3=lo0;
+        k0+=philox::W0;
+        k1+=philox::W1;
+      }
+      __m256 x=_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(c0,8),half)),sx);
+      __m256 y=_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(c1,8),half)),sy);
+      __m256 z=_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(c2,8),half)),sz);
+      // interleave each 128 bit half, 4 points at a time
+      storeInterleaved(o_xyz+i*3,_mm256_castps256_ps128(x),_mm256_castps256_ps128(y),_mm256_castps256_ps128(z));
+      storeInterleaved(o_xyz+i*3+12,_mm256_extractf128_ps(x,1),_mm256_extractf128_ps(y,1),_mm256_extractf128_ps(z,1));
+    }
+    // the compiler doesn't add this for a target attribute function, without it every SSE instruction
+    // after us (libm included) pays the AVX to SSE transition penalty
+    _mm256_zeroupper();
+    generateScalar(o_xyz+i*3,_count-i,_first+i,_seed,_scale);
+  }
+#endif
+}
+
+PointGenerator::PointGenerator(uint64_t _seed) : m_seed(_seed)
+{
+  setExtents(5.0f,5.0f,5.0f);
+}
+
+void PointGenerator::setExtents(float _x, float _y, float _z)
+{
+  // multiplying by a power of two is exact so every kernel gets the same scale
+  m_scale[0]=_x*(1.0f/s_half);
+  m_scale[1]=_y*(1.0f/s_half);
+  m_scale[2]=_z*(1.0f/s_half);
+}
+
+bool PointGenerator::isSupported(Kernel _kernel)
+{
+  switch(_kernel)
+  {
+    case Kernel::Auto :
+    case Kernel::Scalar : return true;
+#ifdef POINTGENERATOR_X86
+    case Kernel::SSE41 : __builtin_cpu_init(); return __builtin_cpu_supports("sse4.1");
+    case Kernel::AVX2 : __builtin_cpu_init(); return __builtin_cpu_supports("avx2");
+#endif
+    default : return false;
+  }
+}
+
+PointGenerator::Kernel PointGenerator::bestKernel()
+{
+  static Kernel s_best= isSupported(Kernel::AVX2) ? Kernel::AVX2 :
+                        isSupported(Kernel::SSE41) ? Kernel::SSE41 : Kernel::Scalar;
+  return s_best;
+}
+
+PointGenerator::Kernel PointGenerator::resolve(Kernel _kernel)
+{
+  if(_kernel == Kernel::Auto || !isSupported(_kernel))
+  {
+    return bestKernel();
+  }
+  return _kernel;
+}
+
+const char *PointGenerator::kernelName(Kernel _kernel)
+{
+  switch(_kernel)
+  {
+    case Kernel::Auto : return "auto";
+    case Kernel::Scalar : return "scalar";
+    case Kernel::SSE41 : return "sse4.1";
+    case Kernel::AVX2 : return "avx2";
+  }
+  return "unknown";
+}
+
+void PointGenerator::generateSerial(float *o_xyz, size_t _count, uint64_t _firstIndex, Kernel _kernel) const
+{
+  switch(resolve(_kernel))
+  {
+#ifdef POINTGENERATOR_X86
+    case Kernel::AVX2 : generateAVX2(o_xyz,_count,_firstIndex,m_seed,m_scale); break;
+    case Kernel::SSE41 : generateSSE41(o_xyz,_count,_firstIndex,m_seed,m_scale); break;
+#endif
+    default : generateScalar(o_xyz,_count,_firstIndex,m_seed,m_scale); break;
+  }
+}
+
+void PointGenerator::generate(float *o_xyz, size_t _count, uint64_t _firstIndex, Kernel _kernel) const
+{
+  TRACE_SCOPE("PointGenerator::generate");
+  Kernel kernel=resolve(_kernel);
+  ThreadPool::instance()->parallelFor(0,_count,[=](size_t _begin, size_t _end)
+  {
+    generateSerial(o_xyz+_begin*3,_end-_begin,_firstIndex+_begin,kernel);
+  },s_grain);
+}
@@ -0,0 +1,172 @@
+#include "ProceduralPoints.h"
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include "Philox.h"
+#include "ProgramCache.h"
+#include <algorithm>
+
+namespace
+{
+  /// @brief the name of the procedural shader program in the ngl::ShaderLib
+  const char *s_shaderProgram="ProceduralPoints";
+
+  /// @brief Philox4x32-10 with the counter (gl_VertexID,0,0,0), this must match philox::generate and
+  /// the scalar PointGenerator kernel, mulhiRef in this file mirrors mulhi. MVP comes from the FrameData block.
+  const char *s_vertexShader=R"(#version 330 core
+uniform uvec2 seed;
+uniform vec3 scale;
+uint mulhi(uint _a, uint _b)
+{
+  uint aLo=_a & 0xFFFFu;
+  uint aHi=_a >> 16u;
+  uint bLo=_b & 0xFFFFu;
+  uint bHi=_b >> 16u;
+  uint lo=aLo*bLo;
+  uint mid0=aHi*bLo;
+  uint mid1=aLo*bHi;
+  uint carry=((lo >> 16u)+(mid0 & 0xFFFFu)+(mid1 & 0xFFFFu)) >> 16u;
+  return aHi*bHi+(mid0 >> 16u)+(mid1 >> 16u)+carry;
+}
+void main()
+{
+  const uint M0=0xD2511F53u;
+  const uint M1=0xCD9E8D57u;
+  uvec4 c=uvec4(uint(gl_VertexID),0u,0u,0u);
+  uvec2 k=seed;
+  for(int r=0; r<10; ++r)
+  {
+    uint hi0=mulhi(M0,c.x);
+    uint lo0=M0*c.x;
+    uint hi1=mulhi(M1,c.z);
+    uint lo1=M1*c.z;
+    c=uvec4(hi1^c.y^k.x,lo1,hi0^c.w^k.y,lo0);
+    k+=uvec2(0x9E3779B9u,0xBB67AE85u);
+  }
+  // the top 24 bits as a signed value then scaled into the box
+  ivec3 s=ivec3(c.xyz >> 8u)-ivec3(0x800000);
+  gl_Position=MVP*vec4(vec3(s)*scale,1.0);
+}
+)";
+
+  const char *s_fragmentShader=R"(#version 330 core
+uniform vec4 Colour;
+layout (location=0) out vec4 fragColour;
+void main()
+{
+  fragColour=Colour;
+}
+)";
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the shader's mulhi in C++
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t mulhiRef(uint32_t _a, uint32_t _b)
+  {
+    uint32_t aLo=_a & 0xFFFFu;
+    uint32_t aHi=_a >> 16;
+    uint32_t bLo=_b & 0xFFFFu;
+    uint32_t bHi=_b >> 16;
+    uint32_t lo=aLo*bLo;
+    uint32_t mid0=aHi*bLo;
+    uint32_t mid1=aLo*bHi;
+    uint32_t carry=((lo >> 16)+(mid0 & 0xFFFFu)+(mid1 & 0xFFFFu)) >> 16;
+    return aHi*bHi+(mid0 >> 16)+(mid1 >> 16)+carry;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the shader's main in C++
+  //----------------------------------------------------------------------------------------------------------------------
+  void vertexRef(uint32_t _vertexID, uint64_t _seed, const float *_scale, float *o_xyz)
+  {
+    uint32_t c[4]={_vertexID,0u,0u,0u};
+    uint32_t k[2]={static_cast<uint32_t>(_seed),static_cast<uint32_t>(_seed>>32)};
+    for(int r=0; r<philox::Rounds; ++r)
+    {
+      uint32_t hi0=mulhiRef(philox::M0,c[0]);
+      uint32_t lo0=philox::M0*c[0];
+      uint32_t hi1=mulhiRef(philox::M1,c[2]);
+      uint32_t lo1=philox::M1*c[2];
+      uint32_t next[4]={hi1^c[1]^k[0],lo1,hi0^c[3]^k[1],lo0};
+      std::copy(next,next+4,c);
+      k[0]+=philox::W0;
+      k[1]+=philox::W1;
+    }
+    for(int axis=0; axis<3; ++axis)
+    {
+      int32_t s=static_cast<int32_t>(c[axis]>>8)-0x800000;
+      o_xyz[axis]=static_cast<float>(s)*_scale[axis];
+    }
+  }
+}
+
+ProceduralPoints::ProceduralPoints(uint64_t _seed) : m_seed(_seed)
+{
+  setExtents(5.0f,5.0f,5.0f);
+}
+
+ProceduralPoints::~ProceduralPoints()
+{
+  release();
+}
+
+void ProceduralPoints::setExtents(float _x, float _y, float _z)
+{
+  // the same power of two scale as PointGenerator so the points match exactly
+  m_scale[0]=_x*(1.0f/0x800000);
+  m_scale[1]=_y*(1.0f/0x800000);
+  m_scale[2]=_z*(1.0f/0x800000);
+}
+
+void ProceduralPoints::point(uint32_t _index, float *o_xyz) const
+{
+  vertexRef(_index,m_seed,m_scale,o_xyz);
+}
+
+void ProceduralPoints::createShader()
+{
+  m_program=ProgramCache::instance()->program(s_shaderProgram,{{ngl::ShaderType::VERTEX,FrameUniforms::withBlock(s_vertexShader)},
+                                                               {ngl::ShaderType::FRAGMENT,s_fragmentShader}},[](GLuint _program)
+  {
+    FrameUniforms::attach(_program);
+    // the colour never changes so is set once
+    glUniform4f(glGetUniformLocation(_program,"Colour"),1.0f,1.0f,1.0f,1.0f);
+  });
+  m_seedLocation=glGetUniformLocation(m_program,"seed");
+  m_scaleLocation=glGetUniformLocation(m_program,"scale");
+}
+
+void ProceduralPoints::bind()
+{
+  if(m_vao == 0)
+  {
+    createShader();
+    glGenVertexArrays(1,&m_vao);
+  }
+  GLState *state=GLState::instance();
+  state->useProgram(m_program);
+  glUniform3f(m_scaleLocation,m_scale[0],m_scale[1],m_scale[2]);
+  // the 64 bit seed is the Philox key
+  glUniform2ui(m_seedLocation,static_cast<GLuint>(m_seed),static_cast<GLuint>(m_seed>>32));
+  state->bindVertexArray(m_vao);
+}
+
+void ProceduralPoints::unbind() const
+{
+  GLState::instance()->unbindVertexArray();
+}
+
+void ProceduralPoints::draw()
+{
+  bind();
+  GLState::instance()->drawArrays(GL_POINTS,0,static_cast<GLsizei>(m_count));
+  unbind();
+}
+
+void ProceduralPoints::release()
+{
+  if(m_vao != 0)
+  {
+    GLState::instance()->deleteVertexArrays(1,&m_vao);
+    m_vao=0;
+  }
+}
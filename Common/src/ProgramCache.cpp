@@ -0,0 +1,328 @@
+#include "ProgramCache.h"
+#include "GLState.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QOpenGLContext>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+  /// @brief the start of every cache file, the number is bumped if the layout changes
+  const char s_magic[4]={'N','P','P','C'};
+  const uint32_t s_version=1;
+
+  /// @brief the header of a cache file, the binary follows it
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t pad;
+    uint64_t length;
+  };
+
+  std::string glString(GLenum _name)
+  {
+    const GLubyte *value=glGetString(_name);
+    return value != nullptr ? reinterpret_cast<const char *>(value) : "";
+  }
+
+  /// @brief the ShaderLib names the shaders of a program after the program and their stage
+  const char *stageName(ngl::ShaderType _type)
+  {
+    switch(_type)
+    {
+      case ngl::ShaderType::VERTEX : return "Vertex";
+      case ngl::ShaderType::FRAGMENT : return "Fragment";
+      case ngl::ShaderType::GEOMETRY : return "Geometry";
+      case ngl::ShaderType::TESSCONTROL : return "TessControl";
+      case ngl::ShaderType::TESSEVAL : return "TessEval";
+      case ngl::ShaderType::COMPUTE : return "Compute";
+      default : return "Shader";
+    }
+  }
+
+  double msSince(std::chrono::steady_clock::time_point _start)
+  {
+    return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-_start).count();
+  }
+}
+
+ProgramCache::ProgramCache() : m_dir(defaultDirectory())
+{
+}
+
+ProgramCache *ProgramCache::instance()
+{
+  static ProgramCache s_cache;
+  return &s_cache;
+}
+
+std::string ProgramCache::defaultDirectory()
+{
+  return QDir::tempPath().toStdString()+"/NGLPointsPrograms";
+}
+
+void ProgramCache::setDirectory(const std::string &_dir)
+{
+  m_dir=_dir;
+}
+
+bool ProgramCache::isSupported()
+{
+  QOpenGLContext *context=QOpenGLContext::currentContext();
+  if(context == nullptr)
+  {
+    return false;
+  }
+  if(context->format().version() < qMakePair(4,1) && !context->hasExtension("GL_ARB_get_program_binary"))
+  {
+    return false;
+  }
+  // some drivers have the entry points but no formats to save in
+  GLint formats=0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+  return formats > 0;
+}
+
+uint64_t ProgramCache::hash(const std::vector<std::string> &_strings)
+{
+  uint64_t h=0xcbf29ce484222325ull;
+  for(const auto &s : _strings)
+  {
+    for(unsigned char c : s)
+    {
+      h=(h^c)*0x100000001b3ull;
+    }
+    // a separator so {"ab","c"} and {"a","bc"} differ
+    h=(h^0xff)*0x100000001b3ull;
+  }
+  return h;
+}
+
+std::string ProgramCache::fileName(const std::string &_name, uint64_t _key) const
+{
+  char key[17];
+  std::snprintf(key,sizeof(key),"%016llx",static_cast<unsigned long long>(_key));
+  return m_dir+"/"+_name+"-"+key+".bin";
+}
+
+GLuint ProgramCache::build(const std::string &_name, const std::vector<Stage> &_stages,
+                           const std::vector<std::string> &_varyings)
+{
+  auto start=std::chrono::steady_clock::now();
+  bool cached=!m_dir.empty() && isSupported();
+  uint64_t key=0;
+  std::string file;
+  if(cached)
+  {
+    // a binary is only good for the same sources on the same driver
+    std::vector<std::string> strings={_name,glString(GL_VENDOR),glString(GL_RENDERER),glString(GL_VERSION),
+                                      glString(GL_SHADING_LANGUAGE_VERSION)};
+    for(const auto &stage : _stages)
+    {
+      strings.push_back(stageName(stage.type));
+      strings.push_back(stage.source);
+    }
+    // the captured outputs are part of the linked program, nothing is added without them so other keys are unchanged
+    if(!_varyings.empty())
+    {
+      strings.push_back("varyings");
+      strings.insert(strings.end(),_varyings.begin(),_varyings.end());
+    }
+    key=hash(strings);
+    file=fileName(_name,key);
+    GLuint program=load(file,key);
+    if(program != 0)
+    {
+      ++m_stats.loaded;
+      m_stats.loadMs+=msSince(start);
+      return program;
+    }
+  }
+  GLuint program=compile(_name,_stages,_varyings,cached);
+  if(program != 0 && cached)
+  {
+    save(program,file,key);
+  }
+  ++m_stats.compiled;
+  m_stats.compileMs+=msSince(start);
+  return program;
+}
+
+GLuint ProgramCache::program(const std::string &_name, const std::vector<Stage> &_stages,
+                             const std::function<void(GLuint)> &_setup, const std::vector<std::string> &_varyings)
+{
+  QOpenGLContext *context=QOpenGLContext::currentContext();
+  if(context == nullptr)
+  {
+    return 0;
+  }
+  // programs are shared objects so one build serves every context sharing with this one
+  QOpenGLContextGroup *group=context->shareGroup();
+  auto known=m_programs.find(group);
+  if(known == m_programs.end())
+  {
+    // the programs went with the group's last context, a new group at the same address has to build them again
+    QObject::connect(group,&QObject::destroyed,[this,group]{m_programs.erase(group);});
+    known=m_programs.emplace(group,std::map<std::string,GLuint>()).first;
+  }
+  auto found=known->second.find(_name);
+  if(found != known->second.end())
+  {
+    return found->second;
+  }
+  GLuint program=build(_name,_stages,_varyings);
+  if(program != 0 && _setup)
+  {
+    glUseProgram(program);
+    _setup(program);
+  }
+  // the ShaderLib and the setup changed the program behind the GLState cache
+  GLState::instance()->invalidate();
+  known->second[_name]=program;
+  return program;
+}
+
+GLuint ProgramCache::load(const std::string &_file, uint64_t _key)
+{
+  GLenum format;
+  std::vector<char> binary;
+  if(!readFile(_file,_key,format,binary))
+  {
+    return 0;
+  }
+  GLuint program=glCreateProgram();
+  glProgramBinary(program,format,binary.data(),static_cast<GLsizei>(binary.size()));
+  GLint linked=GL_FALSE;
+  glGetProgramiv(program,GL_LINK_STATUS,&linked);
+  if(linked != GL_TRUE)
+  {
+    // the driver may refuse its own binaries after an update that kept the version string
+    std::cerr<<"ProgramCache : the driver rejected "<<_file<<", compiling it again\n";
+    glDeleteProgram(program);
+    std::remove(_file.c_str());
+    ++m_stats.rejected;
+    return 0;
+  }
+  return program;
+}
+
+GLuint ProgramCache::compile(const std::string &_name, const std::vector<Stage> &_stages,
+                             const std::vector<std::string> &_varyings, bool _retrievable)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->createShaderProgram(_name);
+  for(const auto &stage : _stages)
+  {
+    std::string stageShader=_name+stageName(stage.type);
+    shader->attachShader(stageShader,stage.type);
+    shader->loadShaderSourceFromString(stageShader,stage.source);
+    shader->compileShader(stageShader);
+    shader->attachShaderToProgram(_name,stageShader);
+  }
+  GLuint program=shader->getProgramID(_name);
+  if(!_varyings.empty())
+  {
+    std::vector<const char *> names;
+    for(const auto &varying : _varyings)
+    {
+      names.push_back(varying.c_str());
+    }
+    glTransformFeedbackVaryings(program,static_cast<GLsizei>(names.size()),names.data(),GL_INTERLEAVED_ATTRIBS);
+  }
+  if(_retrievable)
+  {
+    // some drivers only keep a binary they were asked for before linking
+    glProgramParameteri(program,GL_PROGRAM_BINARY_RETRIEVABLE_HINT,GL_TRUE);
+  }
+  shader->linkProgramObject(_name);
+  GLint linked=GL_FALSE;
+  glGetProgramiv(program,GL_LINK_STATUS,&linked);
+  return linked == GL_TRUE ? program : 0;
+}
+
+void ProgramCache::save(GLuint _program, const std::string &_file, uint64_t _key)
+{
+  GLint length=0;
+  glGetProgramiv(_program,GL_PROGRAM_BINARY_LENGTH,&length);
+  if(length <= 0)
+  {
+    return;
+  }
+  std::vector<char> binary(static_cast<size_t>(length));
+  GLsizei written=0;
+  GLenum format=0;
+  glGetProgramBinary(_program,length,&written,&format,binary.data());
+  binary.resize(static_cast<size_t>(written));
+  if(binary.empty() || !QDir().mkpath(QString::fromStdString(m_dir)) || !writeFile(_file,_key,format,binary))
+  {
+    std::cerr<<"ProgramCache : couldn't save "<<_file<<"\n";
+  }
+}
+
+bool ProgramCache::writeFile(const std::string &_file, uint64_t _key, GLenum _format, const std::vector<char> &_binary)
+{
+  Header header;
+  std::memcpy(header.magic,s_magic,sizeof(s_magic));
+  header.version=s_version;
+  header.key=_key;
+  header.format=_format;
+  header.pad=0;
+  header.length=_binary.size();
+  // written beside and renamed into place so another process never reads half a file
+  std::string temp=_file+"."+std::to_string(QCoreApplication::applicationPid())+".tmp";
+  {
+    std::ofstream file(temp,std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header),sizeof(Header));
+    file.write(_binary.data(),static_cast<std::streamsize>(_binary.size()));
+    if(!file)
+    {
+      file.close();
+      std::remove(temp.c_str());
+      return false;
+    }
+  }
+  return std::rename(temp.c_str(),_file.c_str()) == 0;
+}
+
+bool ProgramCache::readFile(const std::string &_file, uint64_t _key, GLenum &o_format, std::vector<char> &o_binary)
+{
+  std::ifstream file(_file,std::ios::binary | std::ios::ate);
+  if(!file)
+  {
+    return false;
+  }
+  std::streamoff size=file.tellg();
+  Header header;
+  if(size < static_cast<std::streamoff>(sizeof(Header)) || !file.seekg(0).read(reinterpret_cast<char *>(&header),sizeof(Header)))
+  {
+    return false;
+  }
+  if(std::memcmp(header.magic,s_magic,sizeof(s_magic)) != 0 || header.version != s_version || header.key != _key ||
+     header.length != static_cast<uint64_t>(size)-sizeof(Header))
+  {
+    return false;
+  }
+  o_format=header.format;
+  o_binary.resize(header.length);
+  return static_cast<bool>(file.read(o_binary.data(),static_cast<std::streamsize>(o_binary.size())));
+}
+
+std::string ProgramCache::summary() const
+{
+  char buffer[256];
+  std::snprintf(buffer,sizeof(buffer),"programs: %u loaded from the cache in %.1f ms, %u compiled in %.1f ms, %u rejected",
+                m_stats.loaded,m_stats.loadMs,m_stats.compiled,m_stats.compileMs,m_stats.rejected);
+  std::string line=buffer;
+  if(m_dir.empty())
+  {
+    line+=" (cache off)";
+  }
+  return line;
+}
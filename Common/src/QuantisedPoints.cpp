@@ -0,0 +1,262 @@
+#include "QuantisedPoints.h"
+#include "FrameUniforms.h"
+#include "GLState.h"
+#include "ProgramCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  /// @brief the name of the dequantising shader program in the ngl::ShaderLib
+  const char *s_shaderProgram="QuantisedPoints";
+
+  /// @brief the bounds of the point's chunk are fetched from the buffer texture, the attribute is
+  /// already normalised to 0 -> 1 by the vertex fetch. MVP comes from the FrameData block.
+  const char *s_vertexShader=R"(#version 330 core
+layout (location=0) in vec3 inPosition;
+uniform samplerBuffer chunkBounds;
+uniform int chunkShift;
+void main()
+{
+  int chunk=gl_VertexID >> chunkShift;
+  vec3 minCorner=texelFetch(chunkBounds,chunk*2).xyz;
+  vec3 extent=texelFetch(chunkBounds,chunk*2+1).xyz;
+  gl_Position=MVP*vec4(minCorner+inPosition*extent,1.0);
+}
+)";
+
+  const char *s_fragmentShader=R"(#version 330 core
+uniform vec4 Colour;
+layout (location=0) out vec4 fragColour;
+void main()
+{
+  fragColour=Colour;
+}
+)";
+}
+
+QuantisedPoints::QuantisedPoints(Format _format, unsigned int _chunkShift) :
+  m_format(_format),
+  m_chunkShift(std::min(_chunkShift,24u))
+{
+}
+
+QuantisedPoints::~QuantisedPoints()
+{
+  release();
+}
+
+const char *QuantisedPoints::formatName(Format _format)
+{
+  return _format == Format::Short ? "short" : "1010102";
+}
+
+void QuantisedPoints::quantise(const float *_xyz, size_t _count)
+{
+  m_count=_count;
+  m_data.resize(_count*bytesPerPoint());
+  size_t chunkSize=size_t(1)<<m_chunkShift;
+  size_t numChunks=(_count+chunkSize-1)/chunkSize;
+  m_bounds.assign(numChunks*8,0.0f);
+  const float maxQ=maxValue();
+  ThreadPool::instance()->parallelFor(0,numChunks,[&](size_t _begin, size_t _end)
+  {
+    for(size_t c=_begin; c<_end; ++c)
+    {
+      size_t first=c*chunkSize;
+      size_t last=std::min(first+chunkSize,_count);
+      float min[3];
+      float max[3];
+      std::fill(min,min+3,std::numeric_limits<float>::max());
+      std::fill(max,max+3,std::numeric_limits<float>::lowest());
+      for(size_t i=first; i<last; ++i)
+      {
+        for(int axis=0; axis<3; ++axis)
+        {
+          min[axis]=std::min(min[axis],_xyz[i*3+axis]);
+          max[axis]=std::max(max[axis],_xyz[i*3+axis]);
+        }
+      }
+      float *bounds=&m_bounds[c*8];
+      float scale[3];
+      for(int axis=0; axis<3; ++axis)
+      {
+        float extent=max[axis]-min[axis];
+        bounds[axis]=min[axis];
+        bounds[4+axis]=extent;
+        scale[axis]= extent > 0.0f ? maxQ/extent : 0.0f;
+      }
+      for(size_t i=first; i<last; ++i)
+      {
+        uint32_t q[3];
+        for(int axis=0; axis<3; ++axis)
+        {
+          float v=std::round((_xyz[i*3+axis]-min[axis])*scale[axis]);
+          q[axis]=static_cast<uint32_t>(std::min(std::max(v,0.0f),maxQ));
+        }
+        if(m_format == Format::Short)
+        {
+          uint16_t packed[3]={uint16_t(q[0]),uint16_t(q[1]),uint16_t(q[2])};
+          std::memcpy(&m_data[i*sizeof(packed)],packed,sizeof(packed));
+        }
+        else
+        {
+          // x in the low bits, w set to 1
+          uint32_t packed=q[0] | (q[1]<<10) | (q[2]<<20) | (3u<<30);
+          std::memcpy(&m_data[i*sizeof(packed)],&packed,sizeof(packed));
+        }
+      }
+    }
+  },1);
+}
+
+void QuantisedPoints::dequantise(size_t _index, float *o_xyz) const
+{
+  uint32_t q[3];
+  if(m_format == Format::Short)
+  {
+    uint16_t packed[3];
+    std::memcpy(packed,&m_data[_index*sizeof(packed)],sizeof(packed));
+    std::copy(packed,packed+3,q);
+  }
+  else
+  {
+    uint32_t packed;
+    std::memcpy(&packed,&m_data[_index*sizeof(packed)],sizeof(packed));
+    q[0]=packed & 1023u;
+    q[1]=(packed>>10) & 1023u;
+    q[2]=(packed>>20) & 1023u;
+  }
+  // the same sums as the vertex shader
+  const float *bounds=&m_bounds[(_index>>m_chunkShift)*8];
+  for(int axis=0; axis<3; ++axis)
+  {
+    o_xyz[axis]=bounds[axis]+(q[axis]/maxValue())*bounds[4+axis];
+  }
+}
+
+void QuantisedPoints::errorBound(float *o_xyz) const
+{
+  std::fill(o_xyz,o_xyz+3,0.0f);
+  for(size_t i=0; i<m_bounds.size(); i+=8)
+  {
+    for(int axis=0; axis<3; ++axis)
+    {
+      o_xyz[axis]=std::max(o_xyz[axis],m_bounds[i+4+axis]*0.5f/maxValue());
+    }
+  }
+}
+
+size_t QuantisedPoints::bytes() const
+{
+  return m_data.size()+m_bounds.size()*sizeof(float);
+}
+
+void QuantisedPoints::createShader()
+{
+  m_program=ProgramCache::instance()->program(s_shaderProgram,{{ngl::ShaderType::VERTEX,FrameUniforms::withBlock(s_vertexShader)},
+                                                               {ngl::ShaderType::FRAGMENT,s_fragmentShader}},[](GLuint _program)
+  {
+    FrameUniforms::attach(_program);
+    // the colour and sampler unit never change so are set once
+    glUniform4f(glGetUniformLocation(_program,"Colour"),1.0f,1.0f,1.0f,1.0f);
+    glUniform1i(glGetUniformLocation(_program,"chunkBounds"),0);
+  });
+  m_chunkShiftLocation=glGetUniformLocation(m_program,"chunkShift");
+}
+
+void QuantisedPoints::upload()
+{
+  if(m_vao == 0)
+  {
+    createShader();
+    glGenVertexArrays(1,&m_vao);
+    glGenBuffers(1,&m_vbo);
+    glGenBuffers(1,&m_boundsBuffer);
+    glGenTextures(1,&m_boundsTexture);
+  }
+  if(m_count == 0)
+  {
+    return;
+  }
+  GLState *state=GLState::instance();
+  state->bindVertexArray(m_vao);
+  state->bindBuffer(GL_ARRAY_BUFFER,m_vbo);
+  // like PointBuffer the storage only grows, a smaller set is written into the old buffer
+  if(m_data.size() > m_vboCapacity)
+  {
+    state->bufferData(GL_ARRAY_BUFFER,m_data.size(),m_data.data(),GL_STATIC_DRAW);
+    m_vboCapacity=m_data.size();
+  }
+  else
+  {
+    state->bufferSubData(GL_ARRAY_BUFFER,0,m_data.size(),m_data.data());
+  }
+  if(m_format == Format::Short)
+  {
+    glVertexAttribPointer(0,3,GL_UNSIGNED_SHORT,GL_TRUE,0,nullptr);
+  }
+  else
+  {
+    glVertexAttribPointer(0,4,GL_UNSIGNED_INT_2_10_10_10_REV,GL_TRUE,0,nullptr);
+  }
+  glEnableVertexAttribArray(0);
+  state->unbindVertexArray();
+
+  size_t boundsBytes=m_bounds.size()*sizeof(float);
+  glBindBuffer(GL_TEXTURE_BUFFER,m_boundsBuffer);
+  if(boundsBytes > m_boundsCapacity)
+  {
+    state->bufferData(GL_TEXTURE_BUFFER,boundsBytes,m_bounds.data(),GL_STATIC_DRAW);
+    m_boundsCapacity=boundsBytes;
+  }
+  else
+  {
+    state->bufferSubData(GL_TEXTURE_BUFFER,0,boundsBytes,m_bounds.data());
+  }
+  glBindTexture(GL_TEXTURE_BUFFER,m_boundsTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER,GL_RGBA32F,m_boundsBuffer);
+  glBindTexture(GL_TEXTURE_BUFFER,0);
+  glBindBuffer(GL_TEXTURE_BUFFER,0);
+}
+
+void QuantisedPoints::bind() const
+{
+  GLState *state=GLState::instance();
+  state->useProgram(m_program);
+  glUniform1i(m_chunkShiftLocation,static_cast<int>(m_chunkShift));
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER,m_boundsTexture);
+  state->bindVertexArray(m_vao);
+}
+
+void QuantisedPoints::unbind() const
+{
+  GLState::instance()->unbindVertexArray();
+  glBindTexture(GL_TEXTURE_BUFFER,0);
+}
+
+void QuantisedPoints::draw() const
+{
+  bind();
+  GLState::instance()->drawArrays(GL_POINTS,0,static_cast<GLsizei>(m_count));
+  unbind();
+}
+
+void QuantisedPoints::release()
+{
+  if(m_vao == 0)
+  {
+    return;
+  }
+  glDeleteTextures(1,&m_boundsTexture);
+  GLState *state=GLState::instance();
+  state->deleteBuffers(1,&m_boundsBuffer);
+  state->deleteBuffers(1,&m_vbo);
+  state->deleteVertexArrays(1,&m_vao);
+  m_vao=m_vbo=m_boundsBuffer=m_boundsTexture=0;
+  m_vboCapacity=m_boundsCapacity=0;
+}
@@ -0,0 +1,107 @@
+#include "ScratchPool.h"
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+  /// @brief sizes are rounded up to this so a slightly different point count reuses the same block
+  const size_t s_granularity=64*1024;
+}
+
+ScratchPool::Block::Block(ScratchPool *_pool, std::unique_ptr<char[]> _data, size_t _capacity) :
+  m_pool(_pool), m_data(std::move(_data)), m_capacity(_capacity)
+{
+}
+
+ScratchPool::Block::Block(Block &&_other) :
+  m_pool(_other.m_pool), m_data(std::move(_other.m_data)), m_capacity(_other.m_capacity)
+{
+  _other.m_pool=nullptr;
+  _other.m_capacity=0;
+}
+
+ScratchPool::Block & ScratchPool::Block::operator=(Block &&_other)
+{
+  if(this != &_other)
+  {
+    if(m_pool != nullptr && m_data)
+    {
+      m_pool->release(std::move(m_data),m_capacity);
+    }
+    m_pool=_other.m_pool;
+    m_data=std::move(_other.m_data);
+    m_capacity=_other.m_capacity;
+    _other.m_pool=nullptr;
+    _other.m_capacity=0;
+  }
+  return *this;
+}
+
+ScratchPool::Block::~Block()
+{
+  if(m_pool != nullptr && m_data)
+  {
+    m_pool->release(std::move(m_data),m_capacity);
+  }
+}
+
+ScratchPool *ScratchPool::instance()
+{
+  static ScratchPool s_pool;
+  return &s_pool;
+}
+
+ScratchPool::Block ScratchPool::acquire(size_t _bytes)
+{
+  size_t capacity=(std::max<size_t>(_bytes,1)+s_granularity-1)/s_granularity*s_granularity;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // the smallest idle block that fits wastes the least
+  size_t best=m_idle.size();
+  for(size_t i=0; i<m_idle.size(); ++i)
+  {
+    if(m_idle[i].capacity >= capacity && (best == m_idle.size() || m_idle[i].capacity < m_idle[best].capacity))
+    {
+      best=i;
+    }
+  }
+  if(best != m_idle.size())
+  {
+    Block block(this,std::move(m_idle[best].data),m_idle[best].capacity);
+    m_idle.erase(m_idle.begin()+static_cast<std::ptrdiff_t>(best));
+    ++m_stats.reuses;
+    return block;
+  }
+  // nothing fits, an idle block too small to use now is unlikely to be wanted again so give it back
+  // rather than holding both
+  if(!m_idle.empty())
+  {
+    m_stats.bytesHeld-=m_idle.back().capacity;
+    m_idle.pop_back();
+  }
+  ++m_stats.allocations;
+  m_stats.bytesAllocated+=capacity;
+  m_stats.bytesHeld+=capacity;
+  return Block(this,std::unique_ptr<char[]>(new char[capacity]),capacity);
+}
+
+void ScratchPool::release(std::unique_ptr<char[]> _data, size_t _capacity)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_idle.push_back({std::move(_data),_capacity});
+}
+
+void ScratchPool::trim()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for(auto &idle : m_idle)
+  {
+    m_stats.bytesHeld-=idle.capacity;
+  }
+  m_idle.clear();
+}
+
+ScratchPool::Stats ScratchPool::stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
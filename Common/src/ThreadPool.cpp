@@ -0,0 +1,122 @@
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool *ThreadPool::instance()
+{
+  static ThreadPool s_pool;
+  return &s_pool;
+}
+
+ThreadPool::ThreadPool(unsigned int _threads)
+{
+  if(_threads == 0)
+  {
+    _threads=std::max(1u,std::thread::hardware_concurrency());
+  }
+  // the caller of parallelFor does work too so we need one less worker, but always have
+  // one so tasks from submit run in the background even on a single core
+  for(unsigned int i=1; i<std::max(_threads,2u); ++i)
+  {
+    m_workers.emplace_back(&ThreadPool::workerLoop,this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit=true;
+  }
+  m_wake.notify_all();
+  for(auto &t : m_workers)
+  {
+    t.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> _task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(std::move(_task));
+  }
+  m_wake.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+  Trace::setThreadName("ThreadPool worker");
+  for(;;)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock,[this]{return m_quit || !m_tasks.empty();});
+      if(m_tasks.empty())
+      {
+        return;
+      }
+      task=std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    TRACE_SCOPE("ThreadPool task");
+    task();
+  }
+}
+
+void ThreadPool::parallelFor(size_t _begin, size_t _end, const std::function<void(size_t,size_t)> &_func, size_t _grain)
+{
+  if(_end <= _begin)
+  {
+    return;
+  }
+  TRACE_SCOPE("ThreadPool::parallelFor");
+  size_t range=_end-_begin;
+  // aim for a few chunks per thread so uneven chunks balance out
+  size_t chunk=std::max<size_t>(std::max<size_t>(_grain,1),(range+numThreads()*4-1)/(numThreads()*4));
+  size_t numChunks=(range+chunk-1)/chunk;
+  if(numChunks == 1 || m_workers.empty())
+  {
+    _func(_begin,_end);
+    return;
+  }
+  // state shared with the helper tasks, a helper may still be queued after we return so
+  // it is reference counted
+  struct Job
+  {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+  auto job=std::make_shared<Job>();
+  const std::function<void(size_t,size_t)> *func=&_func;
+  auto run=[job,func,_begin,_end,chunk,numChunks]()
+  {
+    size_t c;
+    while((c=job->next.fetch_add(1)) < numChunks)
+    {
+      size_t b=_begin+c*chunk;
+      {
+        TRACE_SCOPE("parallelFor chunk");
+        (*func)(b,std::min(b+chunk,_end));
+      }
+      if(job->done.fetch_add(1)+1 == numChunks)
+      {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished.notify_all();
+      }
+    }
+  };
+  size_t helpers=std::min<size_t>(m_workers.size(),numChunks-1);
+  for(size_t i=0; i<helpers; ++i)
+  {
+    submit(run);
+  }
+  run();
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->finished.wait(lock,[&job,numChunks]{return job->done.load() == numChunks;});
+}
@@ -0,0 +1,245 @@
+#include "Trace.h"
+#include <chrono>
+#include <fstream>
+#include <ostream>
+
+std::atomic<bool> Trace::s_enabled{false};
+std::atomic<uint32_t> Trace::s_generation{0};
+constexpr size_t Trace::s_chunkEvents;
+constexpr size_t Trace::s_maxChunks;
+
+namespace
+{
+  /// @brief the calling thread's buffer and the name given before it had one
+  thread_local void *t_buffer=nullptr;
+  thread_local const char *t_name=nullptr;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write _text as a JSON string
+  //----------------------------------------------------------------------------------------------------------------------
+  void writeString(std::ostream &_out, const char *_text)
+  {
+    _out<<'"';
+    for(const char *c=_text; *c != '\0'; ++c)
+    {
+      if(*c == '"' || *c == '\\')
+      {
+        _out<<'\\';
+      }
+      _out<<*c;
+    }
+    _out<<'"';
+  }
+}
+
+Trace *Trace::instance()
+{
+  static Trace s_trace;
+  return &s_trace;
+}
+
+Trace::~Trace()
+{
+  // a pool thread outliving us mustn't record into a deleted buffer
+  s_enabled.store(false);
+}
+
+Trace::ThreadBuffer::~ThreadBuffer()
+{
+  Chunk *chunk=head.next.load();
+  while(chunk != nullptr)
+  {
+    Chunk *next=chunk->next.load();
+    delete chunk;
+    chunk=next;
+  }
+}
+
+uint64_t Trace::steadyNs()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Trace::ThreadBuffer *Trace::threadBuffer()
+{
+  if(t_buffer == nullptr)
+  {
+    std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+    buffer->generation.store(s_generation.load(),std::memory_order_relaxed);
+    buffer->name.store(t_name);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer->id=static_cast<uint32_t>(m_buffers.size())+1;
+    t_buffer=buffer.get();
+    m_buffers.push_back(std::move(buffer));
+  }
+  return static_cast<ThreadBuffer *>(t_buffer);
+}
+
+void Trace::rewind(ThreadBuffer &io_buffer)
+{
+  for(Chunk *chunk=&io_buffer.head; chunk != nullptr; chunk=chunk->next.load(std::memory_order_relaxed))
+  {
+    chunk->count.store(0,std::memory_order_release);
+  }
+  io_buffer.tail=&io_buffer.head;
+  io_buffer.used=1;
+  io_buffer.dropped.store(0,std::memory_order_relaxed);
+}
+
+void Trace::record(const char *_name, uint64_t _begin, uint64_t _end)
+{
+  if(!enabled())
+  {
+    return;
+  }
+  ThreadBuffer *buffer=instance()->threadBuffer();
+  uint32_t generation=s_generation.load(std::memory_order_relaxed);
+  if(buffer->generation.load(std::memory_order_relaxed) != generation)
+  {
+    rewind(*buffer);
+    buffer->generation.store(generation,std::memory_order_relaxed);
+  }
+  Chunk *chunk=buffer->tail;
+  size_t count=chunk->count.load(std::memory_order_relaxed);
+  if(count == s_chunkEvents)
+  {
+    if(buffer->used == s_maxChunks)
+    {
+      buffer->dropped.fetch_add(1,std::memory_order_relaxed);
+      return;
+    }
+    // chunks from an earlier capture are reused, they were emptied by rewind
+    Chunk *next=chunk->next.load(std::memory_order_relaxed);
+    if(next == nullptr)
+    {
+      next=new Chunk;
+      chunk->next.store(next,std::memory_order_release);
+    }
+    buffer->tail=chunk=next;
+    ++buffer->used;
+    count=0;
+  }
+  chunk->events[count]={_name,_begin,_end};
+  // publish the event, a reader that sees the new count sees the event too
+  chunk->count.store(count+1,std::memory_order_release);
+}
+
+void Trace::setThreadName(const char *_name)
+{
+  t_name=_name;
+  if(t_buffer != nullptr)
+  {
+    static_cast<ThreadBuffer *>(t_buffer)->name.store(_name);
+  }
+}
+
+void Trace::start()
+{
+  m_startTicks=now();
+  m_startNs=steadyNs();
+  s_generation.fetch_add(1);
+  s_enabled.store(true);
+}
+
+bool Trace::stop(std::ostream &_log)
+{
+  s_enabled.store(false);
+  std::ofstream file(m_file);
+  if(!file.is_open())
+  {
+    _log<<"unable to open "<<m_file<<" for writing\n";
+    return false;
+  }
+  size_t events=writeJSON(file);
+  _log<<"trace of "<<events<<" events written to "<<m_file;
+  if(dropped() > 0)
+  {
+    _log<<", "<<dropped()<<" dropped as a thread's buffer was full";
+  }
+  _log<<", open it in ui.perfetto.dev or chrome://tracing\n";
+  return true;
+}
+
+void Trace::toggle(std::ostream &_log)
+{
+  if(isRecording())
+  {
+    stop(_log);
+  }
+  else
+  {
+    start();
+    _log<<"recording a trace\n";
+  }
+}
+
+size_t Trace::writeJSON(std::ostream &_out) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  uint32_t generation=s_generation.load();
+  // the rate of the ticks over the capture so far, 1 when they are already ns
+  uint64_t ticks=now()-m_startTicks;
+  uint64_t ns=steadyNs()-m_startNs;
+  double usPerTick= ticks > 0 && ns > 0 ? ns/1000.0/ticks : 0.001;
+  size_t events=0;
+  _out<<"{\"traceEvents\":[\n";
+  bool first=true;
+  _out.setf(std::ios::fixed);
+  _out.precision(3);
+  for(const auto &buffer : m_buffers)
+  {
+    // a thread that hasn't recorded since start still holds the last capture
+    if(buffer->generation.load(std::memory_order_relaxed) != generation)
+    {
+      continue;
+    }
+    const char *name=buffer->name.load();
+    std::string fallback="thread "+std::to_string(buffer->id);
+    _out<<(first ? "" : ",\n")<<"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"<<buffer->id
+        <<",\"args\":{\"name\":";
+    writeString(_out,name != nullptr ? name : fallback.c_str());
+    _out<<"}}";
+    first=false;
+    for(const Chunk *chunk=&buffer->head; chunk != nullptr; chunk=chunk->next.load(std::memory_order_acquire))
+    {
+      size_t count=chunk->count.load(std::memory_order_acquire);
+      for(size_t i=0; i<count; ++i)
+      {
+        const Event &e=chunk->events[i];
+        // a scope that was open when the capture started
+        if(e.begin < m_startTicks)
+        {
+          continue;
+        }
+        _out<<",\n{\"name\":";
+        writeString(_out,e.name);
+        _out<<",\"ph\":\"X\",\"pid\":1,\"tid\":"<<buffer->id<<",\"ts\":"<<(e.begin-m_startTicks)*usPerTick
+            <<",\"dur\":"<<(e.end-e.begin)*usPerTick<<'}';
+        ++events;
+      }
+      // only the tail is part full, anything after it is left from an earlier capture
+      if(count < s_chunkEvents)
+      {
+        break;
+      }
+    }
+  }
+  _out<<"\n],\"displayTimeUnit\":\"ms\"}\n";
+  return events;
+}
+
+size_t Trace::dropped() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  uint32_t generation=s_generation.load();
+  size_t dropped=0;
+  for(const auto &buffer : m_buffers)
+  {
+    if(buffer->generation.load(std::memory_order_relaxed) == generation)
+    {
+      dropped+=buffer->dropped.load();
+    }
+  }
+  return dropped;
+}
@@ -0,0 +1,338 @@
+#include "Workload.h"
+#include "Philox.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <ostream>
+
+namespace
+{
+  /// @brief the minimum number of points each thread is given, the same as the PointGenerator
+  constexpr size_t s_grain=16384;
+  constexpr size_t s_numClusters=32;
+  constexpr size_t s_numHotspots=64;
+  constexpr size_t s_numWaves=8;
+  constexpr size_t s_numLines=256;
+  /// @brief the PointGenerator uses stream 0, each point of a shape uses 1 and 2 and the parameters the rest
+  constexpr uint32_t s_pointStream=1;
+  constexpr uint32_t s_extraStream=2;
+  constexpr uint32_t s_clusterStream=16;
+  constexpr uint32_t s_hotspotStream=17;
+  constexpr uint32_t s_waveStream=18;
+  constexpr uint32_t s_lineStream=19;
+  constexpr uint32_t s_populationStream=21;
+  constexpr float s_twoPi=6.28318530718f;
+  /// @brief the closest a heavy tail point is to its hotspot, in the unit box
+  constexpr float s_tailMin=0.002f;
+
+  float unit(uint32_t _v)
+  {
+    return philox::toUnitFloat(_v);
+  }
+
+  float signedUnit(uint32_t _v)
+  {
+    return unit(_v)*2.0f-1.0f;
+  }
+
+  /// @brief two normally distributed values from two random words, Box-Muller
+  void gaussians(uint32_t _a, uint32_t _b, float &o_g0, float &o_g1)
+  {
+    // offset by one so the log never sees 0
+    float u=(static_cast<float>(_a>>8)+1.0f)*(1.0f/16777216.0f);
+    float r=std::sqrt(-2.0f*std::log(u));
+    float t=s_twoPi*unit(_b);
+    o_g0=r*std::cos(t);
+    o_g1=r*std::sin(t);
+  }
+
+  /// @brief a uniformly distributed direction from two random words
+  void direction(uint32_t _a, uint32_t _b, float *o_xyz)
+  {
+    float y=signedUnit(_a);
+    float s=std::sqrt(std::max(0.0f,1.0f-y*y));
+    float phi=s_twoPi*unit(_b);
+    o_xyz[0]=s*std::cos(phi);
+    o_xyz[1]=y;
+    o_xyz[2]=s*std::sin(phi);
+  }
+}
+
+Workload::Workload(Shape _shape, uint64_t _seed) : m_shape(_shape), m_generator(_seed)
+{
+  setExtents(5.0f,5.0f,5.0f);
+  makeParameters();
+}
+
+void Workload::setSeed(uint64_t _seed)
+{
+  m_generator.setSeed(_seed);
+  makeParameters();
+}
+
+void Workload::setExtents(float _x, float _y, float _z)
+{
+  m_generator.setExtents(_x,_y,_z);
+  m_extents[0]=_x;
+  m_extents[1]=_y;
+  m_extents[2]=_z;
+}
+
+void Workload::makeParameters()
+{
+  uint64_t seed=m_generator.seed();
+  // blobs from tight to loose with populations that differ by up to ten times
+  m_clusters.resize(s_numClusters);
+  float total=0.0f;
+  for(size_t i=0; i<s_numClusters; ++i)
+  {
+    philox::Block r=philox::generate(i,s_clusterStream,seed);
+    for(int c=0; c<3; ++c)
+    {
+      m_clusters[i].position[c]=signedUnit(r.v[c])*0.8f;
+    }
+    m_clusters[i].size=0.01f*std::pow(8.0f,unit(r.v[3]));
+    total+=0.1f+unit(philox::generate(i,s_populationStream,seed).v[0]);
+    m_clusters[i].cumulative=total;
+  }
+  for(auto &c : m_clusters)
+  {
+    c.cumulative/=total;
+  }
+  // Zipf populations, the k'th hotspot has 1/k of the first's points
+  m_hotspots.resize(s_numHotspots);
+  total=0.0f;
+  for(size_t i=0; i<s_numHotspots; ++i)
+  {
+    philox::Block r=philox::generate(i,s_hotspotStream,seed);
+    for(int c=0; c<3; ++c)
+    {
+      m_hotspots[i].position[c]=signedUnit(r.v[c])*0.9f;
+    }
+    m_hotspots[i].size=0.05f+0.35f*unit(r.v[3]);
+    total+=1.0f/static_cast<float>(i+1);
+    m_hotspots[i].cumulative=total;
+  }
+  for(auto &h : m_hotspots)
+  {
+    h.cumulative/=total;
+  }
+  // each wave is twice the frequency and half the height of the last, like octaves of noise
+  m_waves.resize(s_numWaves);
+  total=0.0f;
+  for(size_t i=0; i<s_numWaves; ++i)
+  {
+    philox::Block r=philox::generate(i,s_waveStream,seed);
+    float angle=s_twoPi*unit(r.v[0]);
+    m_waves[i].direction[0]=std::cos(angle);
+    m_waves[i].direction[1]=std::sin(angle);
+    m_waves[i].frequency=3.14159265f*static_cast<float>(1u<<i)*(0.75f+0.5f*unit(r.v[1]));
+    m_waves[i].phase=s_twoPi*unit(r.v[2]);
+    m_waves[i].amplitude=1.0f/static_cast<float>(1u<<i);
+    total+=m_waves[i].amplitude;
+  }
+  // so the sum is within -1 -> 1
+  for(auto &w : m_waves)
+  {
+    w.amplitude/=total;
+  }
+  m_lines.resize(s_numLines);
+  for(size_t i=0; i<s_numLines; ++i)
+  {
+    philox::Block start=philox::generate(i,s_lineStream,seed);
+    philox::Block end=philox::generate(i,s_lineStream+1,seed);
+    for(int c=0; c<3; ++c)
+    {
+      m_lines[i].start[c]=signedUnit(start.v[c])*0.95f;
+      m_lines[i].direction[c]=signedUnit(end.v[c])*0.95f-m_lines[i].start[c];
+    }
+  }
+}
+
+size_t Workload::pick(const std::vector<Centre> &_centres, uint32_t _random)
+{
+  float u=unit(_random);
+  auto it=std::upper_bound(_centres.begin(),_centres.end(),u,[](float _u, const Centre &_c){return _u < _c.cumulative;});
+  // rounding can leave the last total a hair under 1
+  return std::min(static_cast<size_t>(it-_centres.begin()),_centres.size()-1);
+}
+
+void Workload::cluster(uint64_t _index, float *o_xyz) const
+{
+  philox::Block r=philox::generate(_index,s_pointStream,m_generator.seed());
+  philox::Block extra=philox::generate(_index,s_extraStream,m_generator.seed());
+  const Centre &c=m_clusters[pick(m_clusters,extra.v[0])];
+  float g[4];
+  gaussians(r.v[0],r.v[1],g[0],g[1]);
+  gaussians(r.v[2],r.v[3],g[2],g[3]);
+  for(int i=0; i<3; ++i)
+  {
+    o_xyz[i]=c.position[i]+c.size*g[i];
+  }
+}
+
+void Workload::sphere(uint64_t _index, float *o_xyz) const
+{
+  philox::Block r=philox::generate(_index,s_pointStream,m_generator.seed());
+  direction(r.v[0],r.v[1],o_xyz);
+  // a scanner measures the surface to a fraction of a percent
+  float g0,g1;
+  gaussians(r.v[2],r.v[3],g0,g1);
+  float radius=0.9f*(1.0f+0.002f*g0);
+  for(int i=0; i<3; ++i)
+  {
+    o_xyz[i]*=radius;
+  }
+}
+
+void Workload::terrain(uint64_t _index, float *o_xyz) const
+{
+  philox::Block r=philox::generate(_index,s_pointStream,m_generator.seed());
+  float x=signedUnit(r.v[0]);
+  float z=signedUnit(r.v[1]);
+  float height=0.0f;
+  for(const auto &w : m_waves)
+  {
+    height+=w.amplitude*std::sin(w.frequency*(w.direction[0]*x+w.direction[1]*z)+w.phase);
+  }
+  float g0,g1;
+  gaussians(r.v[2],r.v[3],g0,g1);
+  o_xyz[0]=x;
+  o_xyz[1]=0.4f*height+0.002f*g0;
+  o_xyz[2]=z;
+}
+
+void Workload::scanLine(uint64_t _index, float *o_xyz) const
+{
+  philox::Block r=philox::generate(_index,s_pointStream,m_generator.seed());
+  philox::Block extra=philox::generate(_index,s_extraStream,m_generator.seed());
+  const Line &line=m_lines[r.v[0]%s_numLines];
+  float t=unit(r.v[1]);
+  float g[4];
+  gaussians(r.v[2],r.v[3],g[0],g[1]);
+  gaussians(extra.v[0],extra.v[1],g[2],g[3]);
+  // thin, a few thousandths of the box across
+  for(int i=0; i<3; ++i)
+  {
+    o_xyz[i]=line.start[i]+t*line.direction[i]+0.003f*g[i];
+  }
+}
+
+void Workload::heavyTail(uint64_t _index, float *o_xyz) const
+{
+  philox::Block r=philox::generate(_index,s_pointStream,m_generator.seed());
+  const Centre &h=m_hotspots[pick(m_hotspots,r.v[3])];
+  // the distance is a Pareto with exponent 1 cut off at the hotspot's size, the inverse of its cdf, so the
+  // density falls off as the fourth power of the distance
+  float u=unit(r.v[0]);
+  float distance=s_tailMin/(1.0f-u*(1.0f-s_tailMin/h.size));
+  direction(r.v[1],r.v[2],o_xyz);
+  for(int i=0; i<3; ++i)
+  {
+    o_xyz[i]=h.position[i]+distance*o_xyz[i];
+  }
+}
+
+void Workload::scaleToBox(float *io_xyz) const
+{
+  for(int i=0; i<3; ++i)
+  {
+    io_xyz[i]=std::min(std::max(io_xyz[i]*m_extents[i],-m_extents[i]),m_extents[i]);
+  }
+}
+
+void Workload::generateSerial(float *o_xyz, size_t _count, uint64_t _firstIndex) const
+{
+  void (Workload::*point)(uint64_t,float *) const=nullptr;
+  switch(m_shape)
+  {
+    case Shape::Uniform : m_generator.generateSerial(o_xyz,_count,_firstIndex); return;
+    case Shape::Clusters : point=&Workload::cluster; break;
+    case Shape::Sphere : point=&Workload::sphere; break;
+    case Shape::Terrain : point=&Workload::terrain; break;
+    case Shape::ScanLines : point=&Workload::scanLine; break;
+    case Shape::HeavyTail : point=&Workload::heavyTail; break;
+  }
+  for(size_t i=0; i<_count; ++i)
+  {
+    (this->*point)(_firstIndex+i,o_xyz+i*3);
+    // a gaussian tail can just leave the box
+    scaleToBox(o_xyz+i*3);
+  }
+}
+
+void Workload::generate(float *o_xyz, size_t _count, uint64_t _firstIndex) const
+{
+  TRACE_SCOPE("Workload::generate");
+  if(m_shape == Shape::Uniform)
+  {
+    m_generator.generate(o_xyz,_count,_firstIndex);
+    return;
+  }
+  ThreadPool::instance()->parallelFor(0,_count,[=](size_t _begin, size_t _end)
+  {
+    generateSerial(o_xyz+_begin*3,_end-_begin,_firstIndex+_begin);
+  },s_grain);
+}
+
+const char *Workload::shapeName(Shape _shape)
+{
+  switch(_shape)
+  {
+    case Shape::Uniform : return "uniform";
+    case Shape::Clusters : return "clusters";
+    case Shape::Sphere : return "sphere";
+    case Shape::Terrain : return "terrain";
+    case Shape::ScanLines : return "scanlines";
+    case Shape::HeavyTail : return "heavytail";
+  }
+  return "unknown";
+}
+
+std::string Workload::shapeNames()
+{
+  std::string names;
+  for(Shape s : {Shape::Uniform,Shape::Clusters,Shape::Sphere,Shape::Terrain,Shape::ScanLines,Shape::HeavyTail})
+  {
+    names+=(names.empty() ? "" : ",")+std::string(shapeName(s));
+  }
+  return names;
+}
+
+bool Workload::parseShape(const std::string &_name, Shape &o_shape)
+{
+  std::string name=_name;
+  std::transform(name.begin(),name.end(),name.begin(),[](unsigned char _c){return static_cast<char>(std::tolower(_c));});
+  for(Shape s : {Shape::Uniform,Shape::Clusters,Shape::Sphere,Shape::Terrain,Shape::ScanLines,Shape::HeavyTail})
+  {
+    if(name == shapeName(s))
+    {
+      o_shape=s;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Workload::benchmark(size_t _count, unsigned int _iterations, std::ostream &_log)
+{
+  std::vector<float> points(_count*3);
+  for(Shape s : {Shape::Uniform,Shape::Clusters,Shape::Sphere,Shape::Terrain,Shape::ScanLines,Shape::HeavyTail})
+  {
+    Workload workload(s);
+    double best=std::numeric_limits<double>::max();
+    for(unsigned int i=0; i<std::max(1u,_iterations); ++i)
+    {
+      auto start=std::chrono::steady_clock::now();
+      workload.generate(points.data(),_count);
+      best=std::min(best,std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count());
+    }
+    _log<<"Workload "<<shapeName(s)<<" "<<_count<<" points in "<<best<<" ms ("<<_count/(best*1000.0)
+        <<" Mpoints/s) on "<<ThreadPool::instance()->numThreads()<<" threads\n";
+  }
+}
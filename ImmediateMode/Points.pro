@@ -21,6 +21,8 @@ SOURCES+= $$PWD/src/NGLScene.cpp    \
 HEADERS+= $$PWD/include/NGLScene.h
 # and add the include dir into the search path for Qt and make
 INCLUDEPATH +=./include
+# code shared between the demos (point generation etc)
+include($$PWD/../Common/Common.pri)
 # where our exe is going to live (root of project)
 DESTDIR=./
 # add the glsl shader files
@@ -4,6 +4,9 @@
 #include <ngl/Transformation.h>
 #include <ngl/Text.h>
 #include <QOpenGLWindow>
+#include <string>
+#include "FrameScheduler.h"
+#include "PointGenerator.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
 /// @brief this class inherits from the Qt OpenGLWindow and allows us to use NGL to draw OpenGL
@@ -45,6 +48,31 @@ class NGLScene : public QOpenGLWindow
     void resizeGL(QResizeEvent *_event);
     // Qt 5.x uses this instead! http://doc.qt.io/qt-5/qopenglwindow.html#resizeGL
     void resizeGL(int _w, int _h);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set how frames are paced, see FrameScheduler
+    /// @param _mode the pacing mode
+    /// @param _fps the target frame rate when _mode is FrameScheduler::Mode::FixedRate
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFrameMode(FrameScheduler::Mode _mode, double _fps=60.0){m_scheduler.setMode(_mode,_fps);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advance the animation by a fixed step each frame rather than the real time, for batch rendering
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFixedStep(double _seconds){m_scheduler.setFixedStep(_seconds);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief change the number of points, the array only grows when its capacity is exceeded
+    /// and shrinking keeps the memory until shrinkToFit is called. Can be called before the window is shown.
+    /// @param _size the new number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void setNumPoints(unsigned int _size);
+    unsigned int numPoints() const {return m_numPoints;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief release the unused capacity of the point array
+    //----------------------------------------------------------------------------------------------------------------------
+    void shrinkToFit();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a one line summary of the used and allocated memory
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string memoryUsage() const;
 
 private:
 
@@ -71,7 +99,6 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     void mouseReleaseEvent ( QMouseEvent *_event );
 
-    void timerEvent(QTimerEvent *_event);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is called everytime the mouse wheel is moved
     /// inherited from QObject and overridden here.
@@ -88,8 +115,14 @@ private:
     ngl::Mat4 m_vp;
     /// @brief store simple rotation
     ngl::Real m_rot;
+    /// @brief drives the redraws from frameSwapped and gives the time between frames
+    FrameScheduler m_scheduler;
+    /// @brief generates the random points, the seed is changed to get a new set
+    PointGenerator m_generator;
     // create an array of ngl::Vec3 and re-size
     std::vector<ngl::Vec3> m_points;
+    /// @brief the number of points drawn
+    unsigned int m_numPoints;
     int m_width;
     int m_height;
 
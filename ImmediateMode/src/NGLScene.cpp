@@ -1,18 +1,24 @@
 #include <QMouseEvent>
 #include <QGuiApplication>
+#include <algorithm>
+#include <cstdio>
 
 #include "NGLScene.h"
+#include "Trace.h"
 #include <ngl/NGLInit.h>
-#include <ngl/Random.h>
 #include <ngl/Util.h>
 
-const static int s_numPoints=100000;
+/// @brief the number of points to start with, can be changed with setNumPoints
+const static unsigned int s_defaultNumPoints=100000;
+/// @brief how fast the points spin in degrees per second
+const static ngl::Real s_rotationSpeed=100.0f;
 
-NGLScene::NGLScene()
+NGLScene::NGLScene() : m_scheduler(this)
 {
   // re-size the widget to that of the parent (in this case the GLFrame passed in on construction)
   setTitle("Drawing Using immediate mode OpenGL commands ");
   m_rot=0.0;
+  m_numPoints=s_defaultNumPoints;
 }
 
 
@@ -52,43 +58,76 @@ void NGLScene::initializeGL()
   ngl::Mat4 perspective=ngl::perspective(45.0f,float(width()/height()),0.1,100);
   // store to vp for later use
   m_vp=perspective*view;
-  createPoints(s_numPoints);
+  createPoints(m_numPoints);
   glPointSize(5);
-  startTimer(1);
+  // start the render loop, the next frame is requested each time one is swapped
+  m_scheduler.start();
 }
 
 void NGLScene::createPoints(unsigned int _size)
 {
-  // we are going to create an array of random points using the
-  // random generator in ngl
-  ngl::Random *rng= ngl::Random::instance();
-
+  TRACE_SCOPE("NGLScene::createPoints");
   m_points.resize(_size);
-  // now populate the array with random points in the range -5 -> 5
-  for(unsigned int i=0; i<_size; ++i)
-  {
-    m_points[i]=rng->getRandomPoint(5.0f,5.0f,5.0f);
-  }
+  // now populate the array with random points in the range -5 -> 5, this is
+  // split across all cores and gives the same points for a seed
+  m_generator.generate(&m_points[0].m_x,_size);
 
  }
 
 
 void NGLScene::updatePoints(unsigned int _size)
 {
-  // we are going to create an array of random points using the
-  // random generator in ngl
-  ngl::Random *rng= ngl::Random::instance();
+  TRACE_SCOPE("NGLScene::updatePoints");
+  // a new seed gives a new set of points
+  m_generator.setSeed(m_generator.seed()+1);
+  m_points.resize(_size);
+  m_generator.generate(&m_points[0].m_x,_size);
+
+}
 
-  // now populate the array with random points in the range -5 -> 5
-  for(unsigned int i=0; i<_size; ++i)
+void NGLScene::setNumPoints(unsigned int _size)
+{
+  _size=std::max(1u,_size);
+  unsigned int oldSize=m_numPoints;
+  m_numPoints=_size;
+  // before initializeGL we just store the size for createPoints
+  if(m_points.empty() || _size == oldSize)
+  {
+    return;
+  }
+  // the vector keeps its capacity when shrinking and grows geometrically
+  m_points.resize(_size);
+  if(_size > oldSize)
   {
-    m_points[i]=rng->getRandomPoint(5.0f,5.0f,5.0f);
+    // point i only depends on the seed and i so just generate the new ones
+    m_generator.generate(&m_points[oldSize].m_x,_size-oldSize,oldSize);
   }
+  std::cout<<memoryUsage()<<"\n";
+  update();
+}
+
+void NGLScene::shrinkToFit()
+{
+  m_points.shrink_to_fit();
+  std::cout<<memoryUsage()<<"\n";
+}
 
+std::string NGLScene::memoryUsage() const
+{
+  const double mb=1024.0*1024.0;
+  size_t used=m_points.size()*sizeof(ngl::Vec3);
+  size_t capacity=m_points.capacity()*sizeof(ngl::Vec3);
+  char buffer[128];
+  std::snprintf(buffer,sizeof(buffer),"%u points, array %.2f MB used of %.2f MB (%.1f%% unused)",
+                m_numPoints,used/mb,capacity/mb,capacity ? 100.0*(capacity-used)/capacity : 0.0);
+  return buffer;
 }
 
 void NGLScene::paintGL()
 {
+  // advance the animation by the real time since the last frame
+  m_rot+=s_rotationSpeed*m_scheduler.tick();
+  TRACE_SCOPE("NGLScene::paintGL");
   // clear the screen and depth buffer
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   glViewport(0,0,m_width,m_height);
@@ -97,6 +136,7 @@ void NGLScene::paintGL()
   ngl::Mat4 MVP=m_vp*transform.getMatrix();
   glLoadIdentity();
   glMultMatrixf(&MVP.m_openGL[0]);
+  TRACE_SCOPE("draw");
   glBegin(GL_POINTS);
     for(unsigned int i=0; i<m_points.size(); ++i)
       glVertex3fv(&m_points[i].m_x);
@@ -131,21 +171,22 @@ void NGLScene::wheelEvent(QWheelEvent *_event)
 
 void NGLScene::keyPressEvent(QKeyEvent *_event)
 {
+  TRACE_SCOPE("NGLScene::keyPressEvent");
   // this method is called every time the main window recives a key event.
   // we then switch on the key value and set the camera in the GLWindow
   switch (_event->key())
   {
   // escape key to quite
   case Qt::Key_Escape : QGuiApplication::exit(EXIT_SUCCESS); break;
-  case Qt::Key_Space : updatePoints(s_numPoints); break;
+  case Qt::Key_Space : updatePoints(m_numPoints); break;
+  case Qt::Key_Plus :
+  case Qt::Key_Equal : setNumPoints(m_numPoints*2); break;
+  case Qt::Key_Minus : setNumPoints(m_numPoints/2); break;
+  case Qt::Key_C : shrinkToFit(); break;
+  case Qt::Key_P : m_scheduler.togglePause(); break;
+  case Qt::Key_E : Trace::instance()->toggle(std::cout); break;
   default : break;
   }
   update();
 }
 
-
-void NGLScene::timerEvent(QTimerEvent *_event)
-{
-  m_rot+=0.1;
-  update();
-}
@@ -0,0 +1,35 @@
+# This specifies the exe name
+TARGET=OctreeBuilder
+# where to put the .o files
+OBJECTS_DIR=obj
+# core Qt Libs to use add more here if needed.
+QT+=gui opengl core
+isEqual(QT_MAJOR_VERSION, 5) {
+	cache()
+	DEFINES +=QT5BUILD
+}
+# where to put moc auto generated files
+MOC_DIR=moc
+# on a mac we don't create a .app bundle file ( for ease of multiplatform use)
+CONFIG-=app_bundle
+SOURCES+= $$PWD/src/main.cpp \
+					$$PWD/src/OctreeBuilder.cpp
+HEADERS+= $$PWD/include/OctreeBuilder.h
+# and add the include dir into the search path for Qt and make
+INCLUDEPATH +=./include
+# code shared between the demos (point generation etc)
+include($$PWD/../Common/Common.pri)
+# where our exe is going to live (root of project)
+DESTDIR=./
+# this is a command line tool
+CONFIG += console
+
+NGLPATH=$$(NGLDIR)
+isEmpty(NGLPATH){ # note brace must be here
+	message("including $HOME/NGL")
+	include($(HOME)/NGL/UseNGL.pri)
+}
+else{ # note brace must be here
+	message("Using custom NGL location")
+	include($(NGLDIR)/UseNGL.pri)
+}
@@ -0,0 +1,111 @@
+#ifndef OCTREEBUILDER_H_
+#define OCTREEBUILDER_H_
+#include "OctreeFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OctreeBuilder.h
+/// @brief builds the out of core octree read by OctreeFile from a raw xyz or PLY point cloud
+/// @class OctreeBuilder
+/// @brief the input is streamed three times with PointCloudLoader so it never has to fit in memory
+///   1. find the bounds
+///   2. count the points in each cell of a 2^maxDepth grid, the cells are in Morton order so every
+///      octree node covers a contiguous range of cells and the prefix sum of the counts gives the
+///      number of points in any node. Nodes are split until they have fewer than nodePoints.
+///   3. counting sort the points by cell into a memory mapped temporary file, the points of each
+///      leaf are then contiguous
+/// Finally the tree is walked bottom up, each node shuffles the points it has (its own if a leaf or
+/// the samples passed up by its children), passes nodePoints/8 of them up to its parent and writes
+/// the rest. Only one leaf plus the samples on the current path are in memory at a time.
+//----------------------------------------------------------------------------------------------------------------------
+
+class OctreeBuilder
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build settings
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Config
+    {
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the deepest level, the cell counts use 8*8^maxDepth bytes so this is limited to 8
+      //----------------------------------------------------------------------------------------------------------------------
+      unsigned int maxDepth=7;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief nodes with more points than this are split, it is also about the size of each node
+      //----------------------------------------------------------------------------------------------------------------------
+      size_t nodePoints=100000;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief seeds the shuffles that pick the subsamples
+      //----------------------------------------------------------------------------------------------------------------------
+      uint64_t seed=0x0c7;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _config the build settings
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit OctreeBuilder(const Config &_config);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build an octree file
+    /// @param _input a raw xyz or binary PLY file
+    /// @param _output the octree file to write, a temporary _output.tmp the size of the input points is also used
+    /// @returns false with a message on std::cerr if it fails
+    //----------------------------------------------------------------------------------------------------------------------
+    bool build(const std::string &_input, const std::string &_output);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief check an octree file, every point must be counted once and lie inside its node
+    /// @param _fname the file to check
+    /// @param _expectedPoints the number of points in the input, 0 to skip this check
+    /// @param _log where to write the results
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool verify(const std::string &_fname, uint64_t _expectedPoints, std::ostream &_log);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cell range and point range a node covers while building
+    //----------------------------------------------------------------------------------------------------------------------
+    struct BuildNode
+    {
+      uint64_t firstCell;
+      uint64_t endCell;
+      uint64_t firstPoint;
+      uint64_t endPoint;
+    };
+    bool computeBounds(const std::string &_input);
+    bool countCells(const std::string &_input);
+    bool sortPoints(const std::string &_input, const std::string &_sorted);
+    bool writeTree(const std::string &_output, const std::string &_sorted);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the node for a Morton code at a level and split it if it has too many points
+    /// @returns the index of the new node
+    //----------------------------------------------------------------------------------------------------------------------
+    int32_t split(unsigned int _level, uint64_t _code);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write a node after its children
+    /// @returns the sample of points passed up to the parent
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<float> writeNode(int32_t _index, const float *_sorted, std::ostream &_out);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the grid cell of a point as a Morton code
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t cell(const float *_p) const;
+    Config m_config;
+    uint64_t m_numPoints=0;
+    float m_min[3];
+    float m_size=0.0f;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief cells per axis at maxDepth
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t m_resolution=1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the prefix sum of the points in each cell, then used as the write cursor for each cell when sorting
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<uint64_t> m_cells;
+    std::vector<OctreeNode> m_nodes;
+    std::vector<BuildNode> m_build;
+};
+
+#endif
@@ -0,0 +1,291 @@
+#include "OctreeBuilder.h"
+#include "Morton.h"
+#include "PointCloudLoader.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace
+{
+  constexpr unsigned int s_maxDepth=8;
+  constexpr double s_mb=1024.0*1024.0;
+}
+
+OctreeBuilder::OctreeBuilder(const Config &_config) : m_config(_config)
+{
+  if(m_config.maxDepth > s_maxDepth)
+  {
+    std::cerr<<"octree depth limited to "<<s_maxDepth<<'\n';
+    m_config.maxDepth=s_maxDepth;
+  }
+  m_config.nodePoints=std::max<size_t>(m_config.nodePoints,8);
+  m_resolution=1u << m_config.maxDepth;
+}
+
+bool OctreeBuilder::build(const std::string &_input, const std::string &_output)
+{
+  QElapsedTimer timer;
+  timer.start();
+  std::string sorted=_output+".tmp";
+  bool ok=computeBounds(_input) && countCells(_input) && sortPoints(_input,sorted) && writeTree(_output,sorted);
+  QFile::remove(QString::fromStdString(sorted));
+  if(ok)
+  {
+    std::cout<<"Built octree of "<<m_numPoints<<" points in "<<timer.elapsed()/1000.0<<" s\n";
+  }
+  return ok;
+}
+
+bool OctreeBuilder::computeBounds(const std::string &_input)
+{
+  PointCloudLoader loader;
+  if(!loader.open(_input))
+  {
+    return false;
+  }
+  loader.loadChunks(0.0,[](size_t, size_t, const float *){});
+  m_numPoints=loader.loadedPoints();
+  if(m_numPoints == 0)
+  {
+    std::cerr<<_input<<" has no points\n";
+    return false;
+  }
+  // the octree needs a cube, grow it a little so the points on the max faces are inside
+  ngl::Vec3 extent=loader.maxBounds()-loader.minBounds();
+  m_size=std::max(extent.m_x,std::max(extent.m_y,extent.m_z))*1.0001f+1.0e-6f;
+  for(int axis=0; axis<3; ++axis)
+  {
+    float centre=(loader.minBounds()[axis]+loader.maxBounds()[axis])*0.5f;
+    m_min[axis]=centre-m_size*0.5f;
+  }
+  return true;
+}
+
+uint64_t OctreeBuilder::cell(const float *_p) const
+{
+  uint32_t i[3];
+  for(int axis=0; axis<3; ++axis)
+  {
+    float f=(_p[axis]-m_min[axis])/m_size*m_resolution;
+    i[axis]=static_cast<uint32_t>(std::min(std::max(f,0.0f),static_cast<float>(m_resolution-1)));
+  }
+  return morton::encode(i[0],i[1],i[2]);
+}
+
+bool OctreeBuilder::countCells(const std::string &_input)
+{
+  PointCloudLoader loader;
+  if(!loader.open(_input))
+  {
+    return false;
+  }
+  uint64_t cells=static_cast<uint64_t>(m_resolution)*m_resolution*m_resolution;
+  m_cells.assign(cells+1,0);
+  loader.loadChunks(0.0,[this](size_t, size_t _bytes, const float *_xyz)
+  {
+    for(size_t i=0; i<_bytes/(3*sizeof(float)); ++i)
+    {
+      ++m_cells[cell(_xyz+i*3)+1];
+    }
+  });
+  // m_cells[c] becomes the number of points before cell c
+  for(uint64_t c=1; c<=cells; ++c)
+  {
+    m_cells[c]+=m_cells[c-1];
+  }
+  m_nodes.clear();
+  m_build.clear();
+  split(0,0);
+  size_t leaves=0;
+  unsigned int depth=0;
+  for(auto &n : m_nodes)
+  {
+    leaves+= std::all_of(std::begin(n.children),std::end(n.children),[](int32_t c){return c < 0;});
+    depth=std::max(depth,n.level);
+  }
+  std::cout<<"Octree has "<<m_nodes.size()<<" nodes, "<<leaves<<" leaves, depth "<<depth<<'\n';
+  return true;
+}
+
+int32_t OctreeBuilder::split(unsigned int _level, uint64_t _code)
+{
+  unsigned int shift=3*(m_config.maxDepth-_level);
+  BuildNode b;
+  b.firstCell=_code << shift;
+  b.endCell=(_code+1) << shift;
+  b.firstPoint=m_cells[b.firstCell];
+  b.endPoint=m_cells[b.endCell];
+  uint64_t count=b.endPoint-b.firstPoint;
+  if(count == 0 && _level > 0)
+  {
+    return -1;
+  }
+  OctreeNode n;
+  n.level=_level;
+  n.size=m_size/static_cast<float>(1u << _level);
+  for(int axis=0; axis<3; ++axis)
+  {
+    n.min[axis]=m_min[axis]+morton::compact(_code >> axis)*n.size;
+  }
+  int32_t index=static_cast<int32_t>(m_nodes.size());
+  m_nodes.push_back(n);
+  m_build.push_back(b);
+  if(count > m_config.nodePoints && _level < m_config.maxDepth)
+  {
+    for(unsigned int octant=0; octant<8; ++octant)
+    {
+      // the vector may grow in the recursion so don't hold a reference across it
+      int32_t child=split(_level+1,_code*8+octant);
+      m_nodes[index].children[octant]=child;
+    }
+  }
+  return index;
+}
+
+bool OctreeBuilder::sortPoints(const std::string &_input, const std::string &_sorted)
+{
+  PointCloudLoader loader;
+  if(!loader.open(_input))
+  {
+    return false;
+  }
+  QFile file(QString::fromStdString(_sorted));
+  qint64 bytes=static_cast<qint64>(m_numPoints*3*sizeof(float));
+  if(!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(bytes))
+  {
+    std::cerr<<"unable to create "<<_sorted<<'\n';
+    return false;
+  }
+  float *sorted=reinterpret_cast<float *>(file.map(0,bytes));
+  if(sorted == nullptr)
+  {
+    std::cerr<<"unable to map "<<_sorted<<'\n';
+    return false;
+  }
+  // m_cells now becomes the next free slot in each cell
+  loader.loadChunks(0.0,[this,sorted](size_t, size_t _bytes, const float *_xyz)
+  {
+    for(size_t i=0; i<_bytes/(3*sizeof(float)); ++i)
+    {
+      uint64_t slot=m_cells[cell(_xyz+i*3)]++;
+      std::memcpy(sorted+slot*3,_xyz+i*3,3*sizeof(float));
+    }
+  });
+  file.unmap(reinterpret_cast<uchar *>(sorted));
+  m_cells.clear();
+  m_cells.shrink_to_fit();
+  return true;
+}
+
+bool OctreeBuilder::writeTree(const std::string &_output, const std::string &_sorted)
+{
+  QElapsedTimer timer;
+  timer.start();
+  QFile sortedFile(QString::fromStdString(_sorted));
+  const float *sorted=nullptr;
+  if(sortedFile.open(QIODevice::ReadOnly))
+  {
+    sorted=reinterpret_cast<const float *>(sortedFile.map(0,sortedFile.size()));
+  }
+  std::ofstream out(_output,std::ios::binary);
+  if(sorted == nullptr || !out.is_open())
+  {
+    std::cerr<<"unable to write "<<_output<<'\n';
+    return false;
+  }
+  OctreeHeader header;
+  header.numNodes=static_cast<uint32_t>(m_nodes.size());
+  header.numPoints=m_numPoints;
+  std::copy(m_min,m_min+3,header.min);
+  header.size=m_size;
+  // a place holder until the table offset is known
+  out.write(reinterpret_cast<const char *>(&header),sizeof(OctreeHeader));
+  writeNode(0,sorted,out);
+  header.nodeTableOffset=static_cast<uint64_t>(out.tellp());
+  out.write(reinterpret_cast<const char *>(m_nodes.data()),static_cast<std::streamsize>(m_nodes.size()*sizeof(OctreeNode)));
+  out.seekp(0);
+  out.write(reinterpret_cast<const char *>(&header),sizeof(OctreeHeader));
+  if(!out.good())
+  {
+    std::cerr<<"error writing "<<_output<<'\n';
+    return false;
+  }
+  double mb=header.nodeTableOffset/s_mb;
+  std::cout<<"Wrote "<<mb<<" MB of nodes in "<<timer.elapsed()<<" ms ("<<mb/std::max<qint64>(timer.elapsed(),1)*1000.0<<" MB/s)\n";
+  return true;
+}
+
+std::vector<float> OctreeBuilder::writeNode(int32_t _index, const float *_sorted, std::ostream &_out)
+{
+  std::vector<float> pool;
+  bool leaf=true;
+  for(int32_t child : m_nodes[_index].children)
+  {
+    if(child >= 0)
+    {
+      // the children's samples make up this node
+      std::vector<float> sample=writeNode(child,_sorted,_out);
+      pool.insert(pool.end(),sample.begin(),sample.end());
+      leaf=false;
+    }
+  }
+  if(leaf)
+  {
+    const BuildNode &b=m_build[_index];
+    pool.assign(_sorted+b.firstPoint*3,_sorted+b.endPoint*3);
+  }
+  // shuffle whole points so the first ones are a random sample of the node
+  size_t count=pool.size()/3;
+  std::mt19937_64 rng(m_config.seed ^ (static_cast<uint64_t>(_index)*0x9e3779b97f4a7c15ull));
+  for(size_t i=count; i>1; --i)
+  {
+    size_t j=std::uniform_int_distribution<size_t>(0,i-1)(rng);
+    std::swap_ranges(&pool[(i-1)*3],&pool[(i-1)*3]+3,&pool[j*3]);
+  }
+  size_t up= _index == 0 ? 0 : std::min(count,m_config.nodePoints/8);
+  OctreeNode &n=m_nodes[_index];
+  n.offset=static_cast<uint64_t>(_out.tellp());
+  n.numPoints=static_cast<uint32_t>(count-up);
+  _out.write(reinterpret_cast<const char *>(pool.data()+up*3),static_cast<std::streamsize>((count-up)*3*sizeof(float)));
+  pool.resize(up*3);
+  return pool;
+}
+
+bool OctreeBuilder::verify(const std::string &_fname, uint64_t _expectedPoints, std::ostream &_log)
+{
+  OctreeFile file;
+  if(!file.open(_fname))
+  {
+    return false;
+  }
+  uint64_t total=0;
+  uint64_t outside=0;
+  for(size_t i=0; i<file.nodes().size(); ++i)
+  {
+    const OctreeNode &n=file.node(i);
+    const float *p=file.points(i);
+    total+=n.numPoints;
+    for(uint32_t j=0; j<n.numPoints; ++j)
+    {
+      for(int axis=0; axis<3; ++axis)
+      {
+        // allow for rounding in the cell calculation
+        float eps=n.size*1.0e-4f;
+        outside+= p[j*3+axis] < n.min[axis]-eps || p[j*3+axis] > n.min[axis]+n.size+eps;
+      }
+    }
+  }
+  bool ok= total == file.header().numPoints && outside == 0 &&
+           (_expectedPoints == 0 || total == _expectedPoints);
+  _log<<"Octree "<<_fname<<" holds "<<total<<" points, header says "<<file.header().numPoints;
+  if(_expectedPoints)
+  {
+    _log<<", input had "<<_expectedPoints;
+  }
+  _log<<", "<<outside<<" coordinates outside their node : "<<(ok ? "ok" : "FAILED")<<'\n';
+  return ok;
+}
@@ -0,0 +1,85 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "OctreeBuilder.h"
+#include "Workload.h"
+
+/// @brief write _count random points of a Workload shape to a raw xyz file a million at a time, for testing without a scan
+bool generatePoints(const std::string &_fname, uint64_t _count, Workload::Shape _shape)
+{
+  std::ofstream file(_fname,std::ios::binary);
+  if(!file.is_open())
+  {
+    std::cerr<<"unable to open "<<_fname<<" for writing\n";
+    return false;
+  }
+  Workload gen(_shape);
+  const uint64_t chunk=1<<20;
+  std::vector<float> points(chunk*3);
+  for(uint64_t first=0; first<_count; first+=chunk)
+  {
+    size_t count=static_cast<size_t>(std::min(chunk,_count-first));
+    gen.generate(points.data(),count,first);
+    file.write(reinterpret_cast<const char *>(points.data()),static_cast<std::streamsize>(count*3*sizeof(float)));
+  }
+  std::cout<<"Generated "<<_count<<" "<<Workload::shapeName(_shape)<<" points in "<<_fname<<'\n';
+  return file.good();
+}
+
+int main(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription("build an out of core octree from a raw xyz or binary PLY point cloud");
+  parser.addHelpOption();
+  parser.addPositionalArgument("input","raw float32 xyz or binary PLY file");
+  parser.addPositionalArgument("output","the octree file to write");
+  OctreeBuilder::Config defaults;
+  QCommandLineOption depthOption("depth","the deepest octree level (max 8)","levels",QString::number(defaults.maxDepth));
+  QCommandLineOption nodeOption("node-points","split nodes with more points than this","count",QString::number(defaults.nodePoints));
+  QCommandLineOption generateOption("generate","first write this many random points to the input file","count");
+  QCommandLineOption workloadOption("workload",QString::fromStdString("the shape of the --generate points : "+Workload::shapeNames()),
+                                    "shape","uniform");
+  QCommandLineOption verifyOption("verify","check every point is in the output once and inside its node");
+  parser.addOptions({depthOption,nodeOption,generateOption,workloadOption,verifyOption});
+  parser.process(app);
+  QStringList args=parser.positionalArguments();
+  if(args.size() != 2)
+  {
+    parser.showHelp(EXIT_FAILURE);
+  }
+  std::string input=args[0].toStdString();
+  std::string output=args[1].toStdString();
+  uint64_t generated=0;
+  if(parser.isSet(generateOption))
+  {
+    generated=parser.value(generateOption).toULongLong();
+    Workload::Shape shape;
+    if(!Workload::parseShape(parser.value(workloadOption).toStdString(),shape))
+    {
+      std::cerr<<"unknown workload "<<parser.value(workloadOption).toStdString()<<", use one of "<<Workload::shapeNames()<<"\n";
+      return EXIT_FAILURE;
+    }
+    if(!generatePoints(input,generated,shape))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  OctreeBuilder::Config config;
+  config.maxDepth=parser.value(depthOption).toUInt();
+  config.nodePoints=parser.value(nodeOption).toULongLong();
+  OctreeBuilder builder(config);
+  if(!builder.build(input,output))
+  {
+    return EXIT_FAILURE;
+  }
+  if(parser.isSet(verifyOption) && !OctreeBuilder::verify(output,generated,std::cout))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -3,6 +3,12 @@
 #include <ngl/Transformation.h>
 #include <ngl/Text.h>
 #include <QOpenGLWindow>
+#include <memory>
+#include <string>
+#include "FrameScheduler.h"
+#include "PointBuffer.h"
+#include "PointCloudLoader.h"
+#include "PointGenerator.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
 /// @brief this class inherits from the Qt OpenGLWindow and allows us to use NGL to draw OpenGL
@@ -44,6 +50,39 @@ class NGLScene : public QOpenGLWindow
     void resizeGL(QResizeEvent *_event);
     // Qt 5.x uses this instead! http://doc.qt.io/qt-5/qopenglwindow.html#resizeGL
     void resizeGL(int _w, int _h);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set how frames are paced, see FrameScheduler
+    /// @param _mode the pacing mode
+    /// @param _fps the target frame rate when _mode is FrameScheduler::Mode::FixedRate
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFrameMode(FrameScheduler::Mode _mode, double _fps=60.0){m_scheduler.setMode(_mode,_fps);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advance the animation by a fixed step each frame rather than the real time, for batch rendering
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFixedStep(double _seconds){m_scheduler.setFixedStep(_seconds);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief change the number of points, the GPU buffer only grows when its capacity is exceeded
+    /// and shrinking keeps the memory until shrinkToFit is called. Can be called before the window is shown.
+    /// @param _size the new number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void setNumPoints(unsigned int _size);
+    unsigned int numPoints() const {return m_numPoints;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief release the unused capacity of the point buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    void shrinkToFit();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a one line summary of the used and allocated buffer memory
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string memoryUsage() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the points from a raw xyz or binary PLY file rather than generating them, the file
+    /// is streamed into the buffer a few chunks each frame so drawing starts before it has all loaded.
+    /// Call before the window is shown.
+    /// @param _fname the file to load
+    /// @returns false if the file can't be read, the random points are used instead
+    //----------------------------------------------------------------------------------------------------------------------
+    bool loadPoints(const std::string &_fname);
 
 private:
     //----------------------------------------------------------------------------------------------------------------------
@@ -69,7 +108,6 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     void mouseReleaseEvent ( QMouseEvent *_event );
 
-    void timerEvent(QTimerEvent *_event);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is called everytime the mouse wheel is moved
     /// inherited from QObject and overridden here.
@@ -80,14 +118,33 @@ private:
     void createPoints(unsigned int _size);
     /// @brief upate points
     void updatePoints(unsigned int _size);
+    /// @brief generate points [_first,_first+_count) straight into the buffer, which must already hold them
+    /// @returns true if they were written through a mapping rather than the scratch fallback
+    bool generatePoints(unsigned int _first, unsigned int _count);
+    /// @brief point attribute 0 of the VAO at the current buffer
+    void setAttributePointer();
+    /// @brief upload the next chunks of the file and fit the view to what has loaded
+    void streamFilePoints();
 
     /// @brief VP matrix combination of view and project
     /// this is set once as static camera.
     ngl::Mat4 m_vp;
     /// @brief a vertex array object to contain the points
     GLuint m_vao;
+    /// @brief the buffer holding the points, this has a capacity larger than needed
+    PointBuffer m_buffer;
+    /// @brief the number of points drawn
+    unsigned int m_numPoints;
     /// @brief store simple rotation
     ngl::Real m_rot;
+    /// @brief drives the redraws from frameSwapped and gives the time between frames
+    FrameScheduler m_scheduler;
+    /// @brief reads the points when they come from a file, null when they are generated
+    std::unique_ptr<PointCloudLoader> m_loader;
+    /// @brief scales and centres points loaded from a file into view
+    ngl::Transformation m_fit;
+    /// @brief generates the random points, the seed is changed to get a new set
+    PointGenerator m_generator;
     int m_width;
     int m_height;
 
@@ -1,19 +1,29 @@
 #include <QMouseEvent>
 #include <QGuiApplication>
+#include <algorithm>
+#include <cstdio>
 
 #include "NGLScene.h"
+#include "GLState.h"
+#include "ScratchPool.h"
+#include "Trace.h"
 #include <ngl/NGLInit.h>
-#include <ngl/Random.h>
 #include <ngl/ShaderLib.h>
 #include <ngl/Util.h>
 
-const static int s_numPoints=100000;
+/// @brief the number of points to start with, can be changed with setNumPoints
+const static unsigned int s_defaultNumPoints=100000;
+/// @brief how fast the points spin in degrees per second
+const static ngl::Real s_rotationSpeed=100.0f;
+/// @brief how long each frame may spend streaming a point cloud file into the buffer
+const static double s_loadBudgetMs=8.0;
 
-NGLScene::NGLScene()
+NGLScene::NGLScene() : m_scheduler(this)
 {
   // re-size the widget to that of the parent (in this case the GLFrame passed in on construction)
   setTitle("Drawing Using raw OpenGL commands ");
   m_rot=0.0;
+  m_numPoints=s_defaultNumPoints;
 }
 
 
@@ -59,87 +69,200 @@ void NGLScene::initializeGL()
   shader->use("nglColourShader");
   // set the colour to red
   shader->setUniform("Colour",1.0f,1.0f,1.0f,1.0f);
-  createPoints(s_numPoints);
+  createPoints(m_numPoints);
   glPointSize(5);
-  startTimer(1);
+  // start the render loop, the next frame is requested each time one is swapped
+  m_scheduler.start();
 }
 
-void NGLScene::createPoints(unsigned int _size)
+bool NGLScene::loadPoints(const std::string &_fname)
 {
-  // we are going to create an array of random points using the
-  // random generator in ngl
-  ngl::Random *rng= ngl::Random::instance();
-  // create an array of ngl::Vec3 and re-size
-  std::vector<ngl::Vec3> points(_size);
-
-  // now populate the array with random points in the range -5 -> 5
-  for(unsigned int i=0; i<_size; ++i)
+  std::unique_ptr<PointCloudLoader> loader(new PointCloudLoader);
+  if(!loader->open(_fname))
   {
-    points[i]=rng->getRandomPoint(5.0f,5.0f,5.0f);
+    return false;
   }
+  m_loader=std::move(loader);
+  m_numPoints=0;
+  return true;
+}
 
+void NGLScene::createPoints(unsigned int _size)
+{
+  TRACE_SCOPE("NGLScene::createPoints");
   // create a VAO and store the ID
   glGenVertexArrays(1, &m_vao);
-
-
+  if(m_loader)
+  {
+    // size the buffer for the whole file once, the chunks are then written into it as they load
+    m_buffer.resize(m_loader->numPoints()*sizeof(ngl::Vec3));
+    setAttributePointer();
+    return;
+  }
   // first create the VAO
   // to use this it must be bound
   glBindVertexArray(m_vao);
 
-  // now create a buffer for our data
-  GLuint vboID;
-  glGenBuffers(1, &vboID);
-  // now we will bind an array buffer to the first one and load the data for the verts
-  glBindBuffer(GL_ARRAY_BUFFER, vboID);
-  // copy the data
-  glBufferData(GL_ARRAY_BUFFER, points.size()*sizeof(ngl::Vec3), &points[0].m_x, GL_STATIC_DRAW);
+  // now size the buffer for our data, this keeps a capacity so the number of points can change
+  // without re-allocating each time
+  m_buffer.resize(_size*sizeof(ngl::Vec3));
+  // now populate the buffer with random points in the range -5 -> 5, this is split across all
+  // cores and gives the same points for a seed, they are written straight into the mapped buffer
+  generatePoints(0,_size);
   // now we need to tell OpenGL the size and layout of the data
-  glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,0,((ngl::Real *)NULL + 0));
-  glEnableVertexAttribArray(0);
+  setAttributePointer();
 
   // always best to unbind after use
   glBindVertexArray(0);
 }
 
 
-void NGLScene::updatePoints(unsigned int _size)
+void NGLScene::streamFilePoints()
 {
-  std::cout<<"update\n";
-  // we are going to create an array of random points using the
-  // random generator in ngl
-  ngl::Random *rng= ngl::Random::instance();
-  // create an array of ngl::Vec3 and re-size
-  std::vector<ngl::Vec3> points(_size);
+  PointBuffer &buffer=m_buffer;
+  m_loader->loadChunks(s_loadBudgetMs,[&buffer](size_t _offset, size_t _bytes, const float *_xyz)
+  {
+    buffer.upload(_offset,_bytes,_xyz);
+  });
+  // draw whatever has arrived so far
+  m_numPoints=static_cast<unsigned int>(m_loader->loadedPoints());
+  if(m_numPoints == 0)
+  {
+    return;
+  }
+  // scale and centre what has loaded so far to fit the -5 -> 5 box the camera looks at
+  ngl::Vec3 centre=(m_loader->minBounds()+m_loader->maxBounds())*0.5f;
+  ngl::Vec3 extent=m_loader->maxBounds()-m_loader->minBounds();
+  ngl::Real size=std::max(extent.m_x,std::max(extent.m_y,extent.m_z));
+  ngl::Real scale= size > 0.0f ? 10.0f/size : 1.0f;
+  m_fit.setScale(scale,scale,scale);
+  m_fit.setPosition(centre*-scale);
+}
 
-  // now populate the array with random points in the range -5 -> 5
-  for(unsigned int i=0; i<_size; ++i)
+void NGLScene::updatePoints(unsigned int _size)
+{
+  TRACE_SCOPE("NGLScene::updatePoints");
+  if(m_loader)
   {
-    points[i]=rng->getRandomPoint(5.0f,5.0f,5.0f);
+    std::cout<<"points are loaded from a file so can't be re-generated\n";
+    return;
   }
-  // to use this it must be bound
-  glBindVertexArray(m_vao);
-  // now copy the data
+  // a new seed gives a new set of points
+  m_generator.setSeed(m_generator.seed()+1);
+  ScratchPool::Stats before=ScratchPool::instance()->stats();
+  unsigned int reallocations=m_buffer.reallocations();
+  // the buffer is only re-allocated if it is too small
+  if(m_buffer.resize(_size*sizeof(ngl::Vec3)))
+  {
+    setAttributePointer();
+  }
+  bool mapped=generatePoints(0,_size);
+  m_numPoints=_size;
+  // nothing point sized should be allocated once the buffer is big enough
+  std::cout<<"update "<<(mapped ? "written in place" : "uploaded from scratch")<<", "
+           <<ScratchPool::instance()->stats().allocations-before.allocations<<" scratch allocations, "
+           <<m_buffer.reallocations()-reallocations<<" buffer re-allocations\n";
 
-//  glBindBuffer(GL_ARRAY_BUFFER, m_vao);
-  glBufferData(GL_ARRAY_BUFFER, points.size()*sizeof(ngl::Vec3), &points[0].m_x, GL_STATIC_DRAW);
+}
 
-  // always best to unbind after use
+bool NGLScene::generatePoints(unsigned int _first, unsigned int _count)
+{
+  PointGenerator &generator=m_generator;
+  return m_buffer.write(_first*sizeof(ngl::Vec3),_count*sizeof(ngl::Vec3),[&generator,_first,_count](void *o_xyz)
+  {
+    generator.generate(static_cast<float *>(o_xyz),_count,_first);
+  });
+}
+
+void NGLScene::setAttributePointer()
+{
+  // the attribute pointer records the buffer bound when it is set, so this needs
+  // to be done again each time the buffer is re-allocated
+  glBindVertexArray(m_vao);
+  // through the cache the PointBuffer binds with, so it knows this buffer is bound
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER, m_buffer.id());
+  glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,0,((ngl::Real *)NULL + 0));
+  glEnableVertexAttribArray(0);
   glBindVertexArray(0);
+}
 
+void NGLScene::setNumPoints(unsigned int _size)
+{
+  _size=std::max(1u,_size);
+  unsigned int oldSize=m_numPoints;
+  m_numPoints=_size;
+  // before initializeGL we just store the size for createPoints, file points keep the file's size
+  if(m_loader)
+  {
+    m_numPoints=oldSize;
+    return;
+  }
+  if(!isValid() || _size == oldSize)
+  {
+    return;
+  }
+  makeCurrent();
+  if(m_buffer.resize(_size*sizeof(ngl::Vec3)))
+  {
+    setAttributePointer();
+  }
+  if(_size > oldSize)
+  {
+    // point i only depends on the seed and i so just generate the new ones
+    generatePoints(oldSize,_size-oldSize);
+  }
+  std::cout<<memoryUsage()<<"\n";
+  update();
+}
+
+void NGLScene::shrinkToFit()
+{
+  if(!isValid())
+  {
+    return;
+  }
+  makeCurrent();
+  if(m_buffer.shrinkToFit())
+  {
+    setAttributePointer();
+  }
+  // the scratch blocks are only used when the buffer couldn't be mapped
+  ScratchPool::instance()->trim();
+  std::cout<<memoryUsage()<<"\n";
+}
+
+std::string NGLScene::memoryUsage() const
+{
+  const double mb=1024.0*1024.0;
+  char buffer[160];
+  std::snprintf(buffer,sizeof(buffer),"%u points, buffer %.2f MB used of %.2f MB (%.1f%% unused), scratch %.2f MB",
+                m_numPoints,m_buffer.size()/mb,m_buffer.capacity()/mb,
+                m_buffer.capacity() ? 100.0*m_buffer.wastedBytes()/m_buffer.capacity() : 0.0,
+                ScratchPool::instance()->stats().bytesHeld/mb);
+  return buffer;
 }
 
 void NGLScene::paintGL()
 {
+  // advance the animation by the real time since the last frame
+  m_rot+=s_rotationSpeed*m_scheduler.tick();
+  TRACE_SCOPE("NGLScene::paintGL");
   // clear the screen and depth buffer
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   glViewport(0,0,m_width,m_height);
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
   ngl::Transformation transform;
   transform.setRotation(0.0,m_rot,0.0);
-  ngl::Mat4 MVP=m_vp*transform.getMatrix();
+  // a file is loaded a few chunks a frame
+  if(m_loader && m_loader->isOpen())
+  {
+    streamFilePoints();
+  }
+  ngl::Mat4 MVP=m_vp*transform.getMatrix()*m_fit.getMatrix();
   shader->setUniform("MVP",MVP);
+  TRACE_SCOPE("draw");
   glBindVertexArray(m_vao);
-  glDrawArrays(GL_POINTS,0,s_numPoints);
+  glDrawArrays(GL_POINTS,0,static_cast<GLsizei>(m_numPoints));
   glBindVertexArray(0);
 
 }
@@ -172,22 +295,23 @@ void NGLScene::wheelEvent(QWheelEvent *)
 
 void NGLScene::keyPressEvent(QKeyEvent *_event)
 {
+  TRACE_SCOPE("NGLScene::keyPressEvent");
   // this method is called every time the main window recives a key event.
   // we then switch on the key value and set the camera in the GLWindow
   switch (_event->key())
   {
   // escape key to quite
   case Qt::Key_Escape : QGuiApplication::exit(EXIT_SUCCESS); break;
-  case Qt::Key_Space : updatePoints(s_numPoints); break;
+  case Qt::Key_Space : updatePoints(m_numPoints); break;
+  case Qt::Key_Plus :
+  case Qt::Key_Equal : setNumPoints(m_numPoints*2); break;
+  case Qt::Key_Minus : setNumPoints(m_numPoints/2); break;
+  case Qt::Key_C : shrinkToFit(); break;
+  case Qt::Key_P : m_scheduler.togglePause(); break;
+  case Qt::Key_E : Trace::instance()->toggle(std::cout); break;
   default : break;
   }
   // finally update the GLWindow and re-draw
   update();
 }
 
-
-void NGLScene::timerEvent(QTimerEvent *)
-{
-  m_rot+=0.1;
-  update();
-}
@@ -2,12 +2,45 @@
 basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwindow.html
 ****************************************************************************/
 #include <QtGui/QGuiApplication>
+#include <QCommandLineParser>
 #include <iostream>
+#include "BatchRenderer.h"
 #include "NGLScene.h"
+#include "Trace.h"
 
 int main(int argc, char **argv)
 {
   QGuiApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  QCommandLineOption frameOption("frame-mode","how frames are paced : vsync (default), unthrottled, paused or a target fps","mode","vsync");
+  parser.addOption(frameOption);
+  QCommandLineOption pointsOption("points","the number of points to draw","count","100000");
+  parser.addOption(pointsOption);
+  QCommandLineOption loadOption("load","draw the points from a raw float32 xyz or binary PLY file","file");
+  parser.addOption(loadOption);
+  QCommandLineOption batchOption("batch","render this many frames offscreen to images and exit, no display is needed","frames");
+  parser.addOption(batchOption);
+  QCommandLineOption outputOption("output","the image of each --batch frame, %d is the frame number and the extension picks the format","pattern","frame%04d.png");
+  parser.addOption(outputOption);
+  QCommandLineOption traceOption("trace","record a Chrome trace from the start, written to this file on exit (E starts and stops one at any time)","file");
+  parser.addOption(traceOption);
+  parser.process(app);
+  // the GUI thread does the drawing and event handling
+  Trace::setThreadName("main");
+  if(parser.isSet(traceOption))
+  {
+    Trace::instance()->setFile(parser.value(traceOption).toStdString());
+    Trace::instance()->start();
+  }
+  double fps=60.0;
+  FrameScheduler::Mode frameMode=FrameScheduler::Mode::VSync;
+  if(!FrameScheduler::parseMode(parser.value(frameOption),frameMode,fps))
+  {
+    std::cerr<<"unknown frame mode "<<parser.value(frameOption).toStdString()
+             <<", use vsync, unthrottled, paused or a target fps above 0\n";
+    return EXIT_FAILURE;
+  }
   // create an OpenGL format specifier
   QSurfaceFormat format;
   // set the number of samples for multisampling
@@ -27,17 +60,52 @@ int main(int argc, char **argv)
   format.setProfile(QSurfaceFormat::CoreProfile);
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
+  // vsync needs a swap interval of 1, the other modes pace themselves
+  FrameScheduler::configureFormat(format,frameMode);
   QSurfaceFormat::setDefaultFormat(format);
+  // made before the scene so the batch context outlives the scene's GL objects
+  BatchRenderer::Options batchOptions;
+  batchOptions.frames=parser.value(batchOption).toUInt();
+  batchOptions.pattern=parser.value(outputOption).toStdString();
+  BatchRenderer batch(batchOptions);
   // now we are going to create our scene window
   NGLScene window;
   // we can now query the version to see if it worked
   std::cout<<"Profile is "<<format.majorVersion()<<" "<<format.minorVersion()<<"\n";
   // set the window size
-  window.resize(1024, 720);
+  window.resize(batchOptions.width,batchOptions.height);
+  window.setFrameMode(frameMode,fps);
+  window.setNumPoints(parser.value(pointsOption).toUInt());
+  if(parser.isSet(loadOption) && !window.loadPoints(parser.value(loadOption).toStdString()))
+  {
+    std::cerr<<"using random points instead\n";
+  }
+  if(parser.isSet(batchOption))
+  {
+    // the frames are a fixed time apart, 1/fps with a --frame-mode rate
+    window.setFixedStep(1.0/fps);
+    bool ok=batch.run(format,[&window,&batchOptions]
+    {
+      window.initializeGL();
+      window.resizeGL(batchOptions.width,batchOptions.height);
+    },
+    [&window]{window.paintGL();},std::cout);
+    if(Trace::instance()->isRecording())
+    {
+      ok&=Trace::instance()->stop(std::cout);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
   // and finally show
   window.show();
 
-  return app.exec();
+  int result=app.exec();
+  // a capture still recording is written on exit
+  if(Trace::instance()->isRecording())
+  {
+    Trace::instance()->stop(std::cout);
+  }
+  return result;
 }
 
 
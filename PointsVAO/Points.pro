@@ -16,11 +16,21 @@ MOC_DIR=moc
 CONFIG-=app_bundle
 # Auto include all .cpp files in the project src directory (can specifiy individually if required)
 SOURCES+= $$PWD/src/NGLScene.cpp    \
+					$$PWD/src/RingBufferVAO.cpp \
+					$$PWD/src/GrowableVAO.cpp \
+					$$PWD/src/OctreeLOD.cpp \
+					$$PWD/src/AsyncRegenerator.cpp \
 					$$PWD/src/main.cpp
 # same for the .h files
-HEADERS+= $$PWD/include/NGLScene.h
+HEADERS+= $$PWD/include/NGLScene.h \
+					$$PWD/include/RingBufferVAO.h \
+					$$PWD/include/GrowableVAO.h \
+					$$PWD/include/OctreeLOD.h \
+					$$PWD/include/AsyncRegenerator.h
 # and add the include dir into the search path for Qt and make
 INCLUDEPATH +=./include
+# code shared between the demos (point generation etc)
+include($$PWD/../Common/Common.pri)
 # where our exe is going to live (root of project)
 DESTDIR=./
 # add the glsl shader files
@@ -0,0 +1,166 @@
+#ifndef ASYNCREGENERATOR_H_
+#define ASYNCREGENERATOR_H_
+#include "FrameProfiler.h"
+#include "Workload.h"
+#include <ngl/Types.h>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLWindow>
+#include <QThread>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AsyncRegenerator.h
+/// @brief generates and uploads new sets of points on a worker thread so the render thread never waits for them
+/// @class AsyncRegenerator
+/// @brief the worker has its own QOpenGLContext sharing objects with the window's. For each request it
+/// generates the points on its own thread at low priority (not on the ThreadPool the render thread uses), uploads them into a new buffer, puts a fence after the upload and flushes. Each
+/// frame the render thread calls swap, which checks the fence without waiting and once it has signalled
+/// points its VAO at the new buffer and deletes the old one, so the switch happens between two draws.
+/// If several requests arrive while one is running only the latest is generated. The worker asks the window
+/// for a frame when a set is ready, so it appears even when the frame scheduler is paused. The time from
+/// request to the frameSwapped of the first frame drawing the new points is recorded so the latency of a key
+/// press can be measured.
+//----------------------------------------------------------------------------------------------------------------------
+
+class AsyncRegenerator : public QThread
+{
+  public :
+    using Clock=std::chrono::steady_clock;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief timings of the regenerations so far
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      size_t completed=0;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief request to the new points being on screen in ms
+      //----------------------------------------------------------------------------------------------------------------------
+      double lastLatencyMs=0.0;
+      double meanLatencyMs=0.0;
+      double maxLatencyMs=0.0;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the worker's time generating and uploading the last set
+      //----------------------------------------------------------------------------------------------------------------------
+      double lastGenerateMs=0.0;
+      double lastUploadMs=0.0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, must be called on the GUI thread as it creates the worker's surface and context
+    /// @param _window the window, its context is shared and it is asked to update when a set is ready
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit AsyncRegenerator(QOpenGLWindow *_window);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor stops the worker, the window's context must be current to delete the render side objects
+    //----------------------------------------------------------------------------------------------------------------------
+    ~AsyncRegenerator();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ask for a new set of points, returns straight away
+    /// @param _size the number of points
+    /// @param _seed the Workload seed
+    /// @param _shape the Workload shape
+    //----------------------------------------------------------------------------------------------------------------------
+    void request(unsigned int _size, uint64_t _seed, Workload::Shape _shape);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief switch to the newest finished set if its upload has completed, never blocks. Call on the
+    /// render thread each frame before drawing, while the upload is in flight another frame is requested.
+    /// @returns true if new points were swapped in
+    //----------------------------------------------------------------------------------------------------------------------
+    bool swap();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frame drawn after swap has been swapped to the screen, this stops the latency clock
+    /// @returns true if that frame had new points and the stats were updated
+    //----------------------------------------------------------------------------------------------------------------------
+    bool presented();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the current set, the shader must already be set up
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief has a set been swapped in yet
+    //----------------------------------------------------------------------------------------------------------------------
+    bool ready() const {return m_buffer != 0;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief is a request being worked on or waiting to be swapped in
+    //----------------------------------------------------------------------------------------------------------------------
+    bool busy() const;
+    unsigned int size() const {return m_size;}
+    const Stats &stats() const {return m_stats;}
+    std::string hudLine() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add the CPU time of a frame, kept apart for frames drawn while a set was being made
+    //----------------------------------------------------------------------------------------------------------------------
+    void addFrameTime(double _ms);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frame time percentiles while busy and idle, for the HUD
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string frameLine() const;
+
+  protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the worker loop
+    //----------------------------------------------------------------------------------------------------------------------
+    void run() override;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a request from the render thread
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Request
+    {
+      unsigned int size;
+      uint64_t seed;
+      Workload::Shape shape;
+      Clock::time_point time;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief an uploaded set waiting for its fence
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Result
+    {
+      GLuint buffer;
+      GLsync fence;
+      unsigned int size;
+      Clock::time_point requested;
+      double generateMs;
+      double uploadMs;
+    };
+    QOpenGLWindow *m_window;
+    QOffscreenSurface m_surface;
+    std::unique_ptr<QOpenGLContext> m_context;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the context goes back to this thread when the worker finishes so the dtor can delete it
+    //----------------------------------------------------------------------------------------------------------------------
+    QThread *m_guiThread;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards everything shared with the worker
+    //----------------------------------------------------------------------------------------------------------------------
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop=false;
+    bool m_hasRequest=false;
+    bool m_working=false;
+    Request m_request;
+    std::vector<Result> m_results;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief render thread side, the VAO belongs to the window's context as VAOs aren't shared
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_vao=0;
+    GLuint m_buffer=0;
+    unsigned int m_size=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the set swapped in this frame, timed once the frame is on screen
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_swapped=false;
+    Result m_lastResult;
+    Stats m_stats;
+    RollingHistogram m_busyFrames;
+    RollingHistogram m_idleFrames;
+};
+
+#endif
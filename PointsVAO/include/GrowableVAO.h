@@ -0,0 +1,85 @@
+#ifndef GROWABLEVAO_H_
+#define GROWABLEVAO_H_
+#include <ngl/AbstractVAO.h>
+#include "PointBuffer.h"
+#include <memory>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GrowableVAO.h
+/// @brief a VAO whose vertex buffer has a capacity so the number of points can change cheaply
+/// @class GrowableVAO
+/// @brief the same as a ngl::SimpleVAO except the data is held in a PointBuffer. Changing the size
+/// only re-allocates when the capacity is exceeded, if that happens the buffer id changes and
+/// setVertexAttributePointer must be called again (resize and setData return true).
+//----------------------------------------------------------------------------------------------------------------------
+
+class GrowableVAO : public ngl::AbstractVAO
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief creator method for the factory
+    /// @param _mode the mode to draw with.
+    /// @returns a new AbstractVAO * object
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::unique_ptr<ngl::AbstractVAO> create(GLenum _mode)
+    {
+      return std::unique_ptr<ngl::AbstractVAO>(new GrowableVAO(_mode));
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor, the buffer is released by the PointBuffer
+    //----------------------------------------------------------------------------------------------------------------------
+    ~GrowableVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the first numIndices vertices
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void draw() const override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief remove the VAO and buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void removeVAO() override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief resize the buffer to _data.m_size and copy the data in
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void setData(const VertexData &_data) override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief return the id of the buffer, there is only one so the index is ignored
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual GLuint getBufferID(unsigned int ) override {return m_buffer.id();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map the buffer, unmap with unmapBuffer
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual ngl::Real * mapBuffer(unsigned int _index=0, GLenum _accessMode=GL_READ_WRITE) override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief change the number of bytes used, existing data is kept
+    /// @returns true if the buffer was re-allocated and the attribute pointers need setting again
+    //----------------------------------------------------------------------------------------------------------------------
+    bool resize(size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write part of the buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSubData(size_t _offset, size_t _bytes, const void *_data){m_buffer.upload(_offset,_bytes,_data);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fill part of the buffer in place, see PointBuffer::write
+    /// @returns true if it was written through a mapping
+    //----------------------------------------------------------------------------------------------------------------------
+    template <typename F> bool write(size_t _offset, size_t _bytes, const F &_fill){return m_buffer.write(_offset,_bytes,_fill);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief release unused capacity
+    /// @returns true if the buffer was re-allocated and the attribute pointers need setting again
+    //----------------------------------------------------------------------------------------------------------------------
+    bool shrinkToFit(){return m_buffer.shrinkToFit();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief access to the buffer for the size / capacity stats
+    //----------------------------------------------------------------------------------------------------------------------
+    const PointBuffer &buffer() const {return m_buffer;}
+
+  protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor calls parent ctor to allocate vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    GrowableVAO(GLenum _mode)  : AbstractVAO(_mode){}
+
+  private :
+    PointBuffer m_buffer;
+};
+
+#endif
@@ -4,7 +4,23 @@
 #include <ngl/AbstractVAO.h>
 #include <ngl/Text.h>
 #include <QOpenGLWindow>
+#include "AsyncRegenerator.h"
+#include "AttributePoints.h"
+#include "FrameProfiler.h"
+#include "FrameUniforms.h"
+#include "ChunkGrid.h"
+#include "ComputeRasteriser.h"
+#include "FrameScheduler.h"
+#include "MortonSort.h"
+#include "OctreeLOD.h"
+#include "ParticleSystem.h"
+#include "PointCloudLoader.h"
+#include "Workload.h"
+#include "ProceduralPoints.h"
+#include "QuantisedPoints.h"
+#include <chrono>
 #include <memory>
+#include <string>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
 /// @brief this class inherits from the Qt OpenGLWindow and allows us to use NGL to draw OpenGL
@@ -43,6 +59,99 @@ class NGLScene : public QOpenGLWindow
     /// @brief this is called everytime we resize
     //----------------------------------------------------------------------------------------------------------------------
     void resizeGL(int _w, int _h);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set how frames are paced, see FrameScheduler
+    /// @param _mode the pacing mode
+    /// @param _fps the target frame rate when _mode is FrameScheduler::Mode::FixedRate
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFrameMode(FrameScheduler::Mode _mode, double _fps=60.0){m_scheduler.setMode(_mode,_fps);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advance the animation by a fixed step each frame rather than the real time, for batch rendering
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFixedStep(double _seconds){m_scheduler.setFixedStep(_seconds);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief when the program started, the time to the first frame is printed from this
+    //----------------------------------------------------------------------------------------------------------------------
+    void setStartTime(std::chrono::steady_clock::time_point _start){m_startTime=_start; m_firstFrame=true;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief change the number of points, the GPU buffer only grows when its capacity is exceeded
+    /// and shrinking keeps the memory until shrinkToFit is called. Can be called before the window is shown.
+    /// @param _size the new number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void setNumPoints(unsigned int _size);
+    unsigned int numPoints() const {return m_numPoints;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the shape of the generated points, see Workload. The procedural points and particles are always
+    /// uniform as they are made on the GPU. Call before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setWorkload(Workload::Shape _shape){m_generator.setShape(_shape);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief release the unused capacity of the point buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    void shrinkToFit();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes of point data in use and allocated on the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t usedBytes() const;
+    size_t capacityBytes() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a one line summary of the used and allocated buffer memory
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string memoryUsage() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the points from a raw xyz or binary PLY file rather than generating them, the file
+    /// is streamed into the buffer a few chunks each frame so drawing starts before it has all loaded.
+    /// Call before the window is shown.
+    /// @param _fname the file to load
+    /// @returns false if the file can't be read, the random points are used instead
+    //----------------------------------------------------------------------------------------------------------------------
+    bool loadPoints(const std::string &_fname);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw an out of core octree built by OctreeBuilder, only the nodes needed for the view are
+    /// loaded and at most _pointBudget points are drawn a frame. Call before the window is shown.
+    /// @param _fname the octree file
+    /// @param _pointBudget the most points to draw in a frame
+    /// @returns false if the file can't be read, the random points are used instead
+    //----------------------------------------------------------------------------------------------------------------------
+    bool loadOctree(const std::string &_fname, size_t _pointBudget);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make the random points in the vertex shader from gl_VertexID and the seed rather than on the
+    /// CPU, nothing is uploaded and a new set of points is just a new seed. Can be called before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setProcedural(bool _procedural);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief move the points as particles on the GPU with transform feedback. Can be called before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setParticles(bool _particles);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief re-generate and upload the points on a worker thread with a shared context so Space never
+    /// stalls a frame, the new points are swapped in once their upload has finished. Can be called before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setAsync(bool _async);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the float points (generated, loaded or particles) with a compute shader which splats them
+    /// into a storage buffer with atomicMin rather than as GL_POINTS, see ComputeRasteriser. Can be called
+    /// before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setComputeRaster(bool _compute);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief put the static points in Morton order before uploading them so neighbouring points are drawn
+    /// together, the chunks are then taken from the sort. Points loaded by loadPoints are sorted once the whole
+    /// file has arrived. Can be called before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSorted(bool _sorted);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sort the static generated points into spatial chunks and only draw the ones in the view frustum,
+    /// off by default so the points are generated straight into the buffer and drawn whole. Can be called
+    /// before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setChunked(bool _chunked);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief split the window into a grid of _views viewports, each with its own camera around the cloud.
+    /// Every view draws the same buffers so new points are made and uploaded once and appear in all of them.
+    /// Can be called before the window is shown.
+    //----------------------------------------------------------------------------------------------------------------------
+    void setNumViews(unsigned int _views);
 
 private:
     //----------------------------------------------------------------------------------------------------------------------
@@ -68,7 +177,6 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     void mouseReleaseEvent ( QMouseEvent *_event );
 
-    void timerEvent(QTimerEvent *_event);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is called everytime the mouse wheel is moved
     /// inherited from QObject and overridden here.
@@ -79,16 +187,124 @@ private:
     void createPoints(unsigned int _size);
     /// @brief upate points
     void updatePoints(unsigned int _size);
+    /// @brief set m_vp for the current zoom
+    void updateCamera();
+    /// @brief set m_fit so a box fills the view
+    void fitToBounds(const ngl::Vec3 &_min, const ngl::Vec3 &_max);
+    /// @brief create the buffer for the whole file loaded by loadPoints
+    void createFilePoints();
+    /// @brief upload the next chunks of the file and fit the view to what has loaded
+    void streamFilePoints();
+    /// @brief switch between the static VAO and the streaming ring buffer VAO
+    void toggleStreaming();
+    /// @brief step the static points through float, 16 bit and 10:10:10:2 positions
+    void cycleQuantisation();
+    /// @brief step the generated points through each Workload shape
+    void cycleWorkload();
+    /// @brief step the static points through position only and the AoS, SoA and hot / cold attribute layouts
+    void cycleAttributeLayout();
+    /// @brief where the points come from, there is one at a time. Sorting, culling, quantising, attributes and
+    /// the compute rasteriser each work with some of them, the setters all check this rather than the members.
+    enum class PointSource{Generated,File,Octree,Streaming,Procedural,Particles,Async};
+    /// @brief the current source from the members holding each one, async counts from when it is asked for
+    PointSource pointSource() const;
+    /// @brief generate _size points into the growable VAO. When nothing needs them on the CPU they are made
+    /// straight into the mapped buffer, otherwise they are made in a ScratchPool block, Morton sorted when
+    /// sorting is on, sorted into m_chunks when culling is on and uploaded
+    /// @returns true if the points were written through a mapping
+    bool uploadStaticPoints(unsigned int _size);
+    /// @brief draw the points for one camera, the FrameData block must hold _MVP
+    void drawPoints(const ngl::Mat4 &_MVP);
+    /// @brief place the views in a grid over the window and set their cameras for the current zoom
+    void layoutViews();
+    /// @brief draw the frame timings over the scene
+    void drawHUD();
 
     /// @brief VP matrix combination of view and project
-    /// this is set once as static camera.
+    /// this is set when the camera zooms.
     ngl::Mat4 m_vp;
+    ngl::Mat4 m_view;
+    ngl::Mat4 m_projection;
+    /// @brief the camera and time for every program, written once a frame
+    FrameUniforms m_frame;
+    /// @brief seconds of animation so far
+    ngl::Real m_time=0.0f;
+    /// @brief the plain colour shader reading the MVP from m_frame
+    GLuint m_colourProgram=0;
+    /// @brief set by setStartTime, the first paintGL prints how long startup took
+    std::chrono::steady_clock::time_point m_startTime;
+    bool m_firstFrame=false;
+    /// @brief wheel notches the camera has been moved in (negative) or out
+    int m_zoom=0;
     /// @brief a vertex array object to contain the points
     std::unique_ptr <ngl::AbstractVAO> m_vao;
     /// @brief store simple rotation
     ngl::Real m_rot;
-    int m_width;
-    int m_height;
+    /// @brief the number of points drawn
+    unsigned int m_numPoints;
+    /// @brief drives the redraws from frameSwapped and gives the time between frames
+    FrameScheduler m_scheduler;
+    /// @brief reads the points when they come from a file, null when they are generated
+    std::unique_ptr<PointCloudLoader> m_loader;
+    /// @brief scales and centres points loaded from a file into view
+    ngl::Transformation m_fit;
+    ngl::Real m_fitScale=1.0f;
+    /// @brief the out of core octree when drawing one, null otherwise
+    std::unique_ptr<OctreeLOD> m_octree;
+    /// @brief generates the random points, the seed is changed to get a new set
+    Workload m_generator;
+    /// @brief GPU timer queries for the clear, upload and draw phases plus CPU frame times
+    FrameProfiler m_profiler;
+    /// @brief text used to draw the frame time HUD
+    std::unique_ptr<ngl::Text> m_text;
+    /// @brief toggle the HUD on and off
+    bool m_showHUD=true;
+    /// @brief when true the points are re-generated every frame into a persistently
+    /// mapped RingBufferVAO rather than a ngl::SimpleVAO
+    bool m_streaming=false;
+    /// @brief when true the static points are sorted into m_chunks and only the chunks in the
+    /// view frustum are drawn
+    bool m_chunked=false;
+    /// @brief the spatial chunks of the static points
+    ChunkGrid m_chunks;
+    /// @brief when true the static points are put in Morton order before they are uploaded
+    bool m_sorted=false;
+    MortonSort m_sorter;
+    /// @brief a copy of the file points as they load when they are to be sorted, emptied once sorted
+    std::vector<ngl::Vec3> m_filePoints;
+    /// @brief the static points with quantised positions, null when they are drawn as floats
+    std::unique_ptr<QuantisedPoints> m_quantised;
+    /// @brief the static points with a colour, size and intensity each, null when only positions are drawn
+    std::unique_ptr<AttributePoints> m_attributes;
+    /// @brief draws the points made in the vertex shader, null when they are made on the CPU
+    std::unique_ptr<ProceduralPoints> m_procedural;
+    /// @brief the particle simulation, null when the points don't move
+    std::unique_ptr<ParticleSystem> m_particles;
+    /// @brief makes new points in the background, null when they are made on the render thread
+    std::unique_ptr<AsyncRegenerator> m_async;
+    /// @brief setAsync was called before there was a context to share, initializeGL starts it
+    bool m_startAsync=false;
+    /// @brief rasterises the points in a compute shader, null when they are drawn as GL_POINTS
+    std::unique_ptr<ComputeRasteriser> m_compute;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one camera of the multi view mode, its viewport is in pixels from the bottom left of the window
+    //----------------------------------------------------------------------------------------------------------------------
+    struct View
+    {
+      int x=0;
+      int y=0;
+      int width=0;
+      int height=0;
+      ngl::Mat4 view;
+      ngl::Mat4 projection;
+      ngl::Mat4 vp;
+      /// @brief each view writes its own block so the next view doesn't overwrite one still being read
+      std::unique_ptr<FrameUniforms> frame;
+    };
+    /// @brief the views sharing the buffers, empty when the whole window is one view
+    std::vector<View> m_views;
+    int m_width=0;
+    int m_height=0;
 
 
 };
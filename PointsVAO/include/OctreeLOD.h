@@ -0,0 +1,151 @@
+#ifndef OCTREELOD_H_
+#define OCTREELOD_H_
+#include <ngl/AbstractVAO.h>
+#include <ngl/Mat4.h>
+#include "OctreeFile.h"
+#include <algorithm>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OctreeLOD.h
+/// @brief draws an out of core OctreeFile within a point budget
+/// @class OctreeLOD
+/// @brief each frame the nodes are visited largest projected size first and added to the draw list
+/// until the point budget is used or the nodes get too small on screen to be worth drawing, nodes outside the
+/// frustum are skipped along with their children. As every node is a sample of its region the
+/// nodes drawn so far always give an even (if sparse) picture of the cloud.
+/// Nodes which are not resident are copied out of the mapped file on the ThreadPool, the finished
+/// ones are uploaded into their own ngl::SimpleVAO a few per frame. The VAOs are kept in an LRU
+/// cache limited to a number of bytes, the least recently drawn are evicted when it is full but
+/// never one that is needed this frame.
+//----------------------------------------------------------------------------------------------------------------------
+
+class OctreeLOD
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what happened in the last update / draw, for the HUD
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      size_t selectedNodes=0;
+      size_t drawnNodes=0;
+      size_t drawnPoints=0;
+      size_t selectedPoints=0;
+      size_t residentNodes=0;
+      size_t residentBytes=0;
+      size_t pendingLoads=0;
+      size_t uploads=0;
+      size_t evictions=0;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param _pointBudget the most points drawn in a frame
+    /// @param _cacheBytes the most GPU memory used for node VAOs
+    //----------------------------------------------------------------------------------------------------------------------
+    OctreeLOD(size_t _pointBudget, size_t _cacheBytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor, any loads still running finish on their own as they share the file and result queue
+    //----------------------------------------------------------------------------------------------------------------------
+    ~OctreeLOD();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief open an octree file, no GL calls are made so this can be called before there is a context
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief pick the nodes to draw, start loads for the missing ones and upload the ones that have loaded
+    /// @param _mvp the model view projection the points are drawn with
+    /// @param _pixelScale the viewport height / (2 tan(fov/2)), a world size s at depth d is s*_pixelScale/d pixels
+    /// @param _modelScale the uniform scale of the model matrix to take node sizes into world space
+    //----------------------------------------------------------------------------------------------------------------------
+    void update(const ngl::Mat4 &_mvp, ngl::Real _pixelScale, ngl::Real _modelScale);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the selected nodes which are resident, the shader must already be set up
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw();
+    void setPointBudget(size_t _points){m_pointBudget=std::max<size_t>(_points,1);}
+    size_t pointBudget() const {return m_pointBudget;}
+    const Stats &stats() const {return m_stats;}
+    std::string hudLine() const;
+    ngl::Vec3 minBounds() const {return m_file->minBounds();}
+    ngl::Vec3 maxBounds() const {return m_file->maxBounds();}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a node's points copied out of the file by a worker, waiting to be uploaded
+    //----------------------------------------------------------------------------------------------------------------------
+    struct LoadedNode
+    {
+      int32_t index;
+      std::vector<float> points;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finished loads, shared with the workers so it outlives us if a load is still running
+    //----------------------------------------------------------------------------------------------------------------------
+    struct LoadQueue
+    {
+      std::mutex mutex;
+      std::vector<LoadedNode> done;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a node on the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Resident
+    {
+      std::unique_ptr<ngl::AbstractVAO> vao;
+      size_t bytes;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief position in m_lru and the last frame the node was selected
+      //----------------------------------------------------------------------------------------------------------------------
+      std::list<int32_t>::iterator lru;
+      size_t frame;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief traverse the tree and fill m_selected
+    //----------------------------------------------------------------------------------------------------------------------
+    void select(const ngl::Mat4 &_mvp, ngl::Real _pixelScale, ngl::Real _modelScale);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start loads for selected nodes that aren't resident or loading
+    //----------------------------------------------------------------------------------------------------------------------
+    void requestLoads();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief move finished loads onto the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    void uploadLoaded();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief evict least recently used nodes until _bytes more will fit
+    /// @returns false if there is no room without evicting a node needed this frame
+    //----------------------------------------------------------------------------------------------------------------------
+    bool makeRoom(size_t _bytes);
+    std::shared_ptr<OctreeFile> m_file;
+    std::shared_ptr<LoadQueue> m_queue;
+    size_t m_pointBudget;
+    size_t m_cacheBytes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief nodes to draw this frame largest first
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<int32_t> m_selected;
+    std::unordered_map<int32_t,Resident> m_resident;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief resident node indices, most recently used at the front
+    //----------------------------------------------------------------------------------------------------------------------
+    std::list<int32_t> m_lru;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief node is queued or being copied by a worker
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<bool> m_loading;
+    size_t m_inFlight=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief loaded nodes waiting for their turn to upload
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<LoadedNode> m_uploads;
+    size_t m_frame=0;
+    Stats m_stats;
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef RINGBUFFERVAO_H_
+#define RINGBUFFERVAO_H_
+#include <ngl/AbstractVAO.h>
+#include <memory>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file RingBufferVAO.h
+/// @brief a VAO for streaming data that is re-generated every frame
+/// @class RingBufferVAO
+/// @brief a single immutable buffer (glBufferStorage) which is persistently mapped and split into
+/// N regions. The CPU writes region k+1 while the GPU is still drawing from region k, each region is
+/// guarded by a fence (glFenceSync) placed after the draw that used it so we only wait if the GPU
+/// is more than N-1 frames behind. The number of times we had to wait is counted so N can be tuned.
+//----------------------------------------------------------------------------------------------------------------------
+
+class RingBufferVAO : public ngl::AbstractVAO
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief creator method for the factory
+    /// @param _mode the mode to draw with.
+    /// @returns a new AbstractVAO * object
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::unique_ptr<ngl::AbstractVAO> create(GLenum _mode)
+    {
+      return std::unique_ptr<ngl::AbstractVAO>(new RingBufferVAO(_mode));
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor will unmap and delete the buffer and any outstanding fences
+    //----------------------------------------------------------------------------------------------------------------------
+    ~RingBufferVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the region last written with endWrite, a fence is placed after the draw
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void draw() const override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief remove the VAO, buffer and fences
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void removeVAO() override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocate storage so each region can hold _data.m_size bytes and copy the data
+    /// into the first region. If the buffer is already large enough the storage is re-used.
+    /// @param _data the data for one region
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void setData(const VertexData &_data) override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocate storage so each region can hold _bytes without copying anything in, the
+    /// regions are then filled with beginWrite / endWrite. The VAO must be bound.
+    /// @returns true if the buffer was re-allocated and the attribute pointers need setting again
+    //----------------------------------------------------------------------------------------------------------------------
+    bool reserve(size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief return the id of the buffer, there is only one buffer so the index is ignored
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual GLuint getBufferID(unsigned int ) override {return m_buffer;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffer is always mapped so this returns the region currently being drawn
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual ngl::Real * mapBuffer(unsigned int _index=0, GLenum _accessMode=GL_READ_WRITE) override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the number of regions in the ring, must be called before setData
+    /// @param _regions the number of regions (at least 2)
+    //----------------------------------------------------------------------------------------------------------------------
+    void setNumRegions(unsigned int _regions);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the size in bytes of one vertex, used to convert the region offset into a first vertex
+    /// @param _stride the stride of one vertex in bytes
+    //----------------------------------------------------------------------------------------------------------------------
+    void setVertexStride(GLsizei _stride){m_stride=_stride;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the next region to write into, this will wait on the region's fence if the GPU
+    /// is still using it.
+    /// @returns a pointer into the persistently mapped buffer big enough for one region
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Real *beginWrite();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief mark the region from beginWrite as complete, the next draw will use it
+    //----------------------------------------------------------------------------------------------------------------------
+    void endWrite();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the size in bytes of one region
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t regionSize() const {return m_regionSize;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of times beginWrite found its region still in use by the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int fenceWaits() const {return m_fenceWaits;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of times beginWrite has been called
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int writes() const {return m_writes;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief test if the current context can support this VAO (GL 4.4 or ARB_buffer_storage)
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool isSupported();
+
+  protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor calls parent ctor to allocate vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    RingBufferVAO(GLenum _mode)  : AbstractVAO(_mode){}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the buffer and fences but leave the VAO alone
+    //----------------------------------------------------------------------------------------------------------------------
+    void releaseBuffer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the single immutable buffer holding all regions
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_buffer=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the persistent mapping of m_buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    char *m_mapped=nullptr;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief size in bytes of each region
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_regionSize=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how many regions are in the ring
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_numRegions=3;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the region being drawn and the region being written
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_drawRegion=0;
+    unsigned int m_writeRegion=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stride of one vertex so we can convert region offsets into a first vertex
+    //----------------------------------------------------------------------------------------------------------------------
+    GLsizei m_stride=3*sizeof(GLfloat);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one fence per region, set in draw so it needs to be mutable
+    //----------------------------------------------------------------------------------------------------------------------
+    mutable std::vector<GLsync> m_fences;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief counters used to tune the number of regions
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_fenceWaits=0;
+    unsigned int m_writes=0;
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include "AsyncRegenerator.h"
+#include "GLState.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+  double msSince(AsyncRegenerator::Clock::time_point _start)
+  {
+    return std::chrono::duration<double,std::milli>(AsyncRegenerator::Clock::now()-_start).count();
+  }
+}
+
+AsyncRegenerator::AsyncRegenerator(QOpenGLWindow *_window) : m_window(_window), m_guiThread(QThread::currentThread())
+{
+  QOpenGLContext *shareContext=_window->context();
+  // the surface and context have to be made on the GUI thread, the context is then handed to the worker
+  m_surface.setFormat(shareContext->format());
+  m_surface.create();
+  m_context.reset(new QOpenGLContext);
+  m_context->setFormat(shareContext->format());
+  m_context->setShareContext(shareContext);
+  if(!m_context->create())
+  {
+    std::cerr<<"AsyncRegenerator couldn't create a shared context\n";
+  }
+  m_context->moveToThread(this);
+  // the render thread should win whenever the two want the same core
+  start(QThread::LowPriority);
+}
+
+AsyncRegenerator::~AsyncRegenerator()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop=true;
+  }
+  m_wake.notify_one();
+  wait();
+  // anything the worker finished that was never swapped in
+  GLState *state=GLState::instance();
+  for(auto &r : m_results)
+  {
+    glDeleteSync(r.fence);
+    state->deleteBuffers(1,&r.buffer);
+  }
+  if(m_vao != 0)
+  {
+    state->deleteVertexArrays(1,&m_vao);
+    state->deleteBuffers(1,&m_buffer);
+  }
+  m_context.reset();
+  m_surface.destroy();
+}
+
+void AsyncRegenerator::request(unsigned int _size, uint64_t _seed, Workload::Shape _shape)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // a request still waiting is replaced, only the latest points are wanted
+    m_request={_size,_seed,_shape,Clock::now()};
+    m_hasRequest=true;
+  }
+  m_wake.notify_one();
+}
+
+bool AsyncRegenerator::busy() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_hasRequest || m_working || !m_results.empty();
+}
+
+void AsyncRegenerator::run()
+{
+  Trace::setThreadName("AsyncRegenerator");
+  if(!m_context->makeCurrent(&m_surface))
+  {
+    std::cerr<<"AsyncRegenerator couldn't make its context current\n";
+    m_context->moveToThread(m_guiThread);
+    return;
+  }
+  std::vector<float> points;
+  while(true)
+  {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock,[this]{return m_stop || m_hasRequest;});
+      if(m_stop)
+      {
+        break;
+      }
+      request=m_request;
+      m_hasRequest=false;
+      m_working=true;
+    }
+    TRACE_SCOPE("AsyncRegenerator request");
+    Clock::time_point start=Clock::now();
+    points.resize(static_cast<size_t>(request.size)*3);
+    Workload generator(request.shape,request.seed);
+    // serial, the shared pool's threads are there for the render thread's parallelFor
+    generator.generateSerial(points.data(),request.size);
+    double generateMs=msSince(start);
+    start=Clock::now();
+    TRACE_SCOPE("AsyncRegenerator upload");
+    // always a new buffer so the one being drawn is never written, this thread's context has its own GLState
+    GLuint buffer;
+    glGenBuffers(1,&buffer);
+    glBindBuffer(GL_ARRAY_BUFFER,buffer);
+    glBufferData(GL_ARRAY_BUFFER,points.size()*sizeof(float),points.data(),GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    // the render thread polls this, the flush makes sure the other context can see it
+    GLsync fence=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    glFlush();
+    double uploadMs=msSince(start);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_results.push_back({buffer,fence,request.size,request.time,generateMs,uploadMs});
+      m_working=false;
+    }
+    // a paused window wouldn't draw again until some other event, update is a slot so this is posted to the GUI thread
+    QMetaObject::invokeMethod(m_window,"update",Qt::QueuedConnection);
+  }
+  m_context->doneCurrent();
+  // the context is deleted by the dtor on the GUI thread so give it back
+  m_context->moveToThread(m_guiThread);
+}
+
+bool AsyncRegenerator::swap()
+{
+  Result result;
+  GLState *state=GLState::instance();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_results.empty())
+    {
+      return false;
+    }
+    // the results finish in order so only the newest is worth waiting for
+    GLenum status=glClientWaitSync(m_results.back().fence,0,0);
+    if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+      // keep polling the fence even if nothing else asks for frames
+      m_window->update();
+      return false;
+    }
+    for(auto &r : m_results)
+    {
+      glDeleteSync(r.fence);
+      if(&r != &m_results.back())
+      {
+        state->deleteBuffers(1,&r.buffer);
+      }
+    }
+    result=m_results.back();
+    m_results.clear();
+  }
+  // VAOs aren't shared between contexts so this one is made and re-pointed on the render thread
+  if(m_vao == 0)
+  {
+    glGenVertexArrays(1,&m_vao);
+  }
+  else
+  {
+    state->deleteBuffers(1,&m_buffer);
+  }
+  state->bindVertexArray(m_vao);
+  state->bindBuffer(GL_ARRAY_BUFFER,result.buffer);
+  glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,0,nullptr);
+  glEnableVertexAttribArray(0);
+  state->unbindVertexArray();
+  m_buffer=result.buffer;
+  m_size=result.size;
+  m_lastResult=result;
+  m_swapped=true;
+  return true;
+}
+
+bool AsyncRegenerator::presented()
+{
+  if(!m_swapped)
+  {
+    return false;
+  }
+  m_swapped=false;
+  Stats &s=m_stats;
+  s.lastLatencyMs=msSince(m_lastResult.requested);
+  s.meanLatencyMs=(s.meanLatencyMs*s.completed+s.lastLatencyMs)/(s.completed+1);
+  s.maxLatencyMs=std::max(s.maxLatencyMs,s.lastLatencyMs);
+  s.lastGenerateMs=m_lastResult.generateMs;
+  s.lastUploadMs=m_lastResult.uploadMs;
+  ++s.completed;
+  return true;
+}
+
+void AsyncRegenerator::draw() const
+{
+  if(m_vao == 0)
+  {
+    return;
+  }
+  GLState *state=GLState::instance();
+  state->bindVertexArray(m_vao);
+  state->drawArrays(GL_POINTS,0,static_cast<GLsizei>(m_size));
+  state->unbindVertexArray();
+}
+
+void AsyncRegenerator::addFrameTime(double _ms)
+{
+  (busy() || m_swapped ? m_busyFrames : m_idleFrames).add(_ms);
+}
+
+std::string AsyncRegenerator::frameLine() const
+{
+  char buffer[160];
+  std::snprintf(buffer,sizeof(buffer),"frames while making points p50 %.2f p99 %.2f ms (%zu), otherwise p50 %.2f p99 %.2f ms (%zu)",
+                m_busyFrames.percentile(50.0),m_busyFrames.percentile(99.0),m_busyFrames.size(),
+                m_idleFrames.percentile(50.0),m_idleFrames.percentile(99.0),m_idleFrames.size());
+  return buffer;
+}
+
+std::string AsyncRegenerator::hudLine() const
+{
+  char buffer[160];
+  std::snprintf(buffer,sizeof(buffer),"async %zu done%s, latency %.1f ms (mean %.1f max %.1f), generate %.1f ms upload %.1f ms",
+                m_stats.completed,busy() ? " (working)" : "",m_stats.lastLatencyMs,m_stats.meanLatencyMs,
+                m_stats.maxLatencyMs,m_stats.lastGenerateMs,m_stats.lastUploadMs);
+  return buffer;
+}
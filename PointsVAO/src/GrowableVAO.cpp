@@ -0,0 +1,60 @@
+#include "GrowableVAO.h"
+#include "GLState.h"
+#include <iostream>
+
+GrowableVAO::~GrowableVAO()
+{
+  removeVAO();
+}
+
+void GrowableVAO::draw() const
+{
+  if(m_allocated == false)
+  {
+    std::cerr<<"GrowableVAO : trying to draw an unallocated VAO\n";
+    return;
+  }
+  if(m_bound == false)
+  {
+    std::cerr<<"GrowableVAO : draw called on unbound VAO\n";
+  }
+  GLState::instance()->drawArrays(m_mode,0,static_cast<GLsizei>(m_indicesCount));
+}
+
+void GrowableVAO::setData(const VertexData &_data)
+{
+  if(m_bound == false)
+  {
+    std::cerr<<"GrowableVAO : trying to set VAO data when unbound\n";
+  }
+  resize(_data.m_size);
+  m_buffer.upload(0,_data.m_size,&_data.m_data);
+  // leave the buffer bound so setVertexAttributePointer picks it up
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_buffer.id());
+}
+
+bool GrowableVAO::resize(size_t _bytes)
+{
+  bool changed=m_buffer.resize(_bytes);
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_buffer.id());
+  m_allocated=true;
+  return changed;
+}
+
+ngl::Real * GrowableVAO::mapBuffer(unsigned int , GLenum _accessMode)
+{
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_buffer.id());
+  return static_cast<ngl::Real *>(glMapBuffer(GL_ARRAY_BUFFER,_accessMode));
+}
+
+void GrowableVAO::removeVAO()
+{
+  // deleting the VAO unbinds it, binding 0 first would only go behind the GLState cache
+  m_bound=false;
+  if( m_allocated ==true)
+  {
+    m_buffer.release();
+    GLState::instance()->deleteVertexArrays(1,&m_id);
+  }
+  m_allocated=false;
+}
@@ -1,32 +1,111 @@
 #include <QMouseEvent>
 #include <QGuiApplication>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 
 #include "NGLScene.h"
+#include "GLState.h"
+#include "GrowableVAO.h"
+#include "OctreeLOD.h"
+#include "ProgramCache.h"
+#include "RingBufferVAO.h"
+#include "ScratchPool.h"
+#include "Trace.h"
 #include <ngl/NGLInit.h>
-#include <ngl/Random.h>
-#include <ngl/ShaderLib.h>
 #include <ngl/Util.h>
 #include <ngl/VAOFactory.h>
 
-const static int s_numPoints=100000;
+/// @brief the number of points to start with, can be changed with setNumPoints
+const static unsigned int s_defaultNumPoints=100000;
+/// @brief how fast the points spin in degrees per second
+const static ngl::Real s_rotationSpeed=100.0f;
+/// @brief number of regions in the streaming ring buffer, increase if fence waits are high
+const static unsigned int s_numRegions=3;
+/// @brief the phases of paintGL timed by the FrameProfiler
+enum ProfilePhase : size_t {ClearPhase,UploadPhase,SimulatePhase,DrawPhase};
+/// @brief where the D key writes the frame time histogram
+const static char *s_histogramFile="frametimes.csv";
+/// @brief how long each frame may spend streaming a point cloud file into the buffer
+const static double s_loadBudgetMs=8.0;
+/// @brief the vertical field of view of the camera
+const static ngl::Real s_fov=45.0f;
+/// @brief the GPU cache for octree nodes holds this many frames worth of the point budget
+const static size_t s_octreeCacheFrames=3;
+/// @brief each notch of the mouse wheel scales the camera distance by this
+const static ngl::Real s_zoomStep=1.1f;
+/// @brief cells along each axis of the grid the static points are culled with
+const static unsigned int s_chunkResolution=16;
+/// @brief the longest particle step, a slow frame takes several smaller steps rather than one unstable one
+const static ngl::Real s_maxParticleStep=1.0f/60.0f;
+/// @brief the V key compares this many particles with the CPU over this many steps
+const static size_t s_validateParticles=32;
+const static unsigned int s_validateSteps=120;
+/// @brief the size of the points in pixels, for glPointSize and the compute rasteriser
+const static int s_pointSize=5;
+/// @brief a flat colour like nglColourShader but with the MVP from the FrameData block
+const static char *s_colourVertexShader=R"(#version 330 core
+layout (location=0) in vec3 inPosition;
+void main()
+{
+  gl_Position=MVP*vec4(inPosition,1.0);
+}
+)";
+const static char *s_colourFragmentShader=R"(#version 330 core
+uniform vec4 Colour;
+layout (location=0) out vec4 fragColour;
+void main()
+{
+  fragColour=Colour;
+}
+)";
 
-NGLScene::NGLScene()
+NGLScene::NGLScene() : m_scheduler(this), m_profiler({"clear","upload","simulate","draw"}), m_chunks(s_chunkResolution)
 {
   // re-size the widget to that of the parent (in this case the GLFrame passed in on construction)
   setTitle("Blank NGL");
   m_rot=0.0;
+  m_numPoints=s_defaultNumPoints;
+  // the background points are timed to the frame that shows them reaching the screen
+  connect(this,&QOpenGLWindow::frameSwapped,[this]
+  {
+    if(m_async && m_async->presented())
+    {
+      const AsyncRegenerator::Stats &stats=m_async->stats();
+      std::cout<<"new points after "<<stats.lastLatencyMs<<" ms (generate "<<stats.lastGenerateMs
+               <<" ms, upload "<<stats.lastUploadMs<<" ms)\n";
+    }
+  });
 }
 
 
 NGLScene::~NGLScene()
 {
   std::cout<<"Shutting down NGL, removing VAO's and Shaders\n";
+  if(m_streaming)
+  {
+    RingBufferVAO *ring=static_cast<RingBufferVAO *>(m_vao.get());
+    std::cout<<"Ring buffer fence waits "<<ring->fenceWaits()<<" of "<<ring->writes()<<" writes\n";
+  }
+  if(m_async)
+  {
+    // the render side buffer and VAO belong to our context
+    makeCurrent();
+    std::cout<<m_async->hudLine()<<"\n"<<m_async->frameLine()<<"\n";
+    m_async.reset();
+  }
 }
 
 void NGLScene::resizeGL(int _w, int _h)
 {
+ TRACE_SCOPE("NGLScene::resizeGL");
  m_width=_w*devicePixelRatio();
  m_height=_h*devicePixelRatio();
+ layoutViews();
+ if(m_text)
+ {
+   m_text->setScreenSize(_w,_h);
+ }
 }
 
 
@@ -36,6 +115,9 @@ void NGLScene::initializeGL()
   // be done once we have a valid GL context but before we call any GL commands. If we dont do
   // this everything will crash
   ngl::NGLInit::instance();
+  // register our streaming VAO with the factory so it can be created like the built in ones
+  ngl::VAOFactory::registerVAOCreator("ringBufferVAO",RingBufferVAO::create);
+  ngl::VAOFactory::registerVAOCreator("growableVAO",GrowableVAO::create);
   glClearColor(0.5f, 0.5f, 0.5f, 1.0f);			   // Grey Background
   // enable depth testing for drawing
   glEnable(GL_DEPTH_TEST);
@@ -43,90 +125,1137 @@ void NGLScene::initializeGL()
   glEnable(GL_MULTISAMPLE);
   // as re-size is not explicitly called we need to do this.
   glViewport(0,0,width(),height());
-  // lets create a static camera view and projection
-  ngl::Mat4 view=ngl::lookAt(ngl::Vec3(5,5,5),ngl::Vec3(0,0,0),ngl::Vec3(0,1,0));
-  ngl::Mat4 perspective=ngl::perspective(45.0f,float(width()/height()),0.1,100);
+  // lets create a camera view and projection, the mouse wheel moves the camera in and out
+  m_projection=ngl::perspective(s_fov,float(width()/height()),0.1,100);
+  updateCamera();
+  // our colour shader reads the camera from the FrameUniforms block so nothing is set by name each frame
+  // loaded as a binary when an earlier run has cached it, the ProgramCache compiles it otherwise
+  m_colourProgram=ProgramCache::instance()->build("PointsColour",
+                                                  {{ngl::ShaderType::VERTEX,FrameUniforms::withBlock(s_colourVertexShader)},
+                                                   {ngl::ShaderType::FRAGMENT,s_colourFragmentShader}});
+  FrameUniforms::attach(m_colourProgram);
+  // the ShaderLib may have made another program current behind the GLState cache
+  GLState::instance()->invalidate();
+  GLState::instance()->useProgram(m_colourProgram);
+  // set the colour to white, it never changes
+  glUniform4f(glGetUniformLocation(m_colourProgram,"Colour"),1.0f,1.0f,1.0f,1.0f);
+  // the octree draws its own nodes
+  if(!m_octree)
+  {
+    createPoints(m_numPoints);
+  }
+  glPointSize(s_pointSize);
+  // the compute rasteriser can be asked for before there is a context to check it with
+  if(m_compute && !ComputeRasteriser::isSupported())
+  {
+    std::cerr<<"The compute rasteriser needs GL 4.3 or GL_ARB_compute_shader, drawing GL_POINTS\n";
+    m_compute.reset();
+  }
+  // the worker's context shares with ours so can only be made now
+  if(m_startAsync)
+  {
+    setAsync(true);
+  }
+  // the timer queries need a context so are created here
+  m_profiler.initialize();
+  m_text.reset(new ngl::Text(QFont("Courier",12)));
+  m_text->setScreenSize(width(),height());
+  m_text->setColour(1.0f,1.0f,0.0f);
+  // ngl::Text binds its own VAO and buffers behind the GLState cache
+  GLState::instance()->invalidate();
+  // start the render loop, the next frame is requested each time one is swapped
+  m_scheduler.start();
+}
+
+bool NGLScene::loadPoints(const std::string &_fname)
+{
+  std::unique_ptr<PointCloudLoader> loader(new PointCloudLoader);
+  if(!loader->open(_fname))
+  {
+    return false;
+  }
+  m_loader=std::move(loader);
+  m_procedural.reset();
+  m_particles.reset();
+  m_startAsync=false;
+  m_numPoints=0;
+  return true;
+}
+
+bool NGLScene::loadOctree(const std::string &_fname, size_t _pointBudget)
+{
+  std::unique_ptr<OctreeLOD> octree(new OctreeLOD(_pointBudget,_pointBudget*sizeof(ngl::Vec3)*s_octreeCacheFrames));
+  if(!octree->open(_fname))
+  {
+    return false;
+  }
+  m_octree=std::move(octree);
+  m_procedural.reset();
+  m_particles.reset();
+  m_startAsync=false;
+  m_numPoints=0;
+  fitToBounds(m_octree->minBounds(),m_octree->maxBounds());
+  return true;
+}
+
+void NGLScene::updateCamera()
+{
+  ngl::Real distance=std::pow(s_zoomStep,m_zoom);
+  m_view=ngl::lookAt(ngl::Vec3(5,5,5)*distance,ngl::Vec3(0,0,0),ngl::Vec3(0,1,0));
   // store to vp for later use
-  m_vp=perspective*view;
-  // now load the default nglColour shader and set the colour for it.
-  ngl::ShaderLib *shader = ngl::ShaderLib::instance();
-  // set this as the active shader
-  shader->use("nglColourShader");
-  // set the colour to red
-  shader->setUniform("Colour",1.0f,1.0f,1.0f,1.0f);
-  createPoints(s_numPoints);
-  glPointSize(5);
-  startTimer(1);
+  m_vp=m_projection*m_view;
+  layoutViews();
 }
 
-void NGLScene::createPoints(unsigned int _size)
+void NGLScene::setNumViews(unsigned int _views)
 {
-  // we are going to create an array of random points using the
-  // random generator in ngl
-  ngl::Random *rng= ngl::Random::instance();
-  // create an array of ngl::Vec3 and re-size
-  std::vector<ngl::Vec3> points(_size);
+  _views=std::max(1u,_views);
+  if(_views > 1 && (m_octree || m_compute))
+  {
+    std::cout<<"the octree and compute rasteriser draw for one camera so can't be split into views\n";
+    return;
+  }
+  if(isValid())
+  {
+    // the views' uniform buffers are deleted with them
+    makeCurrent();
+  }
+  m_views.clear();
+  if(_views > 1)
+  {
+    for(unsigned int i=0; i<_views; ++i)
+    {
+      View view;
+      view.frame.reset(new FrameUniforms);
+      m_views.push_back(std::move(view));
+    }
+  }
+  layoutViews();
+  std::cout<<_views<<(_views > 1 ? " views" : " view")<<" of the same points\n";
+  update();
+}
 
-  // now populate the array with random points in the range -5 -> 5
-  for(unsigned int i=0; i<_size; ++i)
+void NGLScene::layoutViews()
+{
+  if(m_views.size() < 2 || m_width <= 0 || m_height <= 0)
   {
-    points[i]=rng->getRandomPoint(5.0f,5.0f,5.0f);
+    return;
   }
+  // as square a grid as will hold them, filled from the top left
+  unsigned int numViews=static_cast<unsigned int>(m_views.size());
+  unsigned int columns=static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(numViews))));
+  unsigned int rows=(numViews+columns-1)/columns;
+  int width=m_width/static_cast<int>(columns);
+  int height=m_height/static_cast<int>(rows);
+  ngl::Real distance=std::pow(s_zoomStep,m_zoom);
+  for(unsigned int i=0; i<numViews; ++i)
+  {
+    View &view=m_views[i];
+    view.x=static_cast<int>(i%columns)*width;
+    view.y=m_height-static_cast<int>(i/columns+1)*height;
+    view.width=width;
+    view.height=height;
+    // the cameras are spread evenly around the cloud at the height of the single view one
+    ngl::Real angle=ngl::radians(360.0f*i/numViews);
+    ngl::Vec3 eye(5.0f*(std::cos(angle)+std::sin(angle)),5.0f,5.0f*(std::cos(angle)-std::sin(angle)));
+    view.view=ngl::lookAt(eye*distance,ngl::Vec3(0,0,0),ngl::Vec3(0,1,0));
+    view.projection=ngl::perspective(s_fov,float(width)/float(height),0.1f,100.0f);
+    view.vp=view.projection*view.view;
+  }
+}
+
+void NGLScene::fitToBounds(const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+{
+  // scale and centre the points to fit the -5 -> 5 box the camera looks at
+  ngl::Vec3 centre=(_min+_max)*0.5f;
+  ngl::Vec3 extent=_max-_min;
+  ngl::Real size=std::max(extent.m_x,std::max(extent.m_y,extent.m_z));
+  m_fitScale= size > 0.0f ? 10.0f/size : 1.0f;
+  m_fit.setScale(m_fitScale,m_fitScale,m_fitScale);
+  m_fit.setPosition(centre*-m_fitScale);
+}
 
-  // first create the VAO
-  m_vao= ngl::VAOFactory::createVAO(ngl::simpleVAO,GL_POINTS);
+void NGLScene::createPoints(unsigned int _size)
+{
+  TRACE_SCOPE("NGLScene::createPoints");
+  if(m_loader)
+  {
+    createFilePoints();
+    return;
+  }
+  if(m_particles)
+  {
+    // the particles start from the generated points then live on the GPU
+    m_particles->init(_size,m_generator.seed());
+    m_chunks.clear();
+    m_quantised.reset();
+    m_attributes.reset();
+    m_vao= ngl::VAOFactory::createVAO("growableVAO",GL_POINTS);
+    return;
+  }
+  if(m_procedural)
+  {
+    // nothing to generate or upload, the vertex shader makes the points from gl_VertexID
+    m_procedural->setSeed(m_generator.seed());
+    m_procedural->setSize(_size);
+    m_chunks.clear();
+    m_quantised.reset();
+    m_attributes.reset();
+    m_vao= ngl::VAOFactory::createVAO("growableVAO",GL_POINTS);
+    return;
+  }
+  // first create the VAO, when streaming we use the persistently mapped ring buffer
+  if(!m_streaming)
+  {
+    // this keeps a capacity so changing the number of points doesn't always re-allocate
+    m_vao= ngl::VAOFactory::createVAO("growableVAO",GL_POINTS);
+    uploadStaticPoints(_size);
+    return;
+  }
+  m_vao= ngl::VAOFactory::createVAO("ringBufferVAO",GL_POINTS);
+  RingBufferVAO *ring=static_cast<RingBufferVAO *>(m_vao.get());
+  ring->setNumRegions(s_numRegions);
+  // the ring buffer is re-filled every frame so is always drawn whole as floats
+  m_chunks.clear();
+  m_quantised.reset();
+  m_attributes.reset();
   // to use this it must be bound
-  m_vao->bind();
-  // now copy the data
-  m_vao->setData(ngl::SimpleVAO::VertexData(points.size()*sizeof(ngl::Vec3),points[0].m_x));
+  GLState::instance()->bind(*m_vao);
+  // now make the storage and populate the first region with random points in the range -5 -> 5,
+  // this is split across all cores and gives the same points for a seed
+  ring->reserve(_size*sizeof(ngl::Vec3));
+  m_generator.generate(ring->beginWrite(),_size);
+  ring->endWrite();
   // now we need to tell OpenGL the size and layout of the data
   m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
   // now tell OpenGL how maya elements we have
-  m_vao->setNumIndices(points.size());
+  m_vao->setNumIndices(_size);
   // always best to unbind after use
-  m_vao->unbind();
+  GLState::instance()->unbindVertexArray();
 }
 
 
-void NGLScene::updatePoints(unsigned int _size)
+void NGLScene::createFilePoints()
 {
-  std::cout<<"update\n";
-  // we are going to create an array of random points using the
-  // random generator in ngl
-  ngl::Random *rng= ngl::Random::instance();
-  // create an array of ngl::Vec3 and re-size
-  std::vector<ngl::Vec3> points(_size);
+  // the file can only be sorted once it has all loaded so keep a copy as it arrives
+  m_filePoints.clear();
+  if(m_sorted)
+  {
+    m_filePoints.resize(m_loader->numPoints());
+  }
+  m_vao= ngl::VAOFactory::createVAO("growableVAO",GL_POINTS);
+  GLState::instance()->bind(*m_vao);
+  // size the buffer for the whole file once, the chunks are then written into it as they load
+  static_cast<GrowableVAO *>(m_vao.get())->resize(m_loader->numPoints()*sizeof(ngl::Vec3));
+  m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  m_vao->setNumIndices(0);
+  GLState::instance()->unbindVertexArray();
+}
 
-  // now populate the array with random points in the range -5 -> 5
-  for(unsigned int i=0; i<_size; ++i)
+void NGLScene::streamFilePoints()
+{
+  TRACE_SCOPE("NGLScene::streamFilePoints");
+  GrowableVAO *vao=static_cast<GrowableVAO *>(m_vao.get());
+  GLState::instance()->bind(*m_vao);
+  std::vector<ngl::Vec3> &copy=m_filePoints;
+  m_loader->loadChunks(s_loadBudgetMs,[vao,&copy](size_t _offset, size_t _bytes, const float *_xyz)
   {
-    points[i]=rng->getRandomPoint(5.0f,5.0f,5.0f);
+    vao->setSubData(_offset,_bytes,_xyz);
+    if(!copy.empty())
+    {
+      std::copy(_xyz,_xyz+_bytes/sizeof(float),&copy[0].m_x+_offset/sizeof(float));
+    }
+  });
+  if(!m_filePoints.empty() && m_loader->done())
+  {
+    // everything has arrived so gather it into Morton order straight into the buffer
+    m_sorter.sort(&m_filePoints[0].m_x,m_filePoints.size());
+    const MortonSort &sorter=m_sorter;
+    const std::vector<ngl::Vec3> &points=m_filePoints;
+    vao->write(0,m_filePoints.size()*sizeof(ngl::Vec3),[&sorter,&points](void *o_xyz)
+    {
+      sorter.gather(points.data(),o_xyz,sizeof(ngl::Vec3));
+    });
+    std::cout<<"Morton sorted "<<m_filePoints.size()<<" file points in "<<m_sorter.sortMs()<<" ms\n";
+    std::vector<ngl::Vec3>().swap(m_filePoints);
   }
-  // to use this it must be bound
-  m_vao->bind();
-  // now copy the data
-  glBindBuffer(GL_ARRAY_BUFFER, m_vao->getBufferID(0));
-  glBufferData(GL_ARRAY_BUFFER, points.size()*sizeof(ngl::Vec3), &points[0].m_x, GL_STATIC_DRAW);
+  // draw whatever has arrived so far
+  m_numPoints=static_cast<unsigned int>(m_loader->loadedPoints());
+  m_vao->setNumIndices(m_numPoints);
+  GLState::instance()->unbindVertexArray();
+  if(m_numPoints == 0)
+  {
+    return;
+  }
+  // fit what has loaded so far into view
+  fitToBounds(m_loader->minBounds(),m_loader->maxBounds());
+}
 
+void NGLScene::updatePoints(unsigned int _size)
+{
+  TRACE_SCOPE("NGLScene::updatePoints");
+  if(pointSource() == PointSource::File || pointSource() == PointSource::Octree)
+  {
+    std::cout<<"points are loaded from a file so can't be re-generated\n";
+    return;
+  }
+  // a new seed gives a new set of points
+  m_generator.setSeed(m_generator.seed()+1);
+  if(m_async)
+  {
+    // returns straight away, paintGL swaps the points in when they are ready
+    m_async->request(_size,m_generator.seed(),m_generator.shape());
+    return;
+  }
+  if(m_procedural)
+  {
+    // the only host work is the seed uniform set when drawing
+    m_procedural->setSeed(m_generator.seed());
+    return;
+  }
+  if(m_particles)
+  {
+    // start the simulation again from the new points
+    m_particles->init(_size,m_generator.seed());
+    return;
+  }
+  if(m_streaming)
+  {
+    RingBufferVAO *ring=static_cast<RingBufferVAO *>(m_vao.get());
+    GLState::instance()->bind(*m_vao);
+    if(ring->reserve(_size*sizeof(ngl::Vec3)))
+    {
+      // the immutable storage was too small so re-specify the layout for the new buffer
+      m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+    }
+    // write straight into the mapped region the GPU isn't using
+    m_generator.generate(ring->beginWrite(),_size);
+    ring->endWrite();
+    m_vao->setNumIndices(_size);
+    GLState::instance()->unbindVertexArray();
+    return;
+  }
+  ScratchPool::Stats before=ScratchPool::instance()->stats();
+  const PointBuffer &buffer=static_cast<GrowableVAO *>(m_vao.get())->buffer();
+  unsigned int reallocations=buffer.reallocations();
+  bool mapped=uploadStaticPoints(_size);
+  // nothing point sized should be allocated once the buffers are big enough
+  std::cout<<"update "<<(mapped ? "written in place" : "uploaded from scratch")<<", "
+           <<ScratchPool::instance()->stats().allocations-before.allocations<<" scratch allocations, "
+           <<buffer.reallocations()-reallocations<<" buffer re-allocations\n";
+}
+
+bool NGLScene::uploadStaticPoints(unsigned int _size)
+{
+  TRACE_SCOPE("NGLScene::uploadStaticPoints");
+  GrowableVAO *vao=static_cast<GrowableVAO *>(m_vao.get());
+  // to use this it must be bound
+  GLState::instance()->bind(*m_vao);
+  if(!m_sorted && !m_chunked && !m_quantised && !m_attributes)
+  {
+    // nothing needs the points on the CPU so populate the buffer with random points in the range
+    // -5 -> 5 in place, this only re-allocates if the buffer is too small
+    if(vao->resize(_size*sizeof(ngl::Vec3)))
+    {
+      m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+    }
+    m_chunks.clear();
+    Workload &generator=m_generator;
+    bool mapped=vao->write(0,_size*sizeof(ngl::Vec3),[&generator,_size](void *o_xyz)
+    {
+      generator.generate(static_cast<float *>(o_xyz),_size);
+    });
+    m_vao->setNumIndices(_size);
+    // always best to unbind after use
+    GLState::instance()->unbindVertexArray();
+    return mapped;
+  }
+  // the points are sorted, chunked or converted first so are made in a pooled block
+  ScratchPool *pool=ScratchPool::instance();
+  ScratchPool::Block points=pool->acquire(_size*sizeof(ngl::Vec3));
+  m_generator.generate(points.floats(),_size);
+  // sorting makes each chunk a contiguous range of the buffer so the visible ones can be drawn directly
+  if(m_sorted)
+  {
+    // neighbouring points are drawn together and the ranges of the sort are already chunks
+    m_sorter.sort(points.floats(),_size);
+    ScratchPool::Block sorted=pool->acquire(_size*sizeof(ngl::Vec3));
+    m_sorter.gather(points.data(),sorted.data(),sizeof(ngl::Vec3));
+    points=std::move(sorted);
+    if(m_chunked)
+    {
+      m_chunks.build(points.floats(),m_sorter);
+    }
+    else
+    {
+      m_chunks.clear();
+    }
+  }
+  else if(m_chunked)
+  {
+    m_chunks.build(points.floats(),_size);
+  }
+  else
+  {
+    m_chunks.clear();
+  }
+  if(m_quantised || m_attributes)
+  {
+    // the quantised or attribute copy is drawn instead so the float buffer is emptied
+    if(m_quantised)
+    {
+      m_quantised->quantise(points.floats(),_size);
+      m_quantised->upload();
+    }
+    else
+    {
+      m_attributes->setPoints(points.floats(),_size);
+      m_attributes->upload();
+    }
+    // their upload bound their own VAO
+    GLState::instance()->bind(*m_vao);
+    vao->resize(0);
+    if(vao->shrinkToFit())
+    {
+      m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+    }
+    m_vao->setNumIndices(0);
+    GLState::instance()->unbindVertexArray();
+    return false;
+  }
+  // now copy the data, this only re-allocates if the buffer is too small
+  if(vao->resize(_size*sizeof(ngl::Vec3)))
+  {
+    m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  }
+  vao->setSubData(0,_size*sizeof(ngl::Vec3),points.data());
+  m_vao->setNumIndices(_size);
   // always best to unbind after use
-  m_vao->unbind();
+  GLState::instance()->unbindVertexArray();
+  return false;
+}
+
+NGLScene::PointSource NGLScene::pointSource() const
+{
+  if(m_octree)
+  {
+    return PointSource::Octree;
+  }
+  if(m_loader)
+  {
+    return PointSource::File;
+  }
+  if(m_streaming)
+  {
+    return PointSource::Streaming;
+  }
+  if(m_procedural)
+  {
+    return PointSource::Procedural;
+  }
+  if(m_particles)
+  {
+    return PointSource::Particles;
+  }
+  if(m_async || m_startAsync)
+  {
+    return PointSource::Async;
+  }
+  return PointSource::Generated;
+}
+
+void NGLScene::toggleStreaming()
+{
+  PointSource source=pointSource();
+  if(source == PointSource::File || source == PointSource::Octree)
+  {
+    std::cout<<"points are loaded from a file so can't be streamed\n";
+    return;
+  }
+  if(source == PointSource::Procedural || source == PointSource::Particles)
+  {
+    std::cout<<"procedural points and particles live on the GPU so can't be streamed\n";
+    return;
+  }
+  if(source == PointSource::Async)
+  {
+    std::cout<<"the points are being made in the background so can't be streamed\n";
+    return;
+  }
+  if(m_compute)
+  {
+    std::cout<<"the compute rasteriser doesn't read the ring buffer, turn it off first\n";
+    return;
+  }
+  if(m_streaming)
+  {
+    RingBufferVAO *ring=static_cast<RingBufferVAO *>(m_vao.get());
+    std::cout<<"Ring buffer fence waits "<<ring->fenceWaits()<<" of "<<ring->writes()<<" writes\n";
+  }
+  else if(!RingBufferVAO::isSupported())
+  {
+    std::cerr<<"Streaming needs GL 4.4 or GL_ARB_buffer_storage\n";
+    return;
+  }
+  m_streaming^=true;
+  std::cout<<(m_streaming ? "Streaming points every frame\n" : "Using static points\n");
+  makeCurrent();
+  // the VAO type has changed so re-create the points
+  createPoints(m_numPoints);
+}
+
+void NGLScene::setChunked(bool _chunked)
+{
+  if(_chunked == m_chunked)
+  {
+    return;
+  }
+  if(pointSource() != PointSource::Generated)
+  {
+    std::cout<<"only the static generated points are culled in chunks\n";
+    return;
+  }
+  m_chunked=_chunked;
+  std::cout<<(m_chunked ? "Culling points in chunks\n" : "Drawing every point\n");
+  // before initializeGL createPoints will pick the mode up
+  if(!isValid())
+  {
+    return;
+  }
+  makeCurrent();
+  // re-generating the same seed puts the points back in order or sorts them into chunks
+  createPoints(m_numPoints);
+  update();
+}
+
+void NGLScene::setSorted(bool _sorted)
+{
+  if(_sorted == m_sorted)
+  {
+    return;
+  }
+  PointSource source=pointSource();
+  if(source != PointSource::Generated && source != PointSource::File)
+  {
+    std::cout<<"only static points can be sorted\n";
+    return;
+  }
+  if(source == PointSource::File && isValid())
+  {
+    std::cout<<"file points can only be sorted as they load, use --sort\n";
+    return;
+  }
+  m_sorted=_sorted;
+  // before initializeGL createPoints will pick the mode up
+  if(!isValid())
+  {
+    return;
+  }
+  makeCurrent();
+  // re-generating the same seed gives the points in generation or Morton order
+  createPoints(m_numPoints);
+  std::cout<<(m_sorted ? "Points in Morton order, sorted in "+std::to_string(m_sorter.sortMs())+" ms"
+                       : std::string("Points in generation order"))<<"\n";
+  update();
+}
+
+void NGLScene::setComputeRaster(bool _compute)
+{
+  if(_compute == static_cast<bool>(m_compute))
+  {
+    return;
+  }
+  PointSource source=pointSource();
+  if((source != PointSource::Generated && source != PointSource::File && source != PointSource::Particles) ||
+     m_quantised || m_attributes)
+  {
+    std::cout<<"the compute rasteriser only draws float points from the static buffer or the particles\n";
+    return;
+  }
+  if(_compute && m_views.size() > 1)
+  {
+    std::cout<<"the compute rasteriser draws one view, go back to a single view first\n";
+    return;
+  }
+  if(isValid())
+  {
+    makeCurrent();
+    if(_compute && !ComputeRasteriser::isSupported())
+    {
+      std::cerr<<"The compute rasteriser needs GL 4.3 or GL_ARB_compute_shader\n";
+      return;
+    }
+  }
+  // before initializeGL the support is checked there
+  m_compute.reset(_compute ? new ComputeRasteriser(s_pointSize) : nullptr);
+  std::cout<<(_compute ? "Rasterising the points in a compute shader\n" : "Drawing GL_POINTS\n");
+  update();
+}
+
+void NGLScene::cycleWorkload()
+{
+  if(pointSource() == PointSource::File || pointSource() == PointSource::Octree)
+  {
+    std::cout<<"points are loaded from a file so have no workload\n";
+    return;
+  }
+  const Workload::Shape shapes[]={Workload::Shape::Uniform,Workload::Shape::Clusters,Workload::Shape::Sphere,
+                                  Workload::Shape::Terrain,Workload::Shape::ScanLines,Workload::Shape::HeavyTail};
+  size_t next=(static_cast<size_t>(m_generator.shape())+1)%(sizeof(shapes)/sizeof(shapes[0]));
+  m_generator.setShape(shapes[next]);
+  std::cout<<"workload "<<Workload::shapeName(shapes[next])
+           <<(m_procedural || m_particles ? ", the procedural points and particles stay uniform" : "")<<"\n";
+  updatePoints(m_numPoints);
+}
+
+void NGLScene::cycleQuantisation()
+{
+  if(pointSource() != PointSource::Generated)
+  {
+    std::cout<<"only the static generated points can be quantised\n";
+    return;
+  }
+  if(m_compute)
+  {
+    std::cout<<"the compute rasteriser only draws float positions, turn it off first\n";
+    return;
+  }
+  // the old points' buffers are deleted here as well as in createPoints
+  makeCurrent();
+  m_attributes.reset();
+  if(!m_quantised)
+  {
+    m_quantised.reset(new QuantisedPoints(QuantisedPoints::Format::Short));
+  }
+  else if(m_quantised->format() == QuantisedPoints::Format::Short)
+  {
+    m_quantised.reset(new QuantisedPoints(QuantisedPoints::Format::Packed1010102));
+  }
+  else
+  {
+    m_quantised.reset();
+  }
+  createPoints(m_numPoints);
+  if(m_quantised)
+  {
+    float bound[3];
+    m_quantised->errorBound(bound);
+    std::cout<<"Positions quantised to "<<QuantisedPoints::formatName(m_quantised->format())<<", "
+             <<m_quantised->bytesPerPoint()<<" bytes a point, error at most "<<std::max(bound[0],std::max(bound[1],bound[2]))<<"\n";
+  }
+  else
+  {
+    std::cout<<"Positions are floats\n";
+  }
+  std::cout<<memoryUsage()<<"\n";
+}
+
+void NGLScene::cycleAttributeLayout()
+{
+  if(pointSource() != PointSource::Generated)
+  {
+    std::cout<<"only the static generated points can have attributes\n";
+    return;
+  }
+  if(m_compute)
+  {
+    std::cout<<"the compute rasteriser only draws float positions, turn it off first\n";
+    return;
+  }
+  makeCurrent();
+  m_quantised.reset();
+  if(!m_attributes)
+  {
+    m_attributes.reset(new AttributePoints(AttributePoints::Layout::Interleaved));
+  }
+  else if(m_attributes->layout() == AttributePoints::Layout::Interleaved)
+  {
+    m_attributes.reset(new AttributePoints(AttributePoints::Layout::Separate));
+  }
+  else if(m_attributes->layout() == AttributePoints::Layout::Separate)
+  {
+    m_attributes.reset(new AttributePoints(AttributePoints::Layout::HotCold));
+  }
+  else
+  {
+    m_attributes.reset();
+  }
+  createPoints(m_numPoints);
+  std::cout<<(m_attributes ? std::string("Point attributes in the ")+AttributePoints::layoutName(m_attributes->layout())+" layout"
+                           : std::string("Positions only"))<<"\n"<<memoryUsage()<<"\n";
+}
+
+void NGLScene::setProcedural(bool _procedural)
+{
+  if(_procedural == static_cast<bool>(m_procedural))
+  {
+    return;
+  }
+  // particles are swapped for procedural points and back
+  PointSource source=pointSource();
+  if((source != PointSource::Generated && source != PointSource::Procedural && source != PointSource::Particles) ||
+     m_compute)
+  {
+    std::cout<<"only the static generated points can be made procedurally, and not with the compute rasteriser\n";
+    return;
+  }
+  m_particles.reset();
+  m_procedural.reset(_procedural ? new ProceduralPoints(m_generator.seed()) : nullptr);
+  std::cout<<(_procedural ? "Points made in the vertex shader\n" : "Points made on the CPU\n");
+  // before initializeGL createPoints will pick the mode up
+  if(isValid())
+  {
+    makeCurrent();
+    createPoints(m_numPoints);
+    update();
+  }
+}
+
+void NGLScene::setParticles(bool _particles)
+{
+  if(_particles == static_cast<bool>(m_particles))
+  {
+    return;
+  }
+  PointSource source=pointSource();
+  if(source != PointSource::Generated && source != PointSource::Procedural && source != PointSource::Particles)
+  {
+    std::cout<<"only the generated points can be particles\n";
+    return;
+  }
+  m_procedural.reset();
+  m_particles.reset(_particles ? new ParticleSystem : nullptr);
+  std::cout<<(_particles ? "Simulating the points as particles\n" : "Static points\n");
+  // before initializeGL createPoints will pick the mode up
+  if(isValid())
+  {
+    makeCurrent();
+    createPoints(m_numPoints);
+    update();
+  }
+}
+
+void NGLScene::setAsync(bool _async)
+{
+  if(_async == (m_async || m_startAsync))
+  {
+    return;
+  }
+  PointSource source=pointSource();
+  if((source != PointSource::Generated && source != PointSource::Async) || m_compute)
+  {
+    std::cout<<"only the static generated points can be made in the background, and not with the compute rasteriser\n";
+    return;
+  }
+  if(m_sorted)
+  {
+    std::cout<<"the background points aren't sorted, turn Morton order off first\n";
+    return;
+  }
+  // before initializeGL there is no context to share with so initializeGL finishes this
+  if(!isValid())
+  {
+    m_startAsync=_async;
+    return;
+  }
+  m_startAsync=false;
+  makeCurrent();
+  if(_async)
+  {
+    // the worker uploads plain float positions
+    m_quantised.reset();
+    m_attributes.reset();
+    m_async.reset(new AsyncRegenerator(this));
+    std::cout<<"Making new points in the background\n";
+  }
+  else
+  {
+    std::cout<<m_async->hudLine()<<"\n"<<m_async->frameLine()<<"\n";
+    m_async.reset();
+    std::cout<<"Making new points on the render thread\n";
+  }
+  // the static VAO is drawn until the first background set arrives, and again once async is off
+  createPoints(m_numPoints);
+  update();
+}
 
+void NGLScene::setNumPoints(unsigned int _size)
+{
+  TRACE_SCOPE("NGLScene::setNumPoints");
+  _size=std::max(1u,_size);
+  unsigned int oldSize=m_numPoints;
+  m_numPoints=_size;
+  // before initializeGL we just store the size for createPoints, file points keep the file's size
+  if(pointSource() == PointSource::File || pointSource() == PointSource::Octree)
+  {
+    m_numPoints=oldSize;
+    return;
+  }
+  if(!isValid() || _size == oldSize)
+  {
+    return;
+  }
+  makeCurrent();
+  // the streaming VAO is re-filled every frame at the current size so only the static one needs work
+  if(m_async)
+  {
+    m_async->request(_size,m_generator.seed(),m_generator.shape());
+  }
+  else if(m_procedural)
+  {
+    m_procedural->setSize(_size);
+  }
+  else if(m_particles)
+  {
+    m_particles->init(_size,m_generator.seed());
+  }
+  else if(!m_streaming && (m_chunked || m_sorted || m_quantised || m_attributes))
+  {
+    // the points have been re-ordered or quantised in chunks, or their attributes depend on the
+    // bounds of all of them, so generate them all again
+    uploadStaticPoints(_size);
+  }
+  else if(!m_streaming)
+  {
+    GrowableVAO *vao=static_cast<GrowableVAO *>(m_vao.get());
+    GLState::instance()->bind(*m_vao);
+    if(vao->resize(_size*sizeof(ngl::Vec3)))
+    {
+      m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+    }
+    if(_size > oldSize)
+    {
+      // point i only depends on the seed and i so just generate the new ones, nothing has drawn
+      // them yet so the range is written without waiting on the GPU
+      Workload &generator=m_generator;
+      unsigned int count=_size-oldSize;
+      vao->write(oldSize*sizeof(ngl::Vec3),count*sizeof(ngl::Vec3),[&generator,oldSize,count](void *o_xyz)
+      {
+        generator.generate(static_cast<float *>(o_xyz),count,oldSize);
+      });
+    }
+    m_vao->setNumIndices(_size);
+    GLState::instance()->unbindVertexArray();
+  }
+  std::cout<<memoryUsage()<<"\n";
+  update();
+}
+
+void NGLScene::shrinkToFit()
+{
+  // the sorted, chunked and converted points are made in scratch blocks which can go whatever the mode
+  ScratchPool::instance()->trim();
+  if(!isValid() || m_streaming || m_octree || m_quantised || m_attributes || m_async)
+  {
+    std::cout<<memoryUsage()<<"\n";
+    return;
+  }
+  makeCurrent();
+  GLState::instance()->bind(*m_vao);
+  if(static_cast<GrowableVAO *>(m_vao.get())->shrinkToFit())
+  {
+    m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  }
+  GLState::instance()->unbindVertexArray();
+  std::cout<<memoryUsage()<<"\n";
+}
+
+size_t NGLScene::usedBytes() const
+{
+  if(m_procedural)
+  {
+    return 0;
+  }
+  if(m_async && m_async->ready())
+  {
+    return static_cast<size_t>(m_async->size())*sizeof(ngl::Vec3);
+  }
+  if(m_particles)
+  {
+    return m_particles->bytes();
+  }
+  if(m_quantised)
+  {
+    return m_quantised->bytes();
+  }
+  if(m_attributes)
+  {
+    return m_attributes->bytes();
+  }
+  return static_cast<size_t>(m_numPoints)*sizeof(ngl::Vec3)*(m_streaming ? s_numRegions : 1);
+}
+
+size_t NGLScene::capacityBytes() const
+{
+  if(!m_vao)
+  {
+    return 0;
+  }
+  if(m_particles)
+  {
+    return m_particles->bytes();
+  }
+  if(m_async && m_async->ready())
+  {
+    // each background set gets a buffer of exactly its size
+    return static_cast<size_t>(m_async->size())*sizeof(ngl::Vec3);
+  }
+  if(m_quantised)
+  {
+    return m_quantised->bytes();
+  }
+  if(m_attributes)
+  {
+    return m_attributes->bytes();
+  }
+  if(m_streaming)
+  {
+    return static_cast<RingBufferVAO *>(m_vao.get())->regionSize()*s_numRegions;
+  }
+  return static_cast<GrowableVAO *>(m_vao.get())->buffer().capacity();
+}
+
+std::string NGLScene::memoryUsage() const
+{
+  const double mb=1024.0*1024.0;
+  size_t used=usedBytes();
+  size_t capacity=capacityBytes();
+  char buffer[160];
+  std::snprintf(buffer,sizeof(buffer),"%u points, buffer %.2f MB used of %.2f MB (%.1f%% unused), scratch %.2f MB",
+                m_numPoints,used/mb,capacity/mb,capacity ? 100.0*(capacity-std::min(used,capacity))/capacity : 0.0,
+                ScratchPool::instance()->stats().bytesHeld/mb);
+  return buffer;
 }
 
 void NGLScene::paintGL()
 {
+  // advance the animation by the real time since the last frame
+  ngl::Real dt=m_scheduler.tick();
+  // after tick so it nests inside the scheduler's frame event
+  TRACE_SCOPE("NGLScene::paintGL");
+  m_rot+=s_rotationSpeed*dt;
+  m_time+=dt;
+  m_profiler.beginFrame();
+  GLState *state=GLState::instance();
+  state->beginFrame();
   // clear the screen and depth buffer
+  m_profiler.beginPhase(ClearPhase);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   glViewport(0,0,m_width,m_height);
-  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  ngl::Transformation transform;
-  transform.setRotation(0.0,m_rot,0.0);
-  ngl::Mat4 MVP=m_vp*transform.getMatrix();
-  shader->setUniform("MVP",MVP);
-  m_vao->bind();
-  m_vao->draw();
-  m_vao->unbind();
+  m_profiler.endPhase(ClearPhase);
+  // the HUD text uses its own shader so make sure ours is active
+  state->useProgram(m_colourProgram);
+  ngl::Mat4 rotation;
+  rotation.rotateY(m_rot);
+  ngl::Mat4 MVP=m_vp*rotation*m_fit.getMatrix();
+  // one write of the camera for every program drawn this frame
+  m_frame.update(m_view,m_projection,MVP,m_width,m_height,m_time,dt);
+  // in streaming mode the data is re-generated every frame, a file is loaded a few chunks a frame
+  if(m_streaming || (m_loader && m_loader->isOpen()))
+  {
+    m_profiler.beginPhase(UploadPhase);
+    if(m_streaming)
+    {
+      updatePoints(m_numPoints);
+    }
+    else
+    {
+      streamFilePoints();
+    }
+    m_profiler.endPhase(UploadPhase);
+  }
+  if(m_async)
+  {
+    // never waits, the last points are drawn until the worker's upload has finished
+    m_profiler.beginPhase(UploadPhase);
+    m_async->swap();
+    m_profiler.endPhase(UploadPhase);
+  }
+  if(m_particles && dt > 0.0f)
+  {
+    // the particles are moved buffer to buffer on the GPU, nothing is uploaded
+    m_profiler.beginPhase(SimulatePhase);
+    unsigned int steps=static_cast<unsigned int>(std::ceil(dt/s_maxParticleStep));
+    for(unsigned int i=0; i<steps; ++i)
+    {
+      m_particles->step(dt/steps);
+    }
+    m_profiler.endPhase(SimulatePhase);
+    // the update shader replaced ours
+    state->useProgram(m_colourProgram);
+  }
+  if(m_octree)
+  {
+    // pick the nodes for this view, the uploads of loaded nodes happen here
+    m_profiler.beginPhase(UploadPhase);
+    ngl::Real pixelScale=m_height/(2.0f*std::tan(ngl::radians(s_fov*0.5f)));
+    m_octree->update(MVP,pixelScale,m_fitScale);
+    m_profiler.endPhase(UploadPhase);
+  }
+  m_profiler.beginPhase(DrawPhase);
+  if(m_views.size() < 2)
+  {
+    drawPoints(MVP);
+  }
+  else
+  {
+    // every view draws the same buffers, only the camera block and viewport change
+    glEnable(GL_SCISSOR_TEST);
+    for(auto &view : m_views)
+    {
+      glViewport(view.x,view.y,view.width,view.height);
+      // wide points can spill out of their viewport into the next one
+      glScissor(view.x,view.y,view.width,view.height);
+      ngl::Mat4 viewMVP=view.vp*rotation*m_fit.getMatrix();
+      view.frame->update(view.view,view.projection,viewMVP,view.width,view.height,m_time,dt);
+      drawPoints(viewMVP);
+      view.frame->endFrame();
+    }
+    glDisable(GL_SCISSOR_TEST);
+    glViewport(0,0,m_width,m_height);
+  }
+  m_profiler.endPhase(DrawPhase);
+  m_frame.endFrame();
+  m_profiler.endFrame();
+  if(m_async)
+  {
+    m_async->addFrameTime(m_profiler.cpuTimes().last());
+  }
+  if(m_showHUD)
+  {
+    drawHUD();
+    // ngl::Text binds its own VAO and program behind the cache
+    state->invalidate();
+  }
+  if(m_firstFrame)
+  {
+    // drivers can finish compiling at the first draw so wait for it to be counted
+    glFinish();
+    m_firstFrame=false;
+    double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-m_startTime).count();
+    std::cout<<"first frame after "<<ms<<" ms, "<<ProgramCache::instance()->summary()<<"\n";
+  }
+}
+
+void NGLScene::drawPoints(const ngl::Mat4 &_MVP)
+{
+  TRACE_SCOPE("NGLScene::drawPoints");
+  if(m_octree)
+  {
+    m_octree->draw();
+  }
+  else if(m_procedural)
+  {
+    m_procedural->draw();
+  }
+  else if(m_particles && m_compute)
+  {
+    // each particle is a position and velocity so the stride is 6 floats
+    m_compute->begin(m_width,m_height);
+    m_compute->rasterise(m_particles->buffer(),0,m_particles->size(),6);
+    m_compute->resolve();
+  }
+  else if(m_particles)
+  {
+    m_particles->draw();
+  }
+  else if(m_async && m_async->ready())
+  {
+    m_async->draw();
+  }
+  else if(m_quantised)
+  {
+    // the quantised points use their own shader which dequantises them
+    m_quantised->bind();
+    if(!m_chunks.empty())
+    {
+      m_chunks.cull(_MVP);
+      m_chunks.draw(GL_POINTS);
+    }
+    else
+    {
+      GLState::instance()->drawArrays(GL_POINTS,0,m_numPoints);
+    }
+    m_quantised->unbind();
+  }
+  else if(m_attributes)
+  {
+    // colour, size and intensity come from the per point attributes
+    m_attributes->bind();
+    if(!m_chunks.empty())
+    {
+      m_chunks.cull(_MVP);
+      m_chunks.draw(GL_POINTS);
+    }
+    else
+    {
+      GLState::instance()->drawArrays(GL_POINTS,0,m_numPoints);
+    }
+    m_attributes->unbind();
+  }
+  else if(m_compute)
+  {
+    // the points are splatted by a compute shader then written to the framebuffer in one pass
+    m_compute->begin(m_width,m_height);
+    GLuint buffer=m_vao->getBufferID(0);
+    if(!m_chunks.empty())
+    {
+      // only the ranges of the chunks that are in view are dispatched
+      m_chunks.cull(_MVP);
+      for(size_t i=0; i<m_chunks.visibleFirsts().size(); ++i)
+      {
+        m_compute->rasterise(buffer,m_chunks.visibleFirsts()[i],m_chunks.visibleCounts()[i]);
+      }
+    }
+    else
+    {
+      m_compute->rasterise(buffer,0,m_numPoints);
+    }
+    m_compute->resolve();
+  }
+  else if(!m_chunks.empty())
+  {
+    // only submit the ranges of the chunks that are in view
+    m_chunks.cull(_MVP);
+    GLState::instance()->bind(*m_vao);
+    m_chunks.draw(GL_POINTS);
+    GLState::instance()->unbindVertexArray();
+  }
+  else
+  {
+    GLState::instance()->bind(*m_vao);
+    m_vao->draw();
+    GLState::instance()->unbindVertexArray();
+  }
+}
 
+void NGLScene::drawHUD()
+{
+  TRACE_SCOPE("NGLScene::drawHUD");
+  std::vector<std::string> lines=m_profiler.hudLines();
+  lines.push_back(m_octree ? m_octree->hudLine() : memoryUsage());
+  if(m_async)
+  {
+    lines.push_back(m_async->hudLine());
+    lines.push_back(m_async->frameLine());
+  }
+  else if(!m_octree && !m_chunks.empty())
+  {
+    lines.push_back(m_chunks.hudLine());
+  }
+  if(m_compute)
+  {
+    lines.push_back(m_compute->hudLine());
+  }
+  if(m_views.size() > 1)
+  {
+    lines.push_back(std::to_string(m_views.size())+" views drawing one set of buffers");
+  }
+  lines.push_back(GLState::instance()->hudLine());
+  for(size_t i=0; i<lines.size(); ++i)
+  {
+    m_text->renderText(10,18+i*16,QString::fromStdString(lines[i]));
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -149,30 +1278,71 @@ void NGLScene::mouseReleaseEvent ( QMouseEvent *  )
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void NGLScene::wheelEvent(QWheelEvent *)
+void NGLScene::wheelEvent(QWheelEvent *_event)
 {
-
+  TRACE_SCOPE("NGLScene::wheelEvent");
+  // each notch moves the camera in or out by s_zoomStep
+  m_zoom=std::max(-30,std::min(30,m_zoom-_event->angleDelta().y()/120));
+  updateCamera();
+  update();
 }
 //----------------------------------------------------------------------------------------------------------------------
 
 void NGLScene::keyPressEvent(QKeyEvent *_event)
 {
+  TRACE_SCOPE("NGLScene::keyPressEvent");
   // this method is called every time the main window recives a key event.
   // we then switch on the key value and set the camera in the GLWindow
   switch (_event->key())
   {
   // escape key to quite
   case Qt::Key_Escape : QGuiApplication::exit(EXIT_SUCCESS); break;
-  case Qt::Key_Space : updatePoints(s_numPoints); break;
+  case Qt::Key_Space : updatePoints(m_numPoints); break;
+  case Qt::Key_Plus :
+  case Qt::Key_Equal : setNumPoints(m_numPoints*2); break;
+  case Qt::Key_Minus : setNumPoints(m_numPoints/2); break;
+  case Qt::Key_C : shrinkToFit(); break;
+  case Qt::Key_P : m_scheduler.togglePause(); break;
+  case Qt::Key_S : toggleStreaming(); break;
+  case Qt::Key_H : m_showHUD^=true; break;
+  case Qt::Key_G : setChunked(!m_chunked); break;
+  case Qt::Key_Q : cycleQuantisation(); break;
+  case Qt::Key_W : cycleWorkload(); break;
+  case Qt::Key_L : cycleAttributeLayout(); break;
+  case Qt::Key_R : setProcedural(!m_procedural); break;
+  case Qt::Key_F : setParticles(!m_particles); break;
+  case Qt::Key_A : setAsync(!m_async); break;
+  case Qt::Key_Z : setSorted(!m_sorted); break;
+  case Qt::Key_X : setComputeRaster(!m_compute); break;
+  case Qt::Key_M : setNumViews(m_views.size() < 2 ? 2 : m_views.size() == 2 ? 4 : 1); break;
+  case Qt::Key_V :
+    if(m_particles)
+    {
+      // reads a few particles back so this stalls, it is only for checking the update shader
+      makeCurrent();
+      m_particles->validate(s_validateSteps,s_maxParticleStep,s_validateParticles,std::cout);
+    }
+  break;
+  case Qt::Key_BracketLeft :
+  case Qt::Key_BracketRight :
+    if(m_octree)
+    {
+      size_t budget=m_octree->pointBudget();
+      m_octree->setPointBudget(_event->key() == Qt::Key_BracketRight ? budget*2 : budget/2);
+      std::cout<<"octree point budget "<<m_octree->pointBudget()<<"\n";
+    }
+  break;
+  case Qt::Key_D :
+    if(m_profiler.dump(s_histogramFile))
+    {
+      std::cout<<"frame time histogram written to "<<s_histogramFile<<"\n";
+    }
+  break;
+  case Qt::Key_T : GLState::instance()->dump(std::cout); break;
+  case Qt::Key_E : Trace::instance()->toggle(std::cout); break;
   default : break;
   }
   // finally update the GLWindow and re-draw
   update();
 }
 
-
-void NGLScene::timerEvent(QTimerEvent *_event)
-{
-  m_rot+=0.1;
-  update();
-}
@@ -0,0 +1,241 @@
+#include "OctreeLOD.h"
+#include "Frustum.h"
+#include "GLState.h"
+#include "ThreadPool.h"
+#include <ngl/VAOFactory.h>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <queue>
+
+namespace
+{
+  /// @brief nodes smaller than this on screen are not drawn, nor are their children
+  constexpr ngl::Real s_minNodePixels=150.0f;
+  /// @brief the most nodes being loaded at once
+  constexpr size_t s_maxLoads=8;
+  /// @brief the most nodes uploaded in one frame so a burst of loads doesn't stall a frame
+  constexpr size_t s_maxUploads=4;
+}
+
+OctreeLOD::OctreeLOD(size_t _pointBudget, size_t _cacheBytes) :
+  m_file(new OctreeFile),
+  m_queue(new LoadQueue),
+  m_pointBudget(std::max<size_t>(_pointBudget,1)),
+  m_cacheBytes(_cacheBytes)
+{
+}
+
+OctreeLOD::~OctreeLOD()
+{
+  std::cout<<"Octree evicted "<<m_stats.evictions<<" nodes\n";
+}
+
+bool OctreeLOD::open(const std::string &_fname)
+{
+  if(!m_file->open(_fname))
+  {
+    return false;
+  }
+  m_loading.assign(m_file->nodes().size(),false);
+  return true;
+}
+
+void OctreeLOD::update(const ngl::Mat4 &_mvp, ngl::Real _pixelScale, ngl::Real _modelScale)
+{
+  ++m_frame;
+  m_stats.uploads=0;
+  select(_mvp,_pixelScale,_modelScale);
+  // mark what is needed this frame so it can't be evicted
+  for(int32_t index : m_selected)
+  {
+    auto resident=m_resident.find(index);
+    if(resident != m_resident.end())
+    {
+      resident->second.frame=m_frame;
+      m_lru.splice(m_lru.begin(),m_lru,resident->second.lru);
+    }
+  }
+  uploadLoaded();
+  requestLoads();
+  m_stats.residentNodes=m_resident.size();
+  m_stats.pendingLoads=m_inFlight;
+}
+
+void OctreeLOD::select(const ngl::Mat4 &_mvp, ngl::Real _pixelScale, ngl::Real _modelScale)
+{
+  Frustum frustum(_mvp);
+  m_selected.clear();
+  m_stats.selectedNodes=0;
+  m_stats.selectedPoints=0;
+  // projected size of a node's bounding sphere, infinite when the camera is inside it
+  auto pixels=[&](const OctreeNode &_n)
+  {
+    ngl::Real radius=_n.size*0.866f;
+    ngl::Vec3 centre(_n.min[0]+_n.size*0.5f,_n.min[1]+_n.size*0.5f,_n.min[2]+_n.size*0.5f);
+    ngl::Real depth=frustum.depth(centre);
+    if(depth <= radius*_modelScale)
+    {
+      return std::numeric_limits<ngl::Real>::max();
+    }
+    return radius*_modelScale*_pixelScale/depth;
+  };
+  std::priority_queue<std::pair<ngl::Real,int32_t>> queue;
+  queue.push({pixels(m_file->node(0)),0});
+  while(!queue.empty())
+  {
+    auto next=queue.top();
+    queue.pop();
+    const OctreeNode &n=m_file->node(static_cast<size_t>(next.second));
+    ngl::Vec3 min(n.min[0],n.min[1],n.min[2]);
+    ngl::Vec3 max(n.min[0]+n.size,n.min[1]+n.size,n.min[2]+n.size);
+    if(next.first < s_minNodePixels || !frustum.intersects(min,max))
+    {
+      continue;
+    }
+    if(m_stats.selectedPoints+n.numPoints > m_pointBudget)
+    {
+      // everything left in the queue is smaller so stop here
+      break;
+    }
+    if(n.numPoints > 0)
+    {
+      m_selected.push_back(next.second);
+      m_stats.selectedPoints+=n.numPoints;
+    }
+    for(int32_t child : n.children)
+    {
+      if(child >= 0)
+      {
+        queue.push({pixels(m_file->node(static_cast<size_t>(child))),child});
+      }
+    }
+  }
+  m_stats.selectedNodes=m_selected.size();
+}
+
+void OctreeLOD::requestLoads()
+{
+  // the selection is largest first so the most important nodes are loaded first
+  for(int32_t index : m_selected)
+  {
+    if(m_inFlight >= s_maxLoads)
+    {
+      break;
+    }
+    if(m_loading[index] || m_resident.count(index))
+    {
+      continue;
+    }
+    m_loading[index]=true;
+    ++m_inFlight;
+    std::shared_ptr<OctreeFile> file=m_file;
+    std::shared_ptr<LoadQueue> queue=m_queue;
+    ThreadPool::instance()->submit([file,queue,index]
+    {
+      // copying out of the mapping is what reads the node from disk so it happens here not in paintGL
+      const float *points=file->points(static_cast<size_t>(index));
+      LoadedNode loaded;
+      loaded.index=index;
+      loaded.points.assign(points,points+file->node(static_cast<size_t>(index)).numPoints*3);
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      queue->done.push_back(std::move(loaded));
+    });
+  }
+}
+
+void OctreeLOD::uploadLoaded()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_queue->mutex);
+    for(auto &loaded : m_queue->done)
+    {
+      m_uploads.push_back(std::move(loaded));
+    }
+    m_queue->done.clear();
+  }
+  GLState *state=GLState::instance();
+  size_t uploaded=0;
+  for(; uploaded<m_uploads.size() && uploaded<s_maxUploads; ++uploaded)
+  {
+    LoadedNode &loaded=m_uploads[uploaded];
+    m_loading[loaded.index]=false;
+    --m_inFlight;
+    size_t bytes=loaded.points.size()*sizeof(float);
+    // if the cache is full of nodes needed this frame drop it, it is requested again if still wanted
+    if(!makeRoom(bytes))
+    {
+      continue;
+    }
+    Resident resident;
+    resident.vao=ngl::VAOFactory::createVAO(ngl::simpleVAO,GL_POINTS);
+    state->bind(*resident.vao);
+    resident.vao->setData(ngl::SimpleVAO::VertexData(bytes,loaded.points[0]));
+    resident.vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+    resident.vao->setNumIndices(loaded.points.size()/3);
+    state->unbindVertexArray();
+    state->countUpload(bytes);
+    resident.bytes=bytes;
+    resident.frame=m_frame;
+    m_lru.push_front(loaded.index);
+    resident.lru=m_lru.begin();
+    m_resident[loaded.index]=std::move(resident);
+    m_stats.residentBytes+=bytes;
+    ++m_stats.uploads;
+  }
+  m_uploads.erase(m_uploads.begin(),m_uploads.begin()+static_cast<std::ptrdiff_t>(uploaded));
+  // setData binds the new buffers behind the cache
+  if(uploaded > 0)
+  {
+    state->invalidate();
+  }
+}
+
+bool OctreeLOD::makeRoom(size_t _bytes)
+{
+  while(m_stats.residentBytes+_bytes > m_cacheBytes)
+  {
+    if(m_lru.empty() || m_resident[m_lru.back()].frame == m_frame)
+    {
+      return false;
+    }
+    auto oldest=m_resident.find(m_lru.back());
+    m_stats.residentBytes-=oldest->second.bytes;
+    GLState::instance()->remove(*oldest->second.vao);
+    m_resident.erase(oldest);
+    m_lru.pop_back();
+    ++m_stats.evictions;
+  }
+  return true;
+}
+
+void OctreeLOD::draw()
+{
+  m_stats.drawnNodes=0;
+  m_stats.drawnPoints=0;
+  GLState *state=GLState::instance();
+  for(int32_t index : m_selected)
+  {
+    auto resident=m_resident.find(index);
+    if(resident == m_resident.end())
+    {
+      continue;
+    }
+    state->bind(*resident->second.vao);
+    resident->second.vao->draw();
+    state->countDraw(resident->second.vao->numIndices());
+    state->unbindVertexArray();
+    ++m_stats.drawnNodes;
+    m_stats.drawnPoints+=resident->second.vao->numIndices();
+  }
+}
+
+std::string OctreeLOD::hudLine() const
+{
+  const double mb=1024.0*1024.0;
+  char buffer[256];
+  std::snprintf(buffer,sizeof(buffer),"octree %zu/%zu nodes %.2fM/%.2fM pts, cache %zu nodes %.0f MB, loading %zu",
+                m_stats.drawnNodes,m_stats.selectedNodes,m_stats.drawnPoints/1.0e6,m_stats.selectedPoints/1.0e6,
+                m_stats.residentNodes,m_stats.residentBytes/mb,m_stats.pendingLoads);
+  return buffer;
+}
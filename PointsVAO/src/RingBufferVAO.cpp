@@ -0,0 +1,164 @@
+#include "RingBufferVAO.h"
+#include "GLState.h"
+#include <QOpenGLContext>
+#include <cstring>
+#include <iostream>
+
+RingBufferVAO::~RingBufferVAO()
+{
+  removeVAO();
+}
+
+bool RingBufferVAO::isSupported()
+{
+  QOpenGLContext *context=QOpenGLContext::currentContext();
+  if(context == nullptr)
+  {
+    return false;
+  }
+  QSurfaceFormat format=context->format();
+  return format.version() >= qMakePair(4,4) || context->hasExtension("GL_ARB_buffer_storage");
+}
+
+void RingBufferVAO::setNumRegions(unsigned int _regions)
+{
+  if(m_buffer !=0)
+  {
+    std::cerr<<"RingBufferVAO : can't change the number of regions once the buffer is allocated\n";
+    return;
+  }
+  m_numRegions= _regions < 2 ? 2 : _regions;
+}
+
+void RingBufferVAO::draw() const
+{
+  if(m_allocated == false)
+  {
+    std::cerr<<"RingBufferVAO : trying to draw an unallocated VAO\n";
+    return;
+  }
+  if(m_bound == false)
+  {
+    std::cerr<<"RingBufferVAO : draw called on unbound VAO\n";
+  }
+  // each region starts on a whole vertex so we can just offset the first vertex
+  GLint first=static_cast<GLint>((m_drawRegion*m_regionSize)/m_stride);
+  GLState::instance()->drawArrays(m_mode,first,static_cast<GLsizei>(m_indicesCount));
+  // now fence this region so the CPU knows when the GPU has finished with it
+  GLsync &fence=m_fences[m_drawRegion];
+  if(fence != nullptr)
+  {
+    glDeleteSync(fence);
+  }
+  fence=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+}
+
+void RingBufferVAO::setData(const VertexData &_data)
+{
+  reserve(_data.m_size);
+  ngl::Real *dest=beginWrite();
+  std::memcpy(dest,&_data.m_data,_data.m_size);
+  endWrite();
+  GLState::instance()->countUpload(_data.m_size);
+}
+
+bool RingBufferVAO::reserve(size_t _bytes)
+{
+  if(m_bound == false)
+  {
+    std::cerr<<"RingBufferVAO : trying to set VAO data when unbound\n";
+  }
+  // round the region up to a whole number of vertices so draw can use the first vertex
+  size_t size=((_bytes+m_stride-1)/m_stride)*m_stride;
+  // immutable storage can't be resized so only re-allocate if it is too small
+  if(m_buffer == 0 || size > m_regionSize)
+  {
+    releaseBuffer();
+    m_regionSize=size;
+    const GLbitfield flags=GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1,&m_buffer);
+    GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_buffer);
+    glBufferStorage(GL_ARRAY_BUFFER,m_regionSize*m_numRegions,nullptr,flags);
+    m_mapped=static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER,0,m_regionSize*m_numRegions,flags));
+    m_fences.assign(m_numRegions,nullptr);
+    // start at the end of the ring so the first write goes into region 0
+    m_drawRegion=m_numRegions-1;
+    m_allocated=true;
+    return true;
+  }
+  GLState::instance()->bindBuffer(GL_ARRAY_BUFFER,m_buffer);
+  return false;
+}
+
+ngl::Real * RingBufferVAO::mapBuffer(unsigned int , GLenum )
+{
+  if(m_mapped == nullptr)
+  {
+    return nullptr;
+  }
+  return reinterpret_cast<ngl::Real *>(m_mapped+m_drawRegion*m_regionSize);
+}
+
+ngl::Real *RingBufferVAO::beginWrite()
+{
+  ++m_writes;
+  m_writeRegion=(m_drawRegion+1)%m_numRegions;
+  GLsync &fence=m_fences[m_writeRegion];
+  if(fence != nullptr)
+  {
+    // poll first, only count it as a wait if the GPU hasn't finished with this region yet
+    GLenum status=glClientWaitSync(fence,0,0);
+    if(status == GL_TIMEOUT_EXPIRED)
+    {
+      ++m_fenceWaits;
+      do
+      {
+        // 1ms timeout, flush so the fence is guaranteed to be signalled eventually
+        status=glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000);
+      } while(status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence=nullptr;
+  }
+  return reinterpret_cast<ngl::Real *>(m_mapped+m_writeRegion*m_regionSize);
+}
+
+void RingBufferVAO::endWrite()
+{
+  // the mapping is coherent so there is nothing to flush, just make this the region to draw
+  m_drawRegion=m_writeRegion;
+}
+
+void RingBufferVAO::releaseBuffer()
+{
+  for(auto &fence : m_fences)
+  {
+    if(fence != nullptr)
+    {
+      glDeleteSync(fence);
+    }
+  }
+  m_fences.clear();
+  if(m_buffer !=0)
+  {
+    GLState *state=GLState::instance();
+    state->bindBuffer(GL_ARRAY_BUFFER,m_buffer);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    state->deleteBuffers(1,&m_buffer);
+  }
+  m_buffer=0;
+  m_mapped=nullptr;
+  m_regionSize=0;
+}
+
+void RingBufferVAO::removeVAO()
+{
+  // deleting the VAO unbinds it, binding 0 first would only go behind the GLState cache
+  m_bound=false;
+  if( m_allocated ==true)
+  {
+    releaseBuffer();
+    GLState::instance()->deleteVertexArrays(1,&m_id);
+  }
+  m_allocated=false;
+}
@@ -2,14 +2,84 @@
 basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwindow.html
 ****************************************************************************/
 #include <QtGui/QGuiApplication>
+#include <QCommandLineParser>
+#include <chrono>
 #include <iostream>
+#include "BatchRenderer.h"
 #include "NGLScene.h"
+#include "ProgramCache.h"
+#include "Trace.h"
 
 
 
 int main(int argc, char **argv)
 {
+  auto start=std::chrono::steady_clock::now();
   QGuiApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  QCommandLineOption frameOption("frame-mode","how frames are paced : vsync (default), unthrottled, paused or a target fps","mode","vsync");
+  parser.addOption(frameOption);
+  QCommandLineOption pointsOption("points","the number of points to draw","count","100000");
+  parser.addOption(pointsOption);
+  QCommandLineOption workloadOption("workload",QString::fromStdString("the shape of the generated points : "+Workload::shapeNames()),
+                                    "shape","uniform");
+  parser.addOption(workloadOption);
+  QCommandLineOption loadOption("load","draw the points from a raw float32 xyz or binary PLY file","file");
+  parser.addOption(loadOption);
+  QCommandLineOption octreeOption("octree","draw an out of core octree written by OctreeBuilder","file");
+  parser.addOption(octreeOption);
+  QCommandLineOption budgetOption("budget","the most octree points drawn a frame","points","5000000");
+  parser.addOption(budgetOption);
+  QCommandLineOption proceduralOption("procedural","make the random points in the vertex shader rather than uploading them");
+  parser.addOption(proceduralOption);
+  QCommandLineOption particlesOption("particles","move the points as particles on the GPU with transform feedback");
+  parser.addOption(particlesOption);
+  QCommandLineOption cullOption("cull","sort the generated points into chunks and only draw the ones in view");
+  parser.addOption(cullOption);
+  QCommandLineOption sortOption("sort","put the points in Morton order before uploading them");
+  parser.addOption(sortOption);
+  QCommandLineOption asyncOption("async","re-generate the points on a worker thread with a shared context");
+  parser.addOption(asyncOption);
+  QCommandLineOption computeOption("compute","rasterise the points in a compute shader instead of drawing GL_POINTS");
+  parser.addOption(computeOption);
+  QCommandLineOption viewsOption("views","split the window into this many views of the same points","count","1");
+  parser.addOption(viewsOption);
+  QCommandLineOption batchOption("batch","render this many frames offscreen to images and exit, no display is needed","frames");
+  parser.addOption(batchOption);
+  QCommandLineOption outputOption("output","the image of each --batch frame, %d is the frame number and the extension picks the format","pattern","frame%04d.png");
+  parser.addOption(outputOption);
+  QCommandLineOption programCacheOption("program-cache","where linked shader programs are kept between runs","dir",
+                                        QString::fromStdString(ProgramCache::defaultDirectory()));
+  parser.addOption(programCacheOption);
+  QCommandLineOption noProgramCacheOption("no-program-cache","compile every shader program, nothing is loaded or saved");
+  parser.addOption(noProgramCacheOption);
+  QCommandLineOption traceOption("trace","record a Chrome trace from the start, written to this file on exit (E starts and stops one at any time)","file");
+  parser.addOption(traceOption);
+  parser.process(app);
+  // the GUI thread does the drawing and event handling
+  Trace::setThreadName("main");
+  if(parser.isSet(traceOption))
+  {
+    Trace::instance()->setFile(parser.value(traceOption).toStdString());
+    Trace::instance()->start();
+  }
+  ProgramCache::instance()->setDirectory(parser.isSet(noProgramCacheOption) ? std::string() :
+                                         parser.value(programCacheOption).toStdString());
+  Workload::Shape workload;
+  if(!Workload::parseShape(parser.value(workloadOption).toStdString(),workload))
+  {
+    std::cerr<<"unknown workload "<<parser.value(workloadOption).toStdString()<<", use one of "<<Workload::shapeNames()<<"\n";
+    return EXIT_FAILURE;
+  }
+  double fps=60.0;
+  FrameScheduler::Mode frameMode=FrameScheduler::Mode::VSync;
+  if(!FrameScheduler::parseMode(parser.value(frameOption),frameMode,fps))
+  {
+    std::cerr<<"unknown frame mode "<<parser.value(frameOption).toStdString()
+             <<", use vsync, unthrottled, paused or a target fps above 0\n";
+    return EXIT_FAILURE;
+  }
   // create an OpenGL format specifier
   QSurfaceFormat format;
   // set the number of samples for multisampling
@@ -29,6 +99,13 @@ int main(int argc, char **argv)
   format.setProfile(QSurfaceFormat::CoreProfile);
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
+  // vsync needs a swap interval of 1, the other modes pace themselves
+  FrameScheduler::configureFormat(format,frameMode);
+  // made before the scene so the batch context outlives the scene's GL objects
+  BatchRenderer::Options batchOptions;
+  batchOptions.frames=parser.value(batchOption).toUInt();
+  batchOptions.pattern=parser.value(outputOption).toStdString();
+  BatchRenderer batch(batchOptions);
   // now we are going to create our scene window
   NGLScene window;
   // and set the OpenGL format
@@ -36,11 +113,55 @@ int main(int argc, char **argv)
   // we can now query the version to see if it worked
   std::cout<<"Profile is "<<format.majorVersion()<<" "<<format.minorVersion()<<"\n";
   // set the window size
-  window.resize(1024, 720);
+  window.resize(batchOptions.width,batchOptions.height);
+  window.setFrameMode(frameMode,fps);
+  window.setStartTime(start);
+  window.setWorkload(workload);
+  window.setNumPoints(parser.value(pointsOption).toUInt());
+  window.setProcedural(parser.isSet(proceduralOption));
+  window.setParticles(parser.isSet(particlesOption));
+  window.setAsync(parser.isSet(asyncOption));
+  window.setSorted(parser.isSet(sortOption));
+  window.setChunked(parser.isSet(cullOption));
+  if(parser.isSet(loadOption) && !window.loadPoints(parser.value(loadOption).toStdString()))
+  {
+    std::cerr<<"using random points instead\n";
+  }
+  if(parser.isSet(octreeOption) &&
+     !window.loadOctree(parser.value(octreeOption).toStdString(),parser.value(budgetOption).toULongLong()))
+  {
+    std::cerr<<"using random points instead\n";
+  }
+  // after loading as an octree can't be rasterised this way
+  window.setComputeRaster(parser.isSet(computeOption));
+  // last as the octree and compute rasteriser only have one view
+  window.setNumViews(parser.value(viewsOption).toUInt());
+  if(parser.isSet(batchOption))
+  {
+    // the frames are a fixed time apart, 1/fps with a --frame-mode rate
+    window.setFixedStep(1.0/fps);
+    bool ok=batch.run(format,[&window,&batchOptions]
+    {
+      window.initializeGL();
+      window.resizeGL(batchOptions.width,batchOptions.height);
+    },
+    [&window]{window.paintGL();},std::cout);
+    if(Trace::instance()->isRecording())
+    {
+      ok&=Trace::instance()->stop(std::cout);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
   // and finally show
   window.show();
 
-  return app.exec();
+  int result=app.exec();
+  // a capture still recording is written on exit
+  if(Trace::instance()->isRecording())
+  {
+    Trace::instance()->stop(std::cout);
+  }
+  return result;
 }
 
 
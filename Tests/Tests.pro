@@ -0,0 +1,45 @@
+# This specifies the exe name
+TARGET=Tests
+# where to put the .o files
+OBJECTS_DIR=obj
+# core Qt Libs to use add more here if needed.
+QT+=gui opengl core
+isEqual(QT_MAJOR_VERSION, 5) {
+	cache()
+	DEFINES +=QT5BUILD
+}
+# where to put moc auto generated files
+MOC_DIR=moc
+# on a mac we don't create a .app bundle file ( for ease of multiplatform use)
+CONFIG-=app_bundle
+# one file of tests for each class in Common
+SOURCES+= $$PWD/src/main.cpp \
+					$$PWD/src/PointGeneratorTest.cpp \
+					$$PWD/src/PointCloudLoaderTest.cpp \
+					$$PWD/src/QuantisedPointsTest.cpp \
+					$$PWD/src/AttributePointsTest.cpp \
+					$$PWD/src/ProceduralPointsTest.cpp \
+					$$PWD/src/MortonSortTest.cpp \
+					$$PWD/src/ProgramCacheTest.cpp \
+					$$PWD/src/WorkloadTest.cpp \
+					$$PWD/src/DirtyRangesTest.cpp \
+					$$PWD/src/TraceTest.cpp
+HEADERS+= $$PWD/include/Tests.h
+# and add the include dir into the search path for Qt and make
+INCLUDEPATH +=./include
+# the code under test
+include($$PWD/../Common/Common.pri)
+# where our exe is going to live (root of project)
+DESTDIR=./
+# this is a command line tool
+CONFIG += console
+
+NGLPATH=$$(NGLDIR)
+isEmpty(NGLPATH){ # note brace must be here
+	message("including $HOME/NGL")
+	include($(HOME)/NGL/UseNGL.pri)
+}
+else{ # note brace must be here
+	message("Using custom NGL location")
+	include($(NGLDIR)/UseNGL.pri)
+}
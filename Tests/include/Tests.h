@@ -0,0 +1,59 @@
+#ifndef TESTS_H_
+#define TESTS_H_
+#include <cstddef>
+#include <ostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Tests.h
+/// @brief the checks of the code in Common, one source file per class. Each writes a line per case to the log
+/// saying what was compared and whether it passed, and none of them need a GL context.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace tests
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of points the tests use, not a multiple of 8 so the SIMD tails and partial chunks are hit
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t s_points=1000003;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief every supported kernel, serial and threaded, is bit identical to the scalar kernel
+  //----------------------------------------------------------------------------------------------------------------------
+  bool pointGenerator(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief generated points written in each of the supported layouts load back the same
+  //----------------------------------------------------------------------------------------------------------------------
+  bool pointCloudLoader(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief every point quantised in each format is within the error bound of the float position
+  //----------------------------------------------------------------------------------------------------------------------
+  bool quantisedPoints(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief every layout filled from the same positions reads back the same points
+  //----------------------------------------------------------------------------------------------------------------------
+  bool attributePoints(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the C++ copy of the procedural shader's arithmetic gives the same points as PointGenerator
+  //----------------------------------------------------------------------------------------------------------------------
+  bool proceduralPoints(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the radix sort matches a std::stable_sort of the same codes and the ranges cover the points
+  //----------------------------------------------------------------------------------------------------------------------
+  bool mortonSort(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the hash and the cache file format
+  //----------------------------------------------------------------------------------------------------------------------
+  bool programCache(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief every shape is the same serial, threaded and as an offset range and stays in the box
+  //----------------------------------------------------------------------------------------------------------------------
+  bool workload(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief coalesce against a byte map of random marks for several gaps
+  //----------------------------------------------------------------------------------------------------------------------
+  bool dirtyRanges(std::ostream &_log);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief nested markers recorded on every pool thread all come back in the JSON
+  //----------------------------------------------------------------------------------------------------------------------
+  bool trace(std::ostream &_log);
+}
+
+#endif
@@ -0,0 +1,43 @@
+#include "Tests.h"
+#include "AttributePoints.h"
+#include "PointGenerator.h"
+#include <cstring>
+#include <vector>
+
+bool tests::attributePoints(std::ostream &_log)
+{
+  const size_t count=s_points;
+  std::vector<float> points(count*3);
+  std::vector<float> moved(count*3);
+  PointGenerator gen(0xa77);
+  gen.generate(points.data(),count);
+  gen.setSeed(0xa78);
+  gen.generate(moved.data(),count);
+  AttributePoints reference(AttributePoints::Layout::Interleaved);
+  reference.setPoints(points.data(),count);
+  bool ok=true;
+  for(auto layout : {AttributePoints::Layout::Separate,AttributePoints::Layout::HotCold,AttributePoints::Layout::Interleaved})
+  {
+    AttributePoints test(layout);
+    test.setPoints(points.data(),count);
+    bool match=true;
+    for(size_t i=0; i<count && match; ++i)
+    {
+      AttributePoints::Point a=reference.point(i);
+      AttributePoints::Point b=test.point(i);
+      match=std::memcmp(&a,&b,sizeof(AttributePoints::Point)) == 0;
+    }
+    // moving the points must keep the colours made from the old positions
+    test.setPositions(moved.data());
+    for(size_t i=0; i<count && match; ++i)
+    {
+      AttributePoints::Point a=reference.point(i);
+      AttributePoints::Point b=test.point(i);
+      std::memcpy(a.position,&moved[i*3],sizeof(a.position));
+      match=std::memcmp(&a,&b,sizeof(AttributePoints::Point)) == 0;
+    }
+    _log<<"AttributePoints "<<AttributePoints::layoutName(layout)<<(match ? " matches" : " DOES NOT match")<<" the reference\n";
+    ok&=match;
+  }
+  return ok;
+}
@@ -0,0 +1,50 @@
+#include "Tests.h"
+#include "DirtyRanges.h"
+#include "Philox.h"
+#include <algorithm>
+#include <vector>
+
+bool tests::dirtyRanges(std::ostream &_log)
+{
+  const size_t size=1<<20;
+  bool ok=true;
+  for(size_t gap : {size_t(0),size_t(12),size_t(1024)})
+  {
+    DirtyRanges dirty(gap);
+    std::vector<char> changed(size,0);
+    // scattered single points and a few runs, some overlapping, enough that the marks are compacted on the way
+    for(uint64_t i=0; i<6000; ++i)
+    {
+      philox::Block r=philox::generate(i,0,0xd1d7);
+      size_t bytes= (r.v[1]&7) == 0 ? 12*(1+r.v[2]%64) : 12;
+      size_t offset=(r.v[0]%(size/12))*12;
+      bytes=std::min(bytes,size-offset);
+      dirty.mark(offset,bytes);
+      std::fill(changed.begin()+offset,changed.begin()+offset+bytes,1);
+    }
+    const std::vector<DirtyRanges::Range> &ranges=dirty.coalesce();
+    size_t expectedChanged=std::count(changed.begin(),changed.end(),1);
+    bool match=dirty.changedBytes() == expectedChanged;
+    size_t covered=0;
+    for(size_t i=0; i<ranges.size(); ++i)
+    {
+      // in order, further apart than the gap and starting and ending on a changed byte
+      match&= i == 0 || ranges[i].offset > ranges[i-1].offset+ranges[i-1].bytes+gap;
+      match&= changed[ranges[i].offset] == 1 && changed[ranges[i].offset+ranges[i].bytes-1] == 1;
+      covered+=static_cast<size_t>(std::count(changed.begin()+ranges[i].offset,
+                                              changed.begin()+ranges[i].offset+ranges[i].bytes,1));
+    }
+    // every changed byte is in exactly one range
+    match&= covered == expectedChanged;
+    // a second coalesce with nothing new gives the same ranges
+    size_t count=ranges.size();
+    size_t bytes=dirty.rangeBytes();
+    match&= dirty.coalesce().size() == count && dirty.rangeBytes() == bytes && dirty.changedBytes() == expectedChanged;
+    dirty.flushed();
+    match&= dirty.empty() && dirty.stats().flushes == 1 && dirty.stats().uploadedBytes == bytes;
+    _log<<"DirtyRanges gap "<<gap<<" : "<<count<<" ranges, "<<bytes<<" bytes for "<<expectedChanged<<" changed "
+        <<(match ? "match" : "DO NOT match")<<" the byte map\n";
+    ok&=match;
+  }
+  return ok;
+}
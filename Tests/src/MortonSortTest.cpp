@@ -0,0 +1,63 @@
+#include "Tests.h"
+#include "MortonSort.h"
+#include "PointGenerator.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+bool tests::mortonSort(std::ostream &_log)
+{
+  const size_t count=s_points;
+  std::vector<float> points(count*3);
+  PointGenerator gen(0x2c0de);
+  gen.generate(points.data(),count);
+  // a run of repeated points checks the sort is stable
+  for(size_t i=count/2; i<std::min(count,count/2+1000); ++i)
+  {
+    std::copy(&points[0],&points[3],&points[i*3]);
+  }
+  bool ok=true;
+  for(auto precision : {MortonSort::Precision::Bits30,MortonSort::Precision::Bits63})
+  {
+    MortonSort sorter(precision);
+    sorter.sort(points.data(),count);
+    // the same codes sorted the slow way, the second element of the pair keeps the original order
+    std::vector<std::pair<uint64_t,uint32_t>> reference(count);
+    for(size_t i=0; i<count; ++i)
+    {
+      reference[sorter.order()[i]]={sorter.codes()[i],static_cast<uint32_t>(sorter.order()[i])};
+    }
+    std::stable_sort(reference.begin(),reference.end(),[](const std::pair<uint64_t,uint32_t> &_a, const std::pair<uint64_t,uint32_t> &_b)
+    {
+      return _a.first < _b.first;
+    });
+    size_t mismatched=0;
+    for(size_t i=0; i<count; ++i)
+    {
+      mismatched+= reference[i].first != sorter.codes()[i] || reference[i].second != sorter.order()[i];
+    }
+    // the gathered positions must be the originals in the sorted order
+    std::vector<float> sorted(count*3);
+    sorter.gather(points.data(),sorted.data(),3*sizeof(float));
+    for(size_t i=0; i<count; ++i)
+    {
+      mismatched+= std::memcmp(&sorted[i*3],&points[sorter.order()[i]*3],3*sizeof(float)) != 0;
+    }
+    // ranges at a 16^3 grid must tile the points in increasing prefix order
+    std::vector<MortonSort::Range> chunks=sorter.ranges(12);
+    size_t next=0;
+    bool tiled=true;
+    for(size_t c=0; c<chunks.size(); ++c)
+    {
+      tiled&= chunks[c].first == next && chunks[c].count > 0 && (c == 0 || chunks[c].prefix > chunks[c-1].prefix);
+      next+=chunks[c].count;
+    }
+    tiled&= next == count;
+    bool passed= mismatched == 0 && tiled;
+    _log<<"MortonSort "<<sorter.codeBits()<<" bit codes, "<<count<<" points in "<<sorter.passes()<<" passes "
+        <<sorter.sortMs()<<" ms, "<<chunks.size()<<" ranges : "<<(passed ? "match" : "FAILED")<<"\n";
+    ok&=passed;
+  }
+  return ok;
+}
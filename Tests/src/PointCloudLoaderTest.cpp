@@ -0,0 +1,52 @@
+#include "Tests.h"
+#include "PointCloudLoader.h"
+#include "PointGenerator.h"
+#include <QDir>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+bool tests::pointCloudLoader(std::ostream &_log)
+{
+  const size_t count=s_points;
+  PointGenerator gen(0x10ad);
+  std::vector<float> reference(count*3);
+  gen.generate(reference.data(),count);
+  std::string dir=QDir::tempPath().toStdString();
+  struct Test
+  {
+    const char *name;
+    std::string fname;
+    bool (*write)(const std::string &, const float *, size_t);
+  };
+  Test tests[]=
+  {
+    {"raw xyz",dir+"/test_points.xyz",PointCloudLoader::writeRaw},
+    {"packed PLY",dir+"/test_points.ply",[](const std::string &_f, const float *_p, size_t _n){return PointCloudLoader::writePLY(_f,_p,_n,false);}},
+    {"PLY with colour",dir+"/test_colour.ply",[](const std::string &_f, const float *_p, size_t _n){return PointCloudLoader::writePLY(_f,_p,_n,true);}}
+  };
+  bool ok=true;
+  std::vector<float> loaded(count*3);
+  for(auto &t : tests)
+  {
+    std::fill(loaded.begin(),loaded.end(),0.0f);
+    // an odd chunk size so the last chunk is a partial one
+    PointCloudLoader loader(count/7+1);
+    bool match=t.write(t.fname,reference.data(),count) && loader.open(t.fname) && loader.numPoints() == count;
+    if(match)
+    {
+      loader.loadChunks(0.0,[&loaded](size_t _offset, size_t _bytes, const float *_xyz)
+      {
+        std::memcpy(reinterpret_cast<char *>(loaded.data())+_offset,_xyz,_bytes);
+      });
+      match=loader.loadedPoints() == count &&
+            std::memcmp(reference.data(),loaded.data(),loaded.size()*sizeof(float)) == 0;
+    }
+    _log<<"PointCloudLoader "<<t.name<<(match ? " matches" : " DOES NOT match")<<" the points written\n";
+    ok&=match;
+    QFile::remove(QString::fromStdString(t.fname));
+  }
+  return ok;
+}
@@ -0,0 +1,46 @@
+#include "Tests.h"
+#include "PointGenerator.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+bool tests::pointGenerator(std::ostream &_log)
+{
+  const size_t count=s_points;
+  PointGenerator gen(0x5eed);
+  std::vector<float> reference(count*3);
+  std::vector<float> test(count*3);
+  gen.generateSerial(reference.data(),count,0,PointGenerator::Kernel::Scalar);
+  bool ok=true;
+  for(auto k : {PointGenerator::Kernel::Scalar,PointGenerator::Kernel::SSE41,PointGenerator::Kernel::AVX2})
+  {
+    if(!PointGenerator::isSupported(k))
+    {
+      _log<<"PointGenerator "<<PointGenerator::kernelName(k)<<" not supported on this CPU, skipped\n";
+      continue;
+    }
+    for(bool threaded : {false,true})
+    {
+      std::fill(test.begin(),test.end(),0.0f);
+      if(threaded)
+      {
+        gen.generate(test.data(),count,0,k);
+      }
+      else
+      {
+        gen.generateSerial(test.data(),count,0,k);
+      }
+      bool match=std::memcmp(reference.data(),test.data(),test.size()*sizeof(float)) == 0;
+      _log<<"PointGenerator "<<PointGenerator::kernelName(k)<<(threaded ? " threaded " : " serial ")
+          <<(match ? "matches" : "DOES NOT match")<<" scalar reference\n";
+      ok&=match;
+    }
+    // a range starting part way through must match the same slice of the full sequence
+    size_t offset=count/3+1;
+    gen.generateSerial(test.data(),count-offset,offset,k);
+    bool match=std::memcmp(reference.data()+offset*3,test.data(),(count-offset)*3*sizeof(float)) == 0;
+    _log<<"PointGenerator "<<PointGenerator::kernelName(k)<<" offset range "<<(match ? "matches" : "DOES NOT match")<<'\n';
+    ok&=match;
+  }
+  return ok;
+}
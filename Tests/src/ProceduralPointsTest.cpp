@@ -0,0 +1,28 @@
+#include "Tests.h"
+#include "PointGenerator.h"
+#include "ProceduralPoints.h"
+#include <vector>
+
+bool tests::proceduralPoints(std::ostream &_log)
+{
+  const size_t count=s_points;
+  bool ok=true;
+  for(uint64_t seed : {uint64_t(0x5eed),uint64_t(0x123456789abcdef0)})
+  {
+    PointGenerator gen(seed);
+    ProceduralPoints procedural(seed);
+    std::vector<float> reference(count*3);
+    gen.generate(reference.data(),count);
+    bool match=true;
+    for(size_t i=0; i<count && match; ++i)
+    {
+      float p[3];
+      procedural.point(static_cast<uint32_t>(i),p);
+      match=p[0] == reference[i*3] && p[1] == reference[i*3+1] && p[2] == reference[i*3+2];
+    }
+    _log<<"ProceduralPoints shader arithmetic with seed "<<std::hex<<seed<<std::dec
+        <<(match ? " matches" : " DOES NOT match")<<" PointGenerator\n";
+    ok&=match;
+  }
+  return ok;
+}
@@ -0,0 +1,42 @@
+#include "Tests.h"
+#include "ProgramCache.h"
+#include <QDir>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+bool tests::programCache(std::ostream &_log)
+{
+  bool ok=true;
+  // the published FNV-1a 64 value of "a" before our separator
+  uint64_t a=(0xcbf29ce484222325ull^'a')*0x100000001b3ull;
+  ok&= a == 0xaf63dc4c8601ec8cull;
+  ok&= ProgramCache::hash({"ab","c"}) != ProgramCache::hash({"a","bc"}) &&
+       ProgramCache::hash({"x"}) == ProgramCache::hash({"x"}) && ProgramCache::hash({"x"}) != ProgramCache::hash({"y"});
+  std::string file=QDir::tempPath().toStdString()+"/test_program.bin";
+  std::vector<char> binary(1000);
+  for(size_t i=0; i<binary.size(); ++i)
+  {
+    binary[i]=static_cast<char>(i*7);
+  }
+  GLenum format=0;
+  std::vector<char> back;
+  bool written=ProgramCache::writeFile(file,42,0x8e8e,binary);
+  ok&= written && ProgramCache::readFile(file,42,format,back) && format == 0x8e8e && back == binary;
+  // another key, which would be another source or driver, must miss
+  ok&= !ProgramCache::readFile(file,43,format,back);
+  // so must a file cut short, the good file with the end of the binary missing
+  {
+    std::ifstream in(file,std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream cut(file,std::ios::binary);
+    cut.write(bytes.data(),static_cast<std::streamsize>(bytes.size()-binary.size()+10));
+  }
+  ok&= !ProgramCache::readFile(file,42,format,back);
+  std::remove(file.c_str());
+  _log<<"ProgramCache hash and cache files : "<<(ok ? "match" : "FAILED")<<"\n";
+  return ok;
+}
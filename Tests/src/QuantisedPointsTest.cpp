@@ -0,0 +1,51 @@
+#include "Tests.h"
+#include "PointGenerator.h"
+#include "QuantisedPoints.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+bool tests::quantisedPoints(std::ostream &_log)
+{
+  const size_t count=s_points;
+  std::vector<float> points(count*3);
+  PointGenerator gen(0x9a17);
+  gen.generate(points.data(),count);
+  // a flat last chunk checks a zero extent doesn't divide by zero
+  const unsigned int chunkShift=12;
+  for(size_t i=(count>>chunkShift)<<chunkShift; i<count; ++i)
+  {
+    points[i*3+1]=2.5f;
+  }
+  bool ok=true;
+  for(auto format : {QuantisedPoints::Format::Short,QuantisedPoints::Format::Packed1010102})
+  {
+    QuantisedPoints quantised(format,chunkShift);
+    quantised.quantise(points.data(),count);
+    float bound[3];
+    quantised.errorBound(bound);
+    // the largest quantised value, the bound is half a step of it over the chunk's extent
+    const float maxQ= format == QuantisedPoints::Format::Short ? 65535.0f : 1023.0f;
+    float worst[3]={0.0f,0.0f,0.0f};
+    bool within=true;
+    for(size_t i=0; i<count; ++i)
+    {
+      float p[3];
+      quantised.dequantise(i,p);
+      for(int axis=0; axis<3; ++axis)
+      {
+        float error=std::abs(p[axis]-points[i*3+axis]);
+        worst[axis]=std::max(worst[axis],error);
+        // allow for the float rounding in the dequantise sum
+        float slack=4.0f*FLT_EPSILON*(std::abs(points[i*3+axis])+bound[axis]*maxQ*2.0f);
+        within&= error <= bound[axis]+slack;
+      }
+    }
+    _log<<"QuantisedPoints "<<QuantisedPoints::formatName(format)<<" max error "<<worst[0]<<' '<<worst[1]<<' '<<worst[2]
+        <<(within ? " is within" : " is NOT within")<<" the bound "<<bound[0]<<' '<<bound[1]<<' '<<bound[2]
+        <<", "<<quantised.bytesPerPoint()<<" bytes a point\n";
+    ok&=within;
+  }
+  return ok;
+}
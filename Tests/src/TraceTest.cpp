@@ -0,0 +1,79 @@
+#include "Tests.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <QDir>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+
+bool tests::trace(std::ostream &_log)
+{
+  Trace *trace=Trace::instance();
+  ThreadPool *pool=ThreadPool::instance();
+  std::string oldFile=trace->file();
+  trace->setFile(QDir::tempPath().toStdString()+"/test_trace.json");
+  // the cost of a marker with recording off then on, well inside a thread's buffer so nothing is dropped
+  const size_t markers=200000;
+  auto begin=std::chrono::steady_clock::now();
+  for(size_t i=0; i<markers; ++i)
+  {
+    Trace::Scope scope("test timing");
+  }
+  double offNs=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-begin).count()/markers;
+  trace->start();
+  begin=std::chrono::steady_clock::now();
+  for(size_t i=0; i<markers; ++i)
+  {
+    Trace::Scope scope("test timing");
+  }
+  double onNs=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-begin).count()/markers;
+  _log<<"Trace marker "<<onNs<<" ns recording, "<<offNs<<" ns off\n";
+
+  // a new capture drops the timing markers, small grains so every thread gets some of the work
+  const size_t tasks=pool->numThreads()*64;
+  trace->start();
+  pool->parallelFor(0,tasks,[](size_t _begin, size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      Trace::Scope outer("test outer");
+      Trace::Scope inner("test inner");
+    }
+  },1);
+  std::ostringstream stopLog;
+  bool written=trace->stop(stopLog);
+  std::ifstream in(trace->file());
+  std::string text((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+  in.close();
+  std::remove(trace->file().c_str());
+  trace->setFile(oldFile);
+  size_t outer=0;
+  size_t inner=0;
+  for(size_t at=text.find("\"test "); at != std::string::npos; at=text.find("\"test ",at+1))
+  {
+    if(text.compare(at,12,"\"test outer\"") == 0)
+    {
+      ++outer;
+    }
+    else if(text.compare(at,12,"\"test inner\"") == 0)
+    {
+      ++inner;
+    }
+  }
+  // the threads the markers were recorded on
+  const std::string outerEvent="\"test outer\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+  std::set<std::string> threads;
+  for(size_t at=text.find(outerEvent); at != std::string::npos; at=text.find(outerEvent,at+1))
+  {
+    size_t tid=at+outerEvent.size();
+    threads.insert(text.substr(tid,text.find(',',tid)-tid));
+  }
+  bool ok=written && outer == tasks && inner == tasks && trace->dropped() == 0;
+  _log<<"Trace "<<outer<<" + "<<inner<<" of "<<tasks<<" nested markers on "<<threads.size()<<" threads "
+      <<(ok ? "match" : "DO NOT match")<<"\n";
+  return ok;
+}
@@ -0,0 +1,53 @@
+#include "Tests.h"
+#include "PointGenerator.h"
+#include "Workload.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+bool tests::workload(std::ostream &_log)
+{
+  const size_t count=s_points;
+  const uint64_t seed=0x3a7;
+  std::vector<float> reference(count*3);
+  std::vector<float> test(count*3);
+  bool ok=true;
+  for(auto s : {Workload::Shape::Uniform,Workload::Shape::Clusters,Workload::Shape::Sphere,Workload::Shape::Terrain,
+                Workload::Shape::ScanLines,Workload::Shape::HeavyTail})
+  {
+    Workload workload(s,seed);
+    workload.generateSerial(reference.data(),count);
+    workload.generate(test.data(),count);
+    bool match=std::memcmp(reference.data(),test.data(),test.size()*sizeof(float)) == 0;
+    // a range starting part way through must match the same slice of the full sequence
+    size_t offset=count/3+1;
+    workload.generate(test.data(),count-offset,offset);
+    match&=std::memcmp(reference.data()+offset*3,test.data(),(count-offset)*3*sizeof(float)) == 0;
+    if(s == Workload::Shape::Uniform)
+    {
+      // uniform must stay the points the demos have always drawn
+      PointGenerator(seed).generate(test.data(),count);
+      match&=std::memcmp(reference.data(),test.data(),test.size()*sizeof(float)) == 0;
+    }
+    bool inside=std::all_of(reference.begin(),reference.end(),[](float _v){return _v >= -5.0f && _v <= 5.0f;});
+    // how much of a 32^3 grid over the box the points reach and how crowded the fullest cell is
+    std::unordered_map<uint32_t,size_t> cells;
+    size_t fullest=0;
+    for(size_t i=0; i<count; ++i)
+    {
+      uint32_t key=0;
+      for(int c=0; c<3; ++c)
+      {
+        int cell=std::min(31,std::max(0,static_cast<int>((reference[i*3+c]+5.0f)*3.2f)));
+        key=key*32+static_cast<uint32_t>(cell);
+      }
+      fullest=std::max(fullest,++cells[key]);
+    }
+    _log<<"Workload "<<Workload::shapeName(s)<<(match ? " serial, threaded and offset ranges match" : " DOES NOT match")
+        <<(inside ? ", in the box" : ", OUT of the box")<<", fills "<<100.0*cells.size()/32768.0
+        <<"% of a 32^3 grid, the fullest cell has "<<100.0*fullest/count<<"% of the points\n";
+    ok&=match && inside;
+  }
+  return ok;
+}
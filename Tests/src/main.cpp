@@ -0,0 +1,73 @@
+/****************************************************************************
+runs the checks of the code in Common, with no arguments every test is run
+otherwise only the ones named, e.g. Tests MortonSort Trace
+****************************************************************************/
+#include <QCoreApplication>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "Tests.h"
+
+int main(int argc, char **argv)
+{
+  // the loaders and caches use Qt for their files but nothing needs a display
+  QCoreApplication app(argc, argv);
+  struct Test
+  {
+    const char *name;
+    bool (*run)(std::ostream &);
+  };
+  const Test tests[]=
+  {
+    {"PointGenerator",tests::pointGenerator},
+    {"PointCloudLoader",tests::pointCloudLoader},
+    {"QuantisedPoints",tests::quantisedPoints},
+    {"AttributePoints",tests::attributePoints},
+    {"ProceduralPoints",tests::proceduralPoints},
+    {"MortonSort",tests::mortonSort},
+    {"ProgramCache",tests::programCache},
+    {"Workload",tests::workload},
+    {"DirtyRanges",tests::dirtyRanges},
+    {"Trace",tests::trace}
+  };
+  for(int a=1; a<argc; ++a)
+  {
+    bool known=false;
+    for(const auto &t : tests)
+    {
+      known|= std::strcmp(argv[a],t.name) == 0;
+    }
+    if(!known)
+    {
+      std::cerr<<"unknown test "<<argv[a]<<", the tests are";
+      for(const auto &t : tests)
+      {
+        std::cerr<<' '<<t.name;
+      }
+      std::cerr<<'\n';
+      return EXIT_FAILURE;
+    }
+  }
+  size_t run=0;
+  size_t failed=0;
+  for(const auto &t : tests)
+  {
+    bool selected= argc == 1;
+    for(int a=1; a<argc; ++a)
+    {
+      selected|= std::strcmp(argv[a],t.name) == 0;
+    }
+    if(!selected)
+    {
+      continue;
+    }
+    ++run;
+    if(!t.run(std::cout))
+    {
+      std::cout<<t.name<<" FAILED\n";
+      ++failed;
+    }
+  }
+  std::cout<<run-failed<<" of "<<run<<" tests passed\n";
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}